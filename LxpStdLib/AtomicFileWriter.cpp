@@ -0,0 +1,238 @@
+#include "pch.h"
+#include "AtomicFileWriter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace LxpStd
+{
+	namespace
+	{
+		atomic<unsigned int> nextTempNumber(0);		// of the temporary files of the process
+	}
+
+#ifdef _WIN32
+	namespace
+	{
+		// file names need to be wide for the Windows calls
+		wstring WideFileName(const string& fileName)
+		{
+			int wideLength = MultiByteToWideChar(CP_UTF8, 0, fileName.c_str(), -1, NULL, 0);
+			wstring wideFileName(wideLength, L'\0');
+			MultiByteToWideChar(CP_UTF8, 0, fileName.c_str(), -1, &wideFileName[0], wideLength);
+			return wideFileName;
+		}
+	}
+#endif
+
+	const char* const AtomicFileWriter::TEMP_SUFFIX = ".tmp";
+
+	// CONSTRUCTOR
+	AtomicFileWriter::AtomicFileWriter()
+	{
+		this->length = 0;
+#ifdef _WIN32
+		this->fileHandle = INVALID_HANDLE_VALUE;
+#else
+		this->fileDescriptor = -1;
+#endif
+	}
+
+	// DESTRUCTOR
+	AtomicFileWriter::~AtomicFileWriter()
+	{
+		Close();
+	}
+
+	// CLOSE
+	void AtomicFileWriter::Close()
+	{
+		if (!IsOpen())
+			return;
+
+#ifdef _WIN32
+		CloseHandle(this->fileHandle);
+		this->fileHandle = INVALID_HANDLE_VALUE;
+		DeleteFileW(WideFileName(this->tempFileName).c_str());
+#else
+		close(this->fileDescriptor);
+		this->fileDescriptor = -1;
+		unlink(this->tempFileName.c_str());
+#endif
+		this->length = 0;
+	}
+
+	// COMMIT
+	// The data must be on the disk before the rename, or a crash could leave the new name
+	// on an empty file. The directory is flushed after it so the rename is kept too.
+	void AtomicFileWriter::Commit()
+	{
+		if (!IsOpen())
+			throw(std::runtime_error("File is not open!"));
+
+#ifdef _WIN32
+		if (!FlushFileBuffers(this->fileHandle))
+		{
+			Close();
+			throw(std::runtime_error("Unable to flush file to disk!"));
+		}
+
+		CloseHandle(this->fileHandle);
+		this->fileHandle = INVALID_HANDLE_VALUE;
+		if (!MoveFileExW(WideFileName(this->tempFileName).c_str(), WideFileName(this->fileName).c_str(),
+						 MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+		{
+			DeleteFileW(WideFileName(this->tempFileName).c_str());
+			throw(std::runtime_error("Unable to rename file!"));
+		}
+#else
+		if (fsync(this->fileDescriptor) != 0)
+		{
+			Close();
+			throw(std::runtime_error("Unable to flush file to disk!"));
+		}
+
+		int result = close(this->fileDescriptor);
+		this->fileDescriptor = -1;
+		if (result != 0 || rename(this->tempFileName.c_str(), this->fileName.c_str()) != 0)
+		{
+			unlink(this->tempFileName.c_str());
+			throw(std::runtime_error("Unable to rename file!"));
+		}
+
+		// (not all file systems can flush a directory, the file is saved anyway)
+		size_t slashPos = this->fileName.find_last_of('/');
+		string directoryName = slashPos == string::npos ? string(".") : this->fileName.substr(0, max(slashPos, (size_t)1));
+		int directoryDescriptor = open(directoryName.c_str(), O_RDONLY);
+		if (directoryDescriptor != -1)
+		{
+			fsync(directoryDescriptor);
+			close(directoryDescriptor);
+		}
+#endif
+		this->length = 0;
+	}
+
+	// IS OPEN
+	bool AtomicFileWriter::IsOpen() const
+	{
+#ifdef _WIN32
+		return this->fileHandle != INVALID_HANDLE_VALUE;
+#else
+		return this->fileDescriptor != -1;
+#endif
+	}
+
+	// LENGTH
+	unsigned long long AtomicFileWriter::Length() const
+	{
+		return this->length;
+	}
+
+	// OPEN
+	void AtomicFileWriter::Open(const string& fileName)
+	{
+		// clean up first
+		Close();
+
+		this->fileName = fileName;
+
+		// The temporary file is created new, with a name of its own (see TempFileName), so that
+		// writers of the same file don't write over each other's (or over a file that is there
+		// already). A name that is taken (e.g. left by a crash) is skipped.
+		for (unsigned int attempt = 1; ; attempt++)
+		{
+			this->tempFileName = TempFileName(fileName, nextTempNumber++);
+#ifdef _WIN32
+			this->fileHandle = CreateFile2(WideFileName(this->tempFileName).c_str(), GENERIC_WRITE, 0, CREATE_NEW, NULL);
+			if (this->fileHandle != INVALID_HANDLE_VALUE)
+				return;
+			if (GetLastError() != ERROR_FILE_EXISTS || attempt == AtomicFileWriter::MAX_OPEN_ATTEMPTS)
+				throw(std::runtime_error("Unable to create file!"));
+#else
+			this->fileDescriptor = open(this->tempFileName.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0666);
+			if (this->fileDescriptor != -1)
+				return;
+			if (errno != EEXIST || attempt == AtomicFileWriter::MAX_OPEN_ATTEMPTS)
+				throw(std::runtime_error("Unable to create file!"));
+#endif
+		}
+	}
+
+	// NEXT TEMP NUMBER
+	unsigned int AtomicFileWriter::NextTempNumber()
+	{
+		return nextTempNumber;
+	}
+
+	// TEMP FILE NAME
+	// the file name, the process id, the number and TEMP_SUFFIX
+	string AtomicFileWriter::TempFileName(const string& fileName, unsigned int tempNumber)
+	{
+#ifdef _WIN32
+		string processId = to_string(GetCurrentProcessId());
+#else
+		string processId = to_string(getpid());
+#endif
+		return fileName + "." + processId + "." + to_string(tempNumber) + AtomicFileWriter::TEMP_SUFFIX;
+	}
+
+	// WRITE
+	void AtomicFileWriter::Write(const void* pData, size_t length)
+	{
+		WriteData(this->length, pData, length);
+		this->length += length;
+	}
+
+	// WRITE AT
+	void AtomicFileWriter::WriteAt(unsigned long long offset, const void* pData, size_t length)
+	{
+		if (offset + length > this->length)
+			throw(std::runtime_error("Unable to write past the end of the file!"));
+
+		WriteData(offset, pData, length);
+	}
+
+	// WRITE DATA
+	// (at an offset, so that writing over the start doesn't move the end)
+	void AtomicFileWriter::WriteData(unsigned long long offset, const void* pData, size_t length)
+	{
+		if (!IsOpen())
+			throw(std::runtime_error("File is not open!"));
+
+		const char* pBytes = (const char*)pData;
+		while (length > 0)
+		{
+#ifdef _WIN32
+			OVERLAPPED overlapped = {};
+			overlapped.Offset = (DWORD)offset;
+			overlapped.OffsetHigh = (DWORD)(offset >> 32);
+			DWORD numBytesToWrite = (DWORD)min(length, (size_t)(1 << 30));
+			DWORD numBytesWritten = 0;
+			if (!WriteFile(this->fileHandle, pBytes, numBytesToWrite, &numBytesWritten, &overlapped) || numBytesWritten == 0)
+				throw(std::runtime_error("Unable to write file!"));
+#else
+			ssize_t numBytesWritten = pwrite(this->fileDescriptor, pBytes, length, (off_t)offset);
+			if (numBytesWritten == -1 && errno == EINTR)
+				continue;
+			if (numBytesWritten <= 0)
+				throw(std::runtime_error("Unable to write file!"));
+#endif
+			pBytes += numBytesWritten;
+			offset += numBytesWritten;
+			length -= numBytesWritten;
+		}
+	}
+}
@@ -0,0 +1,67 @@
+// AtomicFileWriter.h
+
+#ifndef ATOMIC_FILE_WRITER_H
+#define ATOMIC_FILE_WRITER_H
+
+#include <cstddef>
+#include <string>
+
+namespace LxpStd
+{
+	// This class writes a file so that readers never see a part of it. The data goes to a
+	// temporary file next to it (see TempFileName, with a number unique to the writer),
+	// which Commit flushes to the disk and renames over the file: readers find the old file or
+	// the whole new one. Writers of the same file each have their own temporary file, the
+	// last to commit wins.
+	// Every write is checked (throws std::runtime_error). If the writer is closed or
+	// destroyed before Commit (e.g. after an error), the temporary file is removed.
+
+	class AtomicFileWriter
+	{
+	public:
+		// constants
+		static const char* const	TEMP_SUFFIX;
+
+		// Existence
+		AtomicFileWriter();
+		~AtomicFileWriter();
+
+		// Methods
+		void	Open(const std::string& fileName);		// creates the temporary file
+		void	Write(const void* pData, size_t length);	// at the end
+		void	WriteAt(unsigned long long offset, const void* pData, size_t length);
+													// over what was written (e.g. a header)
+		void	Commit();							// flushes, renames and closes
+		void	Close();							// without Commit, removes the temporary file
+
+		// Access
+		bool				IsOpen() const;
+		unsigned long long	Length() const;		// written so far
+
+		// static methods
+		static unsigned int	NextTempNumber();		// the numbers before it were given to writers
+		static std::string	TempFileName(const std::string& fileName, unsigned int tempNumber);
+
+	private:
+		// constants
+		static const unsigned int	MAX_OPEN_ATTEMPTS = 100;	// temporary file names tried
+
+		// Implementation
+		void	WriteData(unsigned long long offset, const void* pData, size_t length);
+
+		// Not Implemented (copy constructor and equal operator)
+		AtomicFileWriter(const AtomicFileWriter& atomicFileWriter);
+		AtomicFileWriter& operator=(const AtomicFileWriter& atomicFileWriter);
+
+		// Data
+		std::string			fileName;
+		std::string			tempFileName;
+		unsigned long long	length;
+#ifdef _WIN32
+		void*				fileHandle;
+#else
+		int					fileDescriptor;
+#endif
+	};
+}
+#endif // !ATOMIC_FILE_WRITER_H
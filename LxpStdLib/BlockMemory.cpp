@@ -1,16 +1,28 @@
 #include "pch.h"
 #include "BlockMemory.h"
 
-#include <exception>
+#include <assert.h>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 namespace LxpStd
 {
 	// BLOCKMEMORY
-	BlockMemory::BlockMemory(unsigned int blockSize) :
-		blockSize(blockSize)
+	BlockMemory::BlockMemory(unsigned int blockSize, BlockSource blockSource) :
+		blockSize(blockSize),
+		blockSource(blockSource)
 	{
 		this->freePtr = NULL;
 		this->availableMemory = 0;
+		this->numUsedBlocks = 0;
+		this->bytesAllocated = 0;
+		this->bytesWasted = 0;
 	}
 
 	// ~BLOCKMEMORY
@@ -19,44 +31,204 @@ namespace LxpStd
 		DeallocateAll();
 	}
 
+	// ALIGN UP
+	char* BlockMemory::AlignUp(char* pMemory, unsigned int alignment)
+	{
+		uintptr_t address = (uintptr_t)pMemory;
+		return pMemory + ((alignment - (address & (alignment - 1))) & (alignment - 1));
+	}
+
 	// ALLOCATE
-	void* BlockMemory::Allocate(unsigned int size) throw(...)
+	void* BlockMemory::Allocate(unsigned int size, unsigned int alignment)
 	{
-		// allocation size request must not be greater than block size
-		if (size > this->blockSize)
-			throw std::exception("Requested allocation size is greater than block size");
+		// alignment must be a power of two
+		assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
 
-		// if there is not enough memory allocate new block
-		if (size > this->availableMemory)
+		// allocations that can't fit in a block get their own
+		if ((unsigned long long)size + alignment - 1 > this->blockSize)
+			return AllocateLarge(size, alignment);
+
+		// if there is not enough memory (after aligning) get the next block
+		unsigned int padding = (unsigned int)(AlignUp(this->freePtr, alignment) - this->freePtr);
+		if ((unsigned long long)padding + size > this->availableMemory)
+		{
+			this->bytesWasted += this->availableMemory;
 			AllocateNewBlock();
+			padding = (unsigned int)(AlignUp(this->freePtr, alignment) - this->freePtr);
+		}
 
-		void* newMemory = this->freePtr;
-		this->freePtr += size;
-		this->availableMemory -= size;
+		void* newMemory = this->freePtr + padding;
+		this->freePtr += padding + size;
+		this->availableMemory -= padding + size;
 
+		this->bytesAllocated += size;
+		this->bytesWasted += padding;
 		return newMemory;
 	}
 
+	// ALLOCATE LARGE
+	void* BlockMemory::AllocateLarge(unsigned int size, unsigned int alignment)
+	{
+		LargeAllocation largeAllocation;
+		largeAllocation.size = (size_t)size + alignment - 1;
+		largeAllocation.pMemory = AllocateMemory(largeAllocation.size);
+		this->largeAllocations.push_back(largeAllocation);
+
+		char* pMemory = AlignUp((char*)largeAllocation.pMemory, alignment);
+		this->bytesAllocated += size;
+		this->bytesWasted += largeAllocation.size - size;
+		return pMemory;
+	}
+
+	// ALLOCATE MEMORY
+	// a block (or a large allocation) from the block source
+	void* BlockMemory::AllocateMemory(size_t size) const
+	{
+		if (this->blockSource == BlockSource::HEAP)
+			return new char[size];
+
+#ifdef _WIN32
+		void* pMemory = NULL;
+		if (this->blockSource == BlockSource::HUGE_PAGES)
+		{
+			// needs the "lock pages in memory" privilege, regular pages otherwise
+			SIZE_T largePageSize = GetLargePageMinimum();
+			if (largePageSize != 0 && size % largePageSize == 0)
+				pMemory = VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+		}
+
+		if (pMemory == NULL)
+			pMemory = VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+		if (pMemory == NULL)
+			throw std::bad_alloc();
+
+		return pMemory;
+#else
+		if (this->blockSource == BlockSource::VIRTUAL_MEMORY)
+		{
+			void* pMemory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (pMemory == MAP_FAILED)
+				throw std::bad_alloc();
+
+			return pMemory;
+		}
+
+		// huge pages need huge page alignment, map more and unmap the unaligned ends
+		size_t mappedSize = size + BlockMemory::HUGE_PAGE_SIZE;
+		char* pMapped = (char*)mmap(NULL, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (pMapped == MAP_FAILED)
+			throw std::bad_alloc();
+
+		size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+		char* pMemory = AlignUp(pMapped, BlockMemory::HUGE_PAGE_SIZE);
+		char* pMemoryEnd = pMemory + (size + pageSize - 1) / pageSize * pageSize;
+		if (pMemory > pMapped)
+			munmap(pMapped, pMemory - pMapped);
+		if (pMapped + mappedSize > pMemoryEnd)
+			munmap(pMemoryEnd, pMapped + mappedSize - pMemoryEnd);
+
+#ifdef MADV_HUGEPAGE
+		madvise(pMemory, size, MADV_HUGEPAGE);	// only a hint
+#endif
+		return pMemory;
+#endif
+	}
+
 	// ALLOCATE NEW BLOCK
 	void BlockMemory::AllocateNewBlock(void)
 	{
-		this->freePtr = new char[this->blockSize];
+		// reuse a block kept by Reset
+		if (this->numUsedBlocks == this->newedMemoryVector.size())
+			this->newedMemoryVector.push_back(AllocateMemory(this->blockSize));
+
+		this->freePtr = (char*)this->newedMemoryVector[this->numUsedBlocks++];
 		this->availableMemory = this->blockSize;
-		this->newedMemoryVector.push_back(this->freePtr);
 	}
 
 	// DEALLOCATE ALL
 	void BlockMemory::DeallocateAll(void)
 	{
+		Reset();
+
 		// free all the blocks
 		for (std::vector<void*>::iterator itr = this->newedMemoryVector.begin();
 			itr != this->newedMemoryVector.end(); ++itr)
 		{
-			delete[](char *) *itr;
+			FreeMemory(*itr, this->blockSize);
 		}
-		
+
 		this->newedMemoryVector.clear();
+	}
+
+	// FREE MEMORY
+	void BlockMemory::FreeMemory(void* pMemory, size_t size) const
+	{
+		if (this->blockSource == BlockSource::HEAP)
+		{
+			delete[](char *) pMemory;
+			return;
+		}
+
+#ifdef _WIN32
+		VirtualFree(pMemory, 0, MEM_RELEASE);
+#else
+		munmap(pMemory, size);
+#endif
+	}
+
+	// GET MARK
+	void BlockMemory::GetMark(BlockMemoryMark& mark) const
+	{
+		mark.freePtr = this->freePtr;
+		mark.availableMemory = this->availableMemory;
+		mark.numUsedBlocks = this->numUsedBlocks;
+		mark.numLargeAllocations = this->largeAllocations.size();
+		mark.bytesAllocated = this->bytesAllocated;
+		mark.bytesWasted = this->bytesWasted;
+	}
+
+	// GET STATS
+	void BlockMemory::GetStats(BlockMemoryStats& stats) const
+	{
+		stats.bytesAllocated = this->bytesAllocated;
+		stats.bytesWasted = this->bytesWasted;
+		stats.numBlocks = this->newedMemoryVector.size();
+		stats.numLargeAllocations = this->largeAllocations.size();
+
+		stats.bytesReserved = (size_t)stats.numBlocks * this->blockSize;
+		for (unsigned int idx = 0; idx < this->largeAllocations.size(); idx++)
+			stats.bytesReserved += this->largeAllocations[idx].size;
+	}
+
+	// RELEASE
+	// the blocks used after the mark are kept for reuse (in order, as Reset does)
+	void BlockMemory::Release(const BlockMemoryMark& mark)
+	{
+		assert(mark.numUsedBlocks <= this->numUsedBlocks && mark.numLargeAllocations <= this->largeAllocations.size());
+
+		for (unsigned int idx = mark.numLargeAllocations; idx < this->largeAllocations.size(); idx++)
+			FreeMemory(this->largeAllocations[idx].pMemory, this->largeAllocations[idx].size);
+		this->largeAllocations.resize(mark.numLargeAllocations);
+
+		this->freePtr = mark.freePtr;
+		this->availableMemory = mark.availableMemory;
+		this->numUsedBlocks = mark.numUsedBlocks;
+		this->bytesAllocated = mark.bytesAllocated;
+		this->bytesWasted = mark.bytesWasted;
+	}
+
+	// RESET
+	void BlockMemory::Reset(void)
+	{
+		// large allocations are not reused (sizes vary)
+		for (unsigned int idx = 0; idx < this->largeAllocations.size(); idx++)
+			FreeMemory(this->largeAllocations[idx].pMemory, this->largeAllocations[idx].size);
+		this->largeAllocations.clear();
+
 		this->freePtr = NULL;
 		this->availableMemory = 0;
+		this->numUsedBlocks = 0;
+		this->bytesAllocated = 0;
+		this->bytesWasted = 0;
 	}
-}
\ No newline at end of file
+}
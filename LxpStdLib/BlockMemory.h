@@ -3,10 +3,38 @@
 #ifndef BLOCK_MEMORY_H
 #define BLOCK_MEMORY_H
 
+#include <climits>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
 #include <vector>
 
 namespace LxpStd
 {
+	typedef struct BlockMemoryMarkStruct	BlockMemoryMark;
+	typedef struct BlockMemoryStatsStruct	BlockMemoryStats;
+
+	// this structure is a position in a BlockMemory to release back to (see Release)
+	struct BlockMemoryMarkStruct
+	{
+		char*			freePtr;
+		unsigned int	availableMemory;
+		unsigned int	numUsedBlocks;
+		unsigned int	numLargeAllocations;
+		size_t			bytesAllocated;
+		size_t			bytesWasted;
+	};
+
+	// this structure is for reporting the memory use of a BlockMemory
+	struct BlockMemoryStatsStruct
+	{
+		size_t			bytesAllocated;			// requested by the allocations (since the last Reset)
+		size_t			bytesWasted;			// alignment padding and the unused ends of blocks
+		size_t			bytesReserved;			// blocks and large allocations held
+		unsigned int	numBlocks;				// (including the ones kept for reuse by Reset)
+		unsigned int	numLargeAllocations;	// larger than a block (see below)
+	};
+
 	// This class is useful when a lot of small memory allocations are needed.
 	// There is no overhead for a single memory allocation call (almost none).
 	// There is overhead for the whole class but it is very small. There
@@ -18,26 +46,62 @@ namespace LxpStd
 	// this class as a memory allocator for the whole word list will be
 	// efficient.
 	//
-	// The returned address is not guaranteed to be aligned on anything other
-	// than a char
+	// The returned address is aligned on the requested alignment (a power of two);
+	// by default it is not aligned on anything other than a char. Allocate<T> aligns
+	// on T (which must not need its destructor called, as nothing is ever destroyed).
+	// An allocation larger than a block gets a block of its own.
+	//
+	// Reset frees all the allocations but keeps the blocks, so that building the same
+	// kind of data again doesn't go back to the heap. DeallocateAll returns the blocks.
+	// Release does the same for the allocations made after a mark, so the memory can be
+	// used like a stack for temporary buffers (see ScratchMemory).
+	//
+	// Blocks come from the heap, or directly from the operating system (VIRTUAL_MEMORY)
+	// in which case HUGE_PAGES also asks for them to be backed by huge pages where
+	// possible (fewer TLB misses for large, randomly accessed data like Trie nodes).
 
 	class BlockMemory
 	{
 	public:
 		// constants
 		static const unsigned int	DEFAULT_BLOCK_SIZE = 4096;
+		static const unsigned int	HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+		enum class BlockSource {HEAP, VIRTUAL_MEMORY, HUGE_PAGES};
 
 		// Existence
-		BlockMemory(unsigned int blockSize = DEFAULT_BLOCK_SIZE);
+		BlockMemory(unsigned int blockSize = DEFAULT_BLOCK_SIZE, BlockSource blockSource = BlockSource::HEAP);
 		~BlockMemory();
 
 		// Methods
-		void*	Allocate(unsigned int size);	// Allocates requested size memory
+		void*	Allocate(unsigned int size, unsigned int alignment = 1);	// Allocates requested size memory
+		template <typename T>
+		T*		Allocate(unsigned int count);	// count Ts (not constructed)
 		void	DeallocateAll();				// Deallocates all the allocations
+		void	Release(const BlockMemoryMark& mark);	// Deallocates the allocations made after the mark, keeping the blocks
+		void	Reset();						// Deallocates all the allocations, keeping the blocks
+
+		// Access
+		void	GetMark(BlockMemoryMark& mark) const;
+
+		// Diagnostics
+		void	GetStats(BlockMemoryStats& stats) const;
 
 	private:
+		struct LargeAllocationStruct
+		{
+			void*	pMemory;
+			size_t	size;
+		};
+		typedef struct LargeAllocationStruct	LargeAllocation;
+
 		// Implementation
 		void	AllocateNewBlock(void);
+		void*	AllocateLarge(unsigned int size, unsigned int alignment);
+		void*	AllocateMemory(size_t size) const;
+		void	FreeMemory(void* pMemory, size_t size) const;
+
+		static char*	AlignUp(char* pMemory, unsigned int alignment);
 
 		// Not Implemented (copy constructor and equal operator)
 		BlockMemory(const BlockMemory& blockMemory);
@@ -45,11 +109,27 @@ namespace LxpStd
 
 		// Data
 		const unsigned int	blockSize;
+		const BlockSource	blockSource;
 		char*				freePtr;
 		unsigned int		availableMemory;
-		std::vector<void*>	newedMemoryVector;
+		std::vector<void*>	newedMemoryVector;	// blocks
+		unsigned int		numUsedBlocks;		// blocks in use since the last Reset
+		std::vector<LargeAllocation>	largeAllocations;
+
+		size_t				bytesAllocated;
+		size_t				bytesWasted;
 	};
 
+	// ALLOCATE
+	template <typename T>
+	T* BlockMemory::Allocate(unsigned int count)
+	{
+		static_assert(std::is_trivially_destructible<T>::value, "BlockMemory never calls destructors");
+
+		if (count > UINT_MAX / sizeof(T))
+			throw(std::runtime_error("Requested allocation size is too large"));
+
+		return (T*)Allocate(count * (unsigned int)sizeof(T), (unsigned int)alignof(T));
+	}
 }
 #endif // !BLOCK_MEMORY_H
-
@@ -0,0 +1,187 @@
+#include "pch.h"
+#include "Board.h"
+#include "Dawg.h"
+
+#include <assert.h>
+#include <cstring>
+#include <stdexcept>
+
+using namespace std;
+
+namespace LxpStd
+{
+	// CONSTRUCTOR
+	Board::Board()
+	{
+		Clear();
+		SetStandardPremiumSquares();
+	}
+
+	// DESTRUCTOR
+	Board::~Board()
+	{
+	}
+
+	// CLEAR
+	void Board::Clear()
+	{
+		memset(this->tiles, Board::EMPTY_SQUARE, sizeof(this->tiles));
+		this->numTiles = 0;
+	}
+
+	// GET LETTER MULTIPLIER
+	int Board::GetLetterMultiplier(PremiumSquare premiumSquare)
+	{
+		if (premiumSquare == PremiumSquare::DOUBLE_LETTER)
+			return 2;
+		else if (premiumSquare == PremiumSquare::TRIPLE_LETTER)
+			return 3;
+
+		return 1;
+	}
+
+	// GET PREMIUM SQUARE
+	PremiumSquare Board::GetPremiumSquare(int row, int col) const
+	{
+		assert(row >= 0 && row < Board::SIZE && col >= 0 && col < Board::SIZE);
+		return this->premiumSquares[row][col];
+	}
+
+	// GET TILE
+	char Board::GetTile(int row, int col) const
+	{
+		assert(row >= 0 && row < Board::SIZE && col >= 0 && col < Board::SIZE);
+		return this->tiles[row][col];
+	}
+
+	// GET TILE SCORE
+	// standard English tile values
+	int Board::GetTileScore(char tile)
+	{
+		static const int letterScores[Dawg::END_LETTER - Dawg::START_LETTER + 1] =
+		{
+			1, 3, 3, 2, 1, 4, 2, 4, 1, 8, 5, 1, 3,		// A - M
+			1, 1, 3, 10, 1, 1, 1, 1, 4, 4, 8, 4, 10		// N - Z
+		};
+
+		if (tile >= Dawg::START_LETTER && tile <= Dawg::END_LETTER)
+			return letterScores[tile - Dawg::START_LETTER];
+
+		return 0;	// blank tiles or empty square
+	}
+
+	// GET WORD MULTIPLIER
+	int Board::GetWordMultiplier(PremiumSquare premiumSquare)
+	{
+		if (premiumSquare == PremiumSquare::DOUBLE_WORD)
+			return 2;
+		else if (premiumSquare == PremiumSquare::TRIPLE_WORD)
+			return 3;
+
+		return 1;
+	}
+
+	// IS EMPTY
+	bool Board::IsEmpty() const
+	{
+		return this->numTiles == 0;
+	}
+
+	// IS VALID TILE
+	bool Board::IsValidTile(char tile)
+	{
+		return (tile >= 'A' && tile <= 'Z') || (tile >= 'a' && tile <= 'z');
+	}
+
+	// PLACE MOVE
+	void Board::PlaceMove(const Move& move)
+	{
+		int length = (int)strlen(move.word);
+		int row = move.row;
+		int col = move.col;
+		if (length == 0 || (move.isAcross ? col + length : row + length) > Board::SIZE)
+			throw(std::runtime_error("Move does not fit on the board!"));
+
+		for (int idx = 0; idx < length; idx++)
+		{
+			if ((move.placedMask & (1U << idx)) != 0)
+			{
+				if (this->tiles[row][col] != Board::EMPTY_SQUARE)
+					throw(std::runtime_error("Move places a tile on an occupied square!"));
+				SetTile(row, col, move.word[idx]);
+			}
+
+			if (move.isAcross)
+				col++;
+			else
+				row++;
+		}
+	}
+
+	// SET PREMIUM SQUARE
+	void Board::SetPremiumSquare(int row, int col, PremiumSquare premiumSquare)
+	{
+		ValidateSquare(row, col);
+		this->premiumSquares[row][col] = premiumSquare;
+	}
+
+	// SET STANDARD PREMIUM SQUARES
+	// one quadrant of the standard layout, mirrored to the others
+	void Board::SetStandardPremiumSquares()
+	{
+		static const char* pQuadrant[Board::CENTER + 1] =
+		{
+			"T  d   T",
+			" D   t  ",
+			"  D   d ",
+			"d  D   d",
+			"    D   ",
+			" t   t  ",
+			"  d   d ",
+			"T  d   D"
+		};
+
+		for (int row = 0; row < Board::SIZE; row++)
+		{
+			for (int col = 0; col < Board::SIZE; col++)
+			{
+				int quadrantRow = row <= Board::CENTER ? row : Board::SIZE - 1 - row;
+				int quadrantCol = col <= Board::CENTER ? col : Board::SIZE - 1 - col;
+
+				PremiumSquare premiumSquare = PremiumSquare::NONE;
+				switch (pQuadrant[quadrantRow][quadrantCol])
+				{
+				case 'd': premiumSquare = PremiumSquare::DOUBLE_LETTER; break;
+				case 't': premiumSquare = PremiumSquare::TRIPLE_LETTER; break;
+				case 'D': premiumSquare = PremiumSquare::DOUBLE_WORD; break;
+				case 'T': premiumSquare = PremiumSquare::TRIPLE_WORD; break;
+				}
+
+				this->premiumSquares[row][col] = premiumSquare;
+			}
+		}
+	}
+
+	// SET TILE
+	void Board::SetTile(int row, int col, char tile)
+	{
+		ValidateSquare(row, col);
+		if (tile != Board::EMPTY_SQUARE && !IsValidTile(tile))
+			throw(std::runtime_error("Invalid tile!"));
+
+		// keep the tile count up to date
+		if (this->tiles[row][col] != Board::EMPTY_SQUARE)
+			this->numTiles--;
+		if (tile != Board::EMPTY_SQUARE)
+			this->numTiles++;
+
+		this->tiles[row][col] = tile;
+	}
+
+	// VALIDATE SQUARE
+	void Board::ValidateSquare(int row, int col)
+	{
+		if (row < 0 || row >= Board::SIZE || col < 0 || col >= Board::SIZE)
+			throw(std::runtime_error("Square is outside the board!"));
+	}
+};
@@ -0,0 +1,70 @@
+// Board.h
+
+#ifndef BOARD_H
+#define BOARD_H
+
+namespace LxpStd
+{
+	typedef struct MoveStruct	Move;
+
+	enum class PremiumSquare : unsigned char {NONE, DOUBLE_LETTER, TRIPLE_LETTER, DOUBLE_WORD, TRIPLE_WORD};
+
+	// Tiles on the board are upper case letters. Blank tiles are the lower case
+	// letter they stand for. Empty squares are EMPTY_SQUARE.
+
+	class Board
+	{
+	public:
+		// common constants
+		static const int	SIZE = 15;
+		static const int	CENTER = SIZE / 2;
+		static const char	EMPTY_SQUARE = ' ';
+
+		// Existence
+		Board();	// empty board with the standard premium squares
+		~Board();
+
+		// Methods
+		void	Clear();											// removes all the tiles
+		void	PlaceMove(const Move& move);				// places the tiles of the move
+		void	SetPremiumSquare(int row, int col, PremiumSquare premiumSquare);
+		void	SetTile(int row, int col, char tile);	// EMPTY_SQUARE removes the tile
+
+		// Access
+		PremiumSquare	GetPremiumSquare(int row, int col) const;
+		char			GetTile(int row, int col) const;			// EMPTY_SQUARE if there is no tile
+		bool			IsEmpty() const;							// no tiles at all?
+
+		// static methods
+		static int		GetLetterMultiplier(PremiumSquare premiumSquare);
+		static int		GetTileScore(char tile);					// blank tiles (lower case) score 0
+		static int		GetWordMultiplier(PremiumSquare premiumSquare);
+		static bool		IsValidTile(char tile);
+
+	private:
+		// Implementation
+		void	SetStandardPremiumSquares();
+
+		// static methods
+		static void		ValidateSquare(int row, int col);
+
+		// Data
+		char			tiles[SIZE][SIZE];
+		PremiumSquare	premiumSquares[SIZE][SIZE];
+		unsigned int	numTiles;
+	};
+
+	// A play on the board as generated by MoveGenerator
+	struct MoveStruct
+	{
+		int				row;						// of the first letter of the word
+		int				col;
+		bool			isAcross;
+		char			word[Board::SIZE + 1];		// including the tiles already on the board (lower case for blanks)
+		unsigned int	placedMask;					// bit N is set if letter N of the word is placed by this move
+		unsigned int	numTilesPlaced;
+		int				score;
+	};
+}
+
+#endif // !BOARD_H
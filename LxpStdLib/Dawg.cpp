@@ -1,23 +1,38 @@
 #include "pch.h"
 #include "Dawg.h"
 #include "LxpStdLib.h"
+#include "TreeWalkStack.h"
 
+#include <algorithm>
 #include <assert.h>
+#include <cctype>
+#include <climits>
 #include <cstring>
 #include <ctime>
-#include <string>
 #include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 using namespace std;
 
 namespace LxpStd
 {
 	// CONSTRUCTOR
-	DawgCreator::DawgCreator(const string& lexiconName, unsigned int numNodes, unsigned int numWords)
+	DawgCreator::DawgCreator(const string& lexiconName, unsigned int numNodes, unsigned int numWords,
+							 DawgFileFormat fileFormat)
 	{
+		if (fileFormat == DawgFileFormat::V1 && numNodes > DawgFile::V1_MAX_NODES)
+			throw(std::runtime_error("Too many nodes for a V1 Dawg file!"));
+
 		CreateHeader(lexiconName, numNodes, numWords);
-		this->pNodes = new DawgNode[numNodes];
+		this->pNodes = NULL;		// (allocated by the first AddNode, unless streamed)
 		this->numAddedNodes = 0;
+		this->fileFormat = fileFormat;
+		this->isStreamed = false;
+		this->numChunkNodes = 0;
+		this->crc = 0;
 	}
 
 	// DESTRUCTOR
@@ -30,61 +45,321 @@ namespace LxpStd
 	void DawgCreator::AddNode(DawgNode& dawgNode)
 	{
 		assert(this->numAddedNodes < this->header.numNodes);
-		assert(this->pNodes != NULL);
 
-		this->pNodes[this->numAddedNodes++] = dawgNode;
+		if (this->isStreamed)
+			WriteNodeToFile(dawgNode);
+		else
+		{
+			if (this->pNodes == NULL)
+				this->pNodes = new DawgNode[this->header.numNodes];
+			this->pNodes[this->numAddedNodes] = dawgNode;
+		}
+		this->numAddedNodes++;
 	}
 
 	// CREATE HEADER
 	void DawgCreator::CreateHeader(const string& lexiconName, unsigned int numNodes, unsigned int numWords)
 	{
-		// fill the date string
+		// unused bytes are zero so that the same words always give the same file
+		memset(&this->header, 0, sizeof(this->header));
+
+		// fill the date string (and the date of V2 files)
 		time_t nowTime;
 		struct tm* pLocaltime;
 		time(&nowTime);
 		pLocaltime = localtime(&nowTime);
 		strftime(this->header.date, Dawg::HEADER_DATE_LENGTH, "%d %B %Y", pLocaltime);
+		this->creationDate = (pLocaltime->tm_year + 1900) * 10000 + (pLocaltime->tm_mon + 1) * 100 + pLocaltime->tm_mday;
 
 		// lexicon name
 		int lexiconNameLength = lexiconName.length();
-		if (lexiconNameLength > Dawg::HEADER_LEXICON_NAME_LENGTH)
+		if (lexiconNameLength >= Dawg::HEADER_LEXICON_NAME_LENGTH)
 		{
-			lexiconName._Copy_s(this->header.lexiconName, Dawg::HEADER_LEXICON_NAME_LENGTH,
-				Dawg::HEADER_LEXICON_NAME_LENGTH, 0);
+			memcpy(this->header.lexiconName, lexiconName.c_str(), Dawg::HEADER_LEXICON_NAME_LENGTH);
 		}
 		else
 		{
-			lexiconName._Copy_s(this->header.lexiconName, Dawg::HEADER_LEXICON_NAME_LENGTH,
-				lexiconNameLength, 0);
+			memcpy(this->header.lexiconName, lexiconName.c_str(), lexiconNameLength);
 			this->header.lexiconName[lexiconNameLength] = '\0';
 		}
 
 		// other attributes!
 		this->header.numNodes = numNodes;
 		this->header.numWords = numWords;
-		this->header.size = sizeof DawgHeader;
+		this->header.size = sizeof(DawgHeader);
+	}
+
+	// FINISH FILE
+	// The checksum covers the whole file, so the V2 header is written again at the end
+	// with it. (The V1 header has nothing to add.)
+	void DawgCreator::FinishFile()
+	{
+		if (this->fileFormat == DawgFileFormat::V2)
+		{
+			char headerData[DawgFile::HEADER_SIZE];
+			this->fileHeader.checksum = this->crc;
+			DawgFile::WriteHeader(this->fileHeader, headerData);
+			this->dawgFile.WriteAt(0, headerData, sizeof(headerData));
+		}
+
+		this->dawgFile.Commit();
+	}
+
+	// LAY OUT NODES
+	// The sibling lists are found breadth first from the root and, for ACCESS_FREQUENCY,
+	// sorted by the number of lookups of the sample words scanning them (a stable sort, so
+	// breadth first among equals). A lookup scans the lists of a word from the top, so a list
+	// is never scanned more than its parent list and follows it. The root list and its child
+	// list (the forward and reverse nodes) are kept first so their ids don't change.
+	void DawgCreator::LayOutNodes(DawgNodeLayout nodeLayout, const vector<string>& sampleWords)
+	{
+		unsigned int numNodes = this->header.numNodes;
+
+		// first node of each sibling list
+		vector<unsigned int> listStarts = { Dawg::ROOT_NODE_ID };	// (a copy, the constant has no definition to refer to)
+		vector<bool> isListFound(numNodes, false);
+		isListFound[Dawg::ROOT_NODE_ID] = true;
+		for (size_t listIdx = 0; listIdx < listStarts.size(); listIdx++)
+		{
+			unsigned int nodeId = listStarts[listIdx];
+			do
+			{
+				if (nodeId >= numNodes)
+					throw(std::runtime_error("Sibling list has no last child! Bug?"));
+
+				unsigned int childNodeId = this->pNodes[nodeId].childNodeId;
+				if (childNodeId >= numNodes)
+					throw(std::runtime_error("Child node id is out of range! Bug?"));
+
+				if (childNodeId != 0 && !isListFound[childNodeId])
+				{
+					isListFound[childNodeId] = true;
+					listStarts.push_back(childNodeId);
+				}
+			} while (this->pNodes[nodeId++].isLastChild != TRUE);
+		}
+
+		if (nodeLayout == DawgNodeLayout::ACCESS_FREQUENCY)
+		{
+			// the lists scanned by IsWord for each sample word
+			vector<unsigned int> numScans(numNodes, 0);
+			for (size_t wordIdx = 0; wordIdx < sampleWords.size(); wordIdx++)
+			{
+				const string& word = sampleWords[wordIdx];
+				unsigned int nodeId = this->pNodes[Dawg::FORWARD_WORD_NODE_ID].childNodeId;
+				for (size_t idx = 0; idx < word.length() && nodeId != 0; idx++)
+				{
+					numScans[nodeId]++;
+
+					char letter = (char)toupper((unsigned char)word[idx]);
+					while (this->pNodes[nodeId].letter != letter && this->pNodes[nodeId].isLastChild != TRUE)
+						nodeId++;
+
+					nodeId = this->pNodes[nodeId].letter == letter ? this->pNodes[nodeId].childNodeId : 0;
+				}
+			}
+
+			numScans[Dawg::FORWARD_WORD_NODE_ID] = UINT_MAX;
+			stable_sort(listStarts.begin() + 1, listStarts.end(),
+						[&numScans](unsigned int listStart1, unsigned int listStart2) { return numScans[listStart1] > numScans[listStart2]; });
+		}
+
+		// the lists up to HOT_NODES nodes go first, the others stay in the order they were added
+		size_t numHotLists = 0;
+		unsigned int numHotNodes = 0;
+		while (numHotLists < listStarts.size())
+		{
+			unsigned int listLength = 0;
+			for (unsigned int nodeId = listStarts[numHotLists]; this->pNodes[nodeId].isLastChild != TRUE; nodeId++)
+				listLength++;
+
+			if (numHotLists > 1 && numHotNodes + listLength + 1 > DawgCreator::HOT_NODES)
+				break;
+
+			numHotNodes += listLength + 1;
+			numHotLists++;
+		}
+
+		sort(listStarts.begin() + numHotLists, listStarts.end());
+
+		// new ids in the order of the lists
+		vector<unsigned int> newNodeIds(numNodes);
+		unsigned int nextNodeId = 0;
+		for (size_t listIdx = 0; listIdx < listStarts.size(); listIdx++)
+		{
+			unsigned int nodeId = listStarts[listIdx];
+			do
+			{
+				if (nextNodeId == numNodes)
+					throw(std::runtime_error("Sibling lists overlap! Bug?"));
+				newNodeIds[nodeId] = nextNodeId++;
+			} while (this->pNodes[nodeId++].isLastChild != TRUE);
+		}
+
+		if (nextNodeId != numNodes)
+			throw(std::runtime_error("Some nodes are not in any sibling list! Bug?"));
+
+		DawgNode* pLaidOutNodes = new DawgNode[numNodes];
+		for (unsigned int nodeId = 0; nodeId < numNodes; nodeId++)
+		{
+			DawgNode& laidOutNode = pLaidOutNodes[newNodeIds[nodeId]];
+			laidOutNode = this->pNodes[nodeId];
+			if (laidOutNode.childNodeId != 0)
+				laidOutNode.childNodeId = newNodeIds[laidOutNode.childNodeId];
+		}
+
+		delete[] this->pNodes;
+		this->pNodes = pLaidOutNodes;
 	}
 
 	// SAVE DAWG
-	void DawgCreator::SaveDawg(const string& fileName) throw(...)
+	void DawgCreator::SaveDawg(const string& fileName, DawgNodeLayout nodeLayout, const vector<string>& sampleWords,
+							   bool isChildMasks)
 	{
 		// validation
-		assert(this->pNodes != NULL);
 		if (this->numAddedNodes != this->header.numNodes)
-			throw(std::exception("Requested number of nodes not added!"));
+			throw(std::runtime_error("Requested number of nodes not added!"));
 
-		// create file in binary mode
-		ofstream dawgStream;
-		dawgStream.open(fileName, ofstream::out | ofstream::binary);
+		if (isChildMasks && this->fileFormat == DawgFileFormat::V1)
+			throw(std::runtime_error("Child masks can only be saved in V2 Dawg files!"));
 
-		// write header
-		dawgStream.write((const char*)(&(this->header)), sizeof(this->header));
+		if (this->isStreamed)
+		{
+			// (the nodes are in the file already)
+			if (fileName != this->streamFileName || nodeLayout != DawgNodeLayout::DEPTH_FIRST || isChildMasks)
+				throw(std::runtime_error("Streamed Dawg can only be saved to its file, depth first, without child masks!"));
+		}
+		else
+		{
+			if (nodeLayout != DawgNodeLayout::DEPTH_FIRST)
+				LayOutNodes(nodeLayout, sampleWords);
 
-		// write nodes
-		dawgStream.write((const char*)(this->pNodes), sizeof(DawgNode) * this->header.numNodes);
+			StartFile(fileName, isChildMasks);
+			for (unsigned int nodeId = 0; nodeId < this->header.numNodes; nodeId++)
+				WriteNodeToFile(this->pNodes[nodeId]);
+		}
+		WriteNodeChunk();
+
+		if (isChildMasks)
+			WriteChildMasks();
 
-		// close the stream
-		dawgStream.close();
+		FinishFile();
+	}
+
+	// START FILE
+	// V1 files start with the header. V2 files start with the header (without the checksum
+	// until FinishFile), the section table and the padding up to the nodes. The sections
+	// are the nodes and the child masks (if asked for).
+	void DawgCreator::StartFile(const string& fileName, bool isChildMasks)
+	{
+		this->dawgFile.Open(fileName);
+		// (copies, max takes references and the constants have no definition)
+		unsigned int nodeSize = DawgFile::NODE_SIZE;
+		unsigned int childMaskSize = DawgFile::CHILD_MASK_SIZE;
+		this->chunk.resize(DawgCreator::CHUNK_NODES * max(nodeSize, childMaskSize));
+		this->numChunkNodes = 0;
+		this->crc = 0;
+
+		if (this->fileFormat == DawgFileFormat::V1)
+		{
+			WriteToFile((const char*)(&(this->header)), sizeof(this->header));
+			return;
+		}
+
+		this->fileHeader.version = DawgFile::VERSION;
+		this->fileHeader.headerSize = DawgFile::HEADER_SIZE;
+		this->fileHeader.numSections = isChildMasks ? 2 : 1;
+		this->fileHeader.numNodes = this->header.numNodes;
+		this->fileHeader.numWords = this->header.numWords;
+		this->fileHeader.creationDate = this->creationDate;
+		this->fileHeader.checksum = 0;
+		this->fileHeader.headerChecksum = 0;
+		memcpy(this->fileHeader.lexiconName, this->header.lexiconName, sizeof(this->fileHeader.lexiconName));
+
+		DawgFileSection nodesSection;
+		nodesSection.type = DawgFile::NODES_SECTION;
+		nodesSection.offset = DawgFile::AlignSection(DawgFile::HEADER_SIZE + this->fileHeader.numSections * DawgFile::SECTION_ENTRY_SIZE);
+		nodesSection.size = (unsigned long long)this->header.numNodes * DawgFile::NODE_SIZE;
+
+		DawgFileSection childMasksSection;
+		childMasksSection.type = DawgFile::CHILD_MASKS_SECTION;
+		childMasksSection.offset = DawgFile::AlignSection(nodesSection.offset + nodesSection.size);
+		childMasksSection.size = (unsigned long long)this->header.numNodes * DawgFile::CHILD_MASK_SIZE;
+
+		vector<char> headerData((size_t)nodesSection.offset, '\0');
+		DawgFile::WriteHeader(this->fileHeader, &headerData[0]);
+		DawgFile::WriteSection(nodesSection, &headerData[DawgFile::HEADER_SIZE]);
+		if (isChildMasks)
+			DawgFile::WriteSection(childMasksSection, &headerData[DawgFile::HEADER_SIZE + DawgFile::SECTION_ENTRY_SIZE]);
+		this->fileHeader.headerChecksum = DawgFile::HeaderChecksum(&headerData[0], DawgFile::HEADER_SIZE + this->fileHeader.numSections * DawgFile::SECTION_ENTRY_SIZE);
+		DawgFile::WriteHeader(this->fileHeader, &headerData[0]);
+		WriteToFile(&headerData[0], headerData.size());
+	}
+
+	// STREAM DAWG
+	// The nodes then go to the file (through the chunk) as they are added, instead of
+	// being kept, so only the builder holds the whole Dawg in memory.
+	void DawgCreator::StreamDawg(const string& fileName)
+	{
+		if (this->numAddedNodes > 0)
+			throw(std::runtime_error("Dawg can only be streamed before the nodes are added!"));
+
+		StartFile(fileName, false);
+		this->isStreamed = true;
+		this->streamFileName = fileName;
+	}
+
+	// WRITE CHILD MASKS
+	// padding up to the section, then a chunk at a time (as the nodes)
+	void DawgCreator::WriteChildMasks()
+	{
+		unsigned long long nodesEnd = this->dawgFile.Length();
+		vector<char> padding((size_t)(DawgFile::AlignSection(nodesEnd) - nodesEnd), '\0');
+		WriteToFile(padding.data(), padding.size());
+
+		auto getNode = [this](unsigned int nodeId) { return this->pNodes[nodeId]; };
+		for (unsigned int chunkStart = 0; chunkStart < this->header.numNodes; chunkStart += DawgCreator::CHUNK_NODES)
+		{
+			unsigned int numChunkNodes = this->header.numNodes - chunkStart;
+			if (numChunkNodes > DawgCreator::CHUNK_NODES)
+				numChunkNodes = DawgCreator::CHUNK_NODES;
+			for (unsigned int idx = 0; idx < numChunkNodes; idx++)
+			{
+				unsigned int nodeId = chunkStart + idx;
+				DawgFile::WriteChildMask(Dawg::GetChildMask(getNode, this->header.numNodes, nodeId), this->pNodes[nodeId].childNodeId,
+										 &this->chunk[idx * DawgFile::CHILD_MASK_SIZE]);
+			}
+
+			WriteToFile(&this->chunk[0], numChunkNodes * DawgFile::CHILD_MASK_SIZE);
+		}
+	}
+
+	// WRITE NODE CHUNK
+	void DawgCreator::WriteNodeChunk()
+	{
+		unsigned int nodeSize = this->fileFormat == DawgFileFormat::V1 ? DawgFile::V1_NODE_SIZE : DawgFile::NODE_SIZE;
+		WriteToFile(&this->chunk[0], this->numChunkNodes * nodeSize);
+		this->numChunkNodes = 0;
+	}
+
+	// WRITE NODE TO FILE
+	void DawgCreator::WriteNodeToFile(const DawgNode& dawgNode)
+	{
+		if (this->fileFormat == DawgFileFormat::V1)
+			DawgFile::WriteV1Node(dawgNode, &this->chunk[this->numChunkNodes * DawgFile::V1_NODE_SIZE]);
+		else
+			DawgFile::WriteNode(dawgNode, &this->chunk[this->numChunkNodes * DawgFile::NODE_SIZE]);
+
+		if (++this->numChunkNodes == DawgCreator::CHUNK_NODES)
+			WriteNodeChunk();
+	}
+
+	// WRITE TO FILE
+	void DawgCreator::WriteToFile(const char* pData, size_t length)
+	{
+		this->dawgFile.Write(pData, length);
+		if (this->fileFormat == DawgFileFormat::V2)
+			this->crc = DawgFile::Crc32(this->crc, pData, length);
 	}
 };
 
@@ -94,7 +369,12 @@ namespace LxpStd
 	Dawg::Dawg()
 	{
 		this->pNodes = NULL;
+		this->fileFormat = DawgFileFormat::V2;
 		this->numReversePartWords = 0;
+		this->pNumReversePartWordsOnce.reset(new once_flag());
+		this->pChildIndex = NULL;
+		this->isChildIndexMapped = false;
+		memset(this->directIndexes, 0, sizeof(this->directIndexes));
 	}
 
 	// DESTRUCTOR
@@ -103,15 +383,215 @@ namespace LxpStd
 		Cleanup();
 	}
 
+	// ANAGRAM TREE
+	// *** To be called for first child only ***
+	// A letter is taken from the rack if available, otherwise a blank is used for it (using
+	// a blank when the letter is available can't find any other word)
+	unsigned int Dawg::AnagramTree(unsigned int nodeId, Rack& rack, bool isSubAnagram, WordBuffer& word,
+								   const WordCallback& callback) const
+	{
+		unsigned int numAnagrams = 0;
+
+		// recursion stop conditions
+		if (nodeId == 0 || rack.numTiles == 0)
+			return numAnagrams;
+
+		do
+		{
+			const DawgNode node = GetNode(nodeId);
+			unsigned char& letterCount = rack.letterCounts[node.letter - Dawg::START_LETTER];
+
+			// prune if the letter is exhausted (and there are no blanks)
+			bool isBlankUsed = false;
+			if (letterCount > 0)
+				letterCount--;
+			else if (rack.numBlanks > 0)
+			{
+				rack.numBlanks--;
+				isBlankUsed = true;
+			}
+			else
+				continue;
+
+			rack.numTiles--;
+			Dawg::PushLetter(word, (char)node.letter);
+
+			if (node.isTerminal == TRUE && (isSubAnagram || rack.numTiles == 0))
+			{
+				callback(word.pLetters);
+				numAnagrams++;
+			}
+
+			numAnagrams += AnagramTree(node.childNodeId, rack, isSubAnagram, word, callback);
+
+			// put the tile back
+			Dawg::PopLetter(word);
+			rack.numTiles++;
+			if (isBlankUsed)
+				rack.numBlanks++;
+			else
+				letterCount++;
+		} while (GetNode(nodeId++).isLastChild != TRUE);
+
+		return numAnagrams;
+	}
+
+	// ANAGRAMS
+	unsigned int Dawg::Anagrams(const string& rack, const WordCallback& callback) const
+	{
+		return FindAnagrams(rack, false, callback);
+	}
+
+	// ARE WORDS
+	// Matching a word is a chain of dependent node reads, mostly cache misses for large
+	// Dawgs. The words are matched BATCH_LANES at a time in lockstep: each lane matches one
+	// letter per round and prefetches the sibling list it needs next, so the cache misses
+	// of the lanes overlap instead of being waited for one after the other.
+	unsigned int Dawg::AreWords(const char* pWords, const unsigned int* pOffsets, unsigned int numWords,
+								unsigned int* pIsWordBits) const
+	{
+		assert(IsLoaded());
+		memset(pIsWordBits, 0, sizeof(unsigned int) * ((numWords + 31) / 32));
+
+		// start the lanes
+		BatchLane lanes[Dawg::BATCH_LANES];
+		unsigned int numLanes = 0;
+		unsigned int nextWordIdx = 0;
+		while (numLanes < Dawg::BATCH_LANES && StartBatchLane(lanes[numLanes], pWords, pOffsets, numWords, nextWordIdx))
+			numLanes++;
+
+		unsigned int numValidWords = 0;
+		while (numLanes > 0)
+		{
+			unsigned int laneIdx = 0;
+			while (laneIdx < numLanes)
+			{
+				BatchLane& lane = lanes[laneIdx];
+
+				unsigned int nodeId = FindChildNode(lane.nodeId, pWords[lane.letterIdx]);
+
+				bool isLaneDone = true;
+				if (nodeId != 0)
+				{
+					if (++lane.letterIdx == lane.endLetterIdx)
+					{
+						if (IsTerminalNode(nodeId))
+						{
+							pIsWordBits[lane.wordIdx / 32] |= 1U << (lane.wordIdx % 32);
+							numValidWords++;
+						}
+					}
+					else
+					{
+						// the next letter is matched in the children of the node
+						lane.nodeId = nodeId;
+						if (this->pChildIndex != NULL)
+							LXP_PREFETCH(&(this->pChildIndex[nodeId]));
+						else
+							PrefetchNode(GetNode(nodeId).childNodeId);
+						isLaneDone = false;
+					}
+				}
+
+				// the lane takes the next word (or the last lane takes its place)
+				if (!isLaneDone || StartBatchLane(lane, pWords, pOffsets, numWords, nextWordIdx))
+					laneIdx++;
+				else
+					lane = lanes[--numLanes];
+			}
+		}
+
+		return numValidWords;
+	}
+
+	// BUILD CHILD MASKS
+	void Dawg::BuildChildMasks()
+	{
+		assert(IsLoaded());
+
+		auto getNode = [this](unsigned int nodeId) { return GetNode(nodeId); };
+		ChildIndex* pIndex = new ChildIndex[this->header.numNodes];
+		try
+		{
+			for (unsigned int parentNodeId = 0; parentNodeId < this->header.numNodes; parentNodeId++)
+			{
+				pIndex[parentNodeId].childMask = Dawg::GetChildMask(getNode, this->header.numNodes, parentNodeId);
+				pIndex[parentNodeId].childNodeId = GetNode(parentNodeId).childNodeId;
+			}
+		}
+		catch (...)
+		{
+			delete[] pIndex;
+			throw;
+		}
+
+		if (!this->isChildIndexMapped)
+			delete[] this->pChildIndex;
+		this->pChildIndex = pIndex;
+		this->isChildIndexMapped = false;
+	}
+
+	// BUILD DIRECT INDEXES
+	// from the sibling lists of the first two letters (of the forward and reverse trees)
+	void Dawg::BuildDirectIndexes()
+	{
+		const unsigned int treeNodeIds[2] = { Dawg::FORWARD_WORD_NODE_ID, Dawg::REVERSE_PARTWORD_NODE_ID };
+
+		memset(this->directIndexes, 0, sizeof(this->directIndexes));
+		for (unsigned int treeIdx = 0; treeIdx < 2; treeIdx++)
+		{
+			DirectIndex& directIndex = this->directIndexes[treeIdx];
+			unsigned int firstNodeId = GetNode(treeNodeIds[treeIdx]).childNodeId;
+			for (; firstNodeId != 0; firstNodeId++)
+			{
+				if (firstNodeId >= this->header.numNodes)
+					throw(std::runtime_error("Node id is out of range! Bug or file corruption?"));
+
+				// letters outside the lexicon range are left to scanning
+				DawgNode firstNode = GetNode(firstNodeId);
+				unsigned int firstLetterIdx = (unsigned int)(firstNode.letter - Dawg::START_LETTER);
+				if (firstLetterIdx < Dawg::NUM_LETTERS)
+				{
+					directIndex.firstNodeIds[firstLetterIdx] = firstNodeId;
+					for (unsigned int secondNodeId = firstNode.childNodeId; secondNodeId != 0; secondNodeId++)
+					{
+						if (secondNodeId >= this->header.numNodes)
+							throw(std::runtime_error("Node id is out of range! Bug or file corruption?"));
+
+						DawgNode secondNode = GetNode(secondNodeId);
+						unsigned int secondLetterIdx = (unsigned int)(secondNode.letter - Dawg::START_LETTER);
+						if (secondLetterIdx < Dawg::NUM_LETTERS)
+							directIndex.secondNodeIds[firstLetterIdx][secondLetterIdx] = secondNodeId;
+
+						if (secondNode.isLastChild == TRUE)
+							break;
+					}
+				}
+
+				if (firstNode.isLastChild == TRUE)
+					break;
+			}
+		}
+	}
+
 	// CLEAN UP
 	void Dawg::Cleanup()
 	{
-		if (this->pNodes != NULL)
-		{
+		if (this->mappedFile.IsOpen())
+			this->mappedFile.Close();	// nodes are part of the mapped file
+		else if (this->pNodes != NULL)
 			delete[] this->pNodes;
-			this->pNodes = NULL;
-		}
+
+		this->pNodes = NULL;
+		this->packedNodes.Clear();
 		this->numReversePartWords = 0;
+		this->pNumReversePartWordsOnce.reset(new once_flag());
+
+		if (!this->isChildIndexMapped)
+			delete[] this->pChildIndex;	// (mapped child masks are part of the mapped file)
+		this->pChildIndex = NULL;
+		this->isChildIndexMapped = false;
+		memset(this->directIndexes, 0, sizeof(this->directIndexes));
 
 		// header
 		memset(this->header.date, '\0', Dawg::HEADER_DATE_LENGTH);
@@ -121,6 +601,58 @@ namespace LxpStd
 		this->header.size = 0;
 	}
 
+	// COMPILE PATTERN
+	void Dawg::CompilePattern(const string& pattern, CompiledPattern& compiledPattern)
+	{
+		memset(&compiledPattern, 0, sizeof(compiledPattern));
+
+		unsigned int numTokens = 0;
+		for (unsigned int idx = 0; idx < pattern.length(); idx++, numTokens++)
+		{
+			if (numTokens >= Dawg::MAX_PATTERN_TOKENS)
+				throw(std::runtime_error("Pattern is too long!"));
+
+			unsigned long long tokenState = 1ULL << numTokens;
+			char patternChar = (char)toupper((unsigned char)pattern[idx]);
+
+			if (patternChar == Dawg::MULTI_CHAR_MATCH_SYMBOL)
+			{
+				compiledPattern.multiCharStates |= tokenState;
+			}
+			else if (patternChar == Dawg::WILDCARD_CHAR)
+			{
+				for (char letter = Dawg::START_LETTER; letter <= Dawg::END_LETTER; letter++)
+					compiledPattern.advanceStates[letter - Dawg::START_LETTER] |= tokenState;
+			}
+			else if (patternChar == Dawg::NOT_MATCH_SYMBOL)
+			{
+				// need the letter that must not match
+				if (++idx == pattern.length())
+					throw(std::runtime_error("Pattern must not end with NOT_MATCH_SYMBOL!"));
+
+				char notLetter = (char)toupper((unsigned char)pattern[idx]);
+				if (notLetter < Dawg::START_LETTER || notLetter > Dawg::END_LETTER)
+					throw(std::runtime_error("NOT_MATCH_SYMBOL must be followed by a letter!"));
+
+				for (char letter = Dawg::START_LETTER; letter <= Dawg::END_LETTER; letter++)
+				{
+					if (letter != notLetter)
+						compiledPattern.advanceStates[letter - Dawg::START_LETTER] |= tokenState;
+				}
+			}
+			else if (patternChar >= Dawg::START_LETTER && patternChar <= Dawg::END_LETTER)
+			{
+				compiledPattern.advanceStates[patternChar - Dawg::START_LETTER] |= tokenState;
+			}
+			else
+			{
+				throw(std::runtime_error("Invalid character in pattern!"));
+			}
+		}
+
+		compiledPattern.matchState = 1ULL << numTokens;
+	}
+
 	// COUNT NUM REVERSE PART WORDS
 	unsigned int Dawg::CountNumReversePartWords() const
 	{
@@ -130,30 +662,269 @@ namespace LxpStd
 	// COUNT NUM WORDS
 	unsigned int Dawg::CountNumWords() const
 	{
-		return CountNumWordFragmentsForTree(Dawg::FORWARD_WORD_NODE_ID);
+		// forward word node is not the last child, start at its child to avoid
+		// counting the reverse part words as well
+		return CountNumWordFragmentsForTree(GetNode(Dawg::FORWARD_WORD_NODE_ID).childNodeId);
 	}
 
-	// COUNT NUM TERMINALS FOR TREE
+	// COUNT NUM WORD FRAGMENTS FOR TREE
+	// the terminal nodes along every path (the words or part words)
 	unsigned int Dawg::CountNumWordFragmentsForTree(unsigned int nodeId) const
 	{
 		unsigned int numWordFragments = 0;
 
+		// the node, the tree of its first child and then the tree of its next sibling
+		TreeWalkStack<unsigned int> nextSiblingIds;	// to go on with, one per level
+		nextSiblingIds.Push(nodeId);
+		while (!nextSiblingIds.IsEmpty())
+		{
+			for (nodeId = nextSiblingIds.Pop(); nodeId != 0 && nodeId < this->header.numNodes; nodeId = GetNode(nodeId).childNodeId)
+			{
+				DawgNode node = GetNode(nodeId);
+
+				// is the current node terminal?
+				if (node.isTerminal == TRUE)
+					numWordFragments++;
+
+				// the next sibling tree (if this is not the last child) after the first child tree
+				if (node.isLastChild != TRUE)
+					nextSiblingIds.Push(nodeId + 1);
+			}
+		}
+
+		return numWordFragments;
+	}
+
+	// DECODE NODES
+	// nodes in the file layout (pData) into memory, or into the packed nodes
+	void Dawg::DecodeNodes(const char* pData, bool isV1, bool isPacked)
+	{
+		if (isPacked)
+		{
+			this->packedNodes.Initialize(this->header.numNodes);
+			for (unsigned int idx = 0; idx < this->header.numNodes; idx++)
+			{
+				DawgNode node;
+				if (isV1)
+					DawgFile::ReadV1Node(pData + (size_t)idx * DawgFile::V1_NODE_SIZE, node);
+				else
+					DawgFile::ReadNode(pData + (size_t)idx * DawgFile::NODE_SIZE, node);
+				this->packedNodes.SetNode(idx, node);
+			}
+
+			return;
+		}
+
+		DawgNode* pDecodedNodes = new DawgNode[this->header.numNodes];
+		for (unsigned int idx = 0; idx < this->header.numNodes; idx++)
+		{
+			if (isV1)
+				DawgFile::ReadV1Node(pData + (size_t)idx * DawgFile::V1_NODE_SIZE, pDecodedNodes[idx]);
+			else
+				DawgFile::ReadNode(pData + (size_t)idx * DawgFile::NODE_SIZE, pDecodedNodes[idx]);
+		}
+
+		this->pNodes = pDecodedNodes;
+	}
+
+	// FIND ANAGRAMS
+	unsigned int Dawg::FindAnagrams(const string& rack, bool isSubAnagram, const WordCallback& callback) const
+	{
+		assert(IsLoaded());
+
+		if (rack.length() > Dawg::MAX_WORD_LENGTH)
+			throw(std::runtime_error("Rack is longer than the maximum word length!"));
+
+		// count the tiles
+		Rack rackTiles;
+		memset(&rackTiles, 0, sizeof(rackTiles));
+		for (unsigned int idx = 0; idx < rack.length(); idx++)
+		{
+			char tile = (char)toupper((unsigned char)rack[idx]);
+			if (tile == Dawg::WILDCARD_CHAR)
+				rackTiles.numBlanks++;
+			else if (tile >= Dawg::START_LETTER && tile <= Dawg::END_LETTER)
+				rackTiles.letterCounts[tile - Dawg::START_LETTER]++;
+			else
+				throw(std::runtime_error("Invalid tile in rack!"));
+		}
+
+		rackTiles.numTiles = rack.length();
+
+		ScratchMemory scratchMemory;
+		WordBuffer word;
+		Dawg::InitializeWordBuffer(word, scratchMemory, rack.length());
+		return AnagramTree(GetNode(Dawg::FORWARD_WORD_NODE_ID).childNodeId, rackTiles, isSubAnagram, word, callback);
+	}
+
+	// FIND CHILD NODE
+	unsigned int Dawg::FindChildNode(unsigned int parentNodeId, char letter) const
+	{
+		// jump to the child directly
+		if (this->pChildIndex != NULL)
+		{
+			unsigned int letterIdx = (unsigned int)(letter - Dawg::START_LETTER);
+			if (letterIdx > (unsigned int)(Dawg::END_LETTER - Dawg::START_LETTER))
+				return 0;
+
+			const ChildIndex& childIndex = this->pChildIndex[parentNodeId];
+			unsigned int letterBit = 1U << letterIdx;
+			if ((childIndex.childMask & letterBit) == 0)
+				return 0;
+
+			return childIndex.childNodeId + PopCount(childIndex.childMask & (letterBit - 1));
+		}
+
+		// scan the sibling list
+		unsigned int nodeId = GetNode(parentNodeId).childNodeId;
+		if (nodeId == 0)
+			return 0;
+
+		while (GetNode(nodeId).letter != letter)
+		{
+			if (GetNode(nodeId++).isLastChild == TRUE)
+				return 0;
+		}
+
+		return nodeId;
+	}
+
+	// FIND FRAGMENT NODE
+	// *** To be called for first child only ***
+	unsigned int Dawg::FindFragmentNode(const char* pWordFragment, unsigned int length, unsigned int nodeId) const
+	{
+		// we can't match empty string
+		if (length == 0)
+			return 0;
+
+		for (unsigned int matchedLength = 0; matchedLength < length; matchedLength++)
+		{
+			// no more letters to match?
+			if (nodeId == 0)
+				return 0;
+
+			// find the letter in the sibling list
+			char letterToMatch = pWordFragment[matchedLength];
+			while (GetNode(nodeId).letter != letterToMatch)
+			{
+				if (GetNode(nodeId++).isLastChild == TRUE)
+					return 0;	// letter not found
+			}
+
+			// last letter is the node we are looking for
+			if (matchedLength == length - 1)
+				return nodeId;
+
+			nodeId = GetNode(nodeId).childNodeId;
+		}
+
+		return 0;
+	}
+
+	// FIND WORDS IN TREE
+	// *** To be called for first child only ***
+	// all the words in the tree (word contains the letters leading to the tree)
+	unsigned int Dawg::FindWordsInTree(unsigned int nodeId, WordBuffer& word, const WordCallback& callback) const
+	{
+		unsigned int numWords = 0;
+
 		// recursion stop condition
-		if (nodeId == 0 || nodeId >= this->header.numNodes)
-			return numWordFragments;
+		if (nodeId == 0)
+			return numWords;
+
+		do
+		{
+			const DawgNode node = GetNode(nodeId);
+			Dawg::PushLetter(word, (char)node.letter);
+
+			if (node.isTerminal == TRUE)
+			{
+				callback(word.pLetters);
+				numWords++;
+			}
+
+			numWords += FindWordsInTree(node.childNodeId, word, callback);
+			Dawg::PopLetter(word);
+		} while (GetNode(nodeId++).isLastChild != TRUE);
+
+		return numWords;
+	}
+
+	// GET BACK HOOKS
+	void Dawg::GetBackHooks(const string& fragment, string& hooks) const
+	{
+		assert(IsLoaded());
+		hooks.clear();
 
-		// is the current node terminal?
-		if (this->pNodes[nodeId].isTerminal == TRUE)
-			numWordFragments++;
+		// (upper cased, as all the queries do)
+		ScratchMemory scratchMemory;
+		WordBuffer upperFragment;
+		Dawg::InitializeWordBuffer(upperFragment, scratchMemory, fragment.length());
+		for (unsigned int idx = 0; idx < fragment.length(); idx++)
+			Dawg::PushLetter(upperFragment, (char)toupper((unsigned char)fragment[idx]));
 
-		// traverse the first child tree
-		numWordFragments += CountNumWordFragmentsForTree(this->pNodes[nodeId].childNodeId);
+		// terminal children of the fragment are the back hooks
+		unsigned int nodeId = FindFragmentNode(upperFragment.pLetters, upperFragment.length, GetNode(Dawg::FORWARD_WORD_NODE_ID).childNodeId);
+		if (nodeId == 0)
+			return;
 
-		// traverse the next sibling tree (if this is not the last child)
-		if (this->pNodes[nodeId].isLastChild != TRUE)
-			numWordFragments += CountNumWordFragmentsForTree(nodeId + 1);
+		nodeId = GetNode(nodeId).childNodeId;
+		if (nodeId == 0)
+			return;
 
-		return numWordFragments;
+		do
+		{
+			if (GetNode(nodeId).isTerminal == TRUE)
+				hooks.push_back((char)GetNode(nodeId).letter);
+		} while (GetNode(nodeId++).isLastChild != TRUE);
+	}
+
+	// GET FRONT HOOKS
+	// Children of the reversed fragment (in reverse part words) are the letters that can
+	// precede the fragment. If the child is terminal, the letter and fragment are the start
+	// of a word, which needs to be checked for being a word by itself.
+	void Dawg::GetFrontHooks(const string& fragment, string& hooks) const
+	{
+		assert(IsLoaded());
+		hooks.clear();
+
+		ScratchMemory scratchMemory;
+		WordBuffer reversedFragment;
+		Dawg::InitializeWordBuffer(reversedFragment, scratchMemory, fragment.length());
+		for (unsigned int idx = fragment.length(); idx > 0; idx--)
+			Dawg::PushLetter(reversedFragment, (char)toupper((unsigned char)fragment[idx - 1]));
+
+		unsigned int nodeId = FindFragmentNode(reversedFragment.pLetters, reversedFragment.length,
+											   GetNode(Dawg::REVERSE_PARTWORD_NODE_ID).childNodeId);
+		if (nodeId == 0)
+			return;
+
+		nodeId = GetNode(nodeId).childNodeId;
+		if (nodeId == 0)
+			return;
+
+		// the hook is the first letter of the word
+		WordBuffer word;
+		Dawg::InitializeWordBuffer(word, scratchMemory, fragment.length() + 1);
+		Dawg::PushLetter(word, Dawg::DEFAULT_LETTER);
+		for (unsigned int idx = 0; idx < fragment.length(); idx++)
+			Dawg::PushLetter(word, (char)toupper((unsigned char)fragment[idx]));
+
+		do
+		{
+			if (GetNode(nodeId).isTerminal == TRUE)
+			{
+				word.pLetters[0] = (char)GetNode(nodeId).letter;
+				if (IsWord(word.pLetters, word.length))
+					hooks.push_back(word.pLetters[0]);
+			}
+		} while (GetNode(nodeId++).isLastChild != TRUE);
+	}
+
+	// GET FILE FORMAT
+	DawgFileFormat Dawg::GetFileFormat() const
+	{
+		return this->fileFormat;
 	}
 
 	// GET HEADER
@@ -162,102 +933,669 @@ namespace LxpStd
 		header = this->header;
 	}
 
+	// GET NODES SIZE
+	size_t Dawg::GetNodesSize() const
+	{
+		if (this->pNodes == NULL)
+			return this->packedNodes.GetSize();
+
+		return (size_t)this->header.numNodes * sizeof(DawgNode);
+	}
+
+	// GET PATTERN CLOSURE
+	// MULTI_CHAR_MATCH_SYMBOL can match zero letters, i.e. the next token can be
+	// matched without consuming a letter
+	unsigned long long Dawg::GetPatternClosure(const CompiledPattern& compiledPattern, unsigned long long state)
+	{
+		unsigned long long closure = state | ((state & compiledPattern.multiCharStates) << 1);
+		while (closure != state)
+		{
+			state = closure;
+			closure = state | ((state & compiledPattern.multiCharStates) << 1);
+		}
+
+		return closure;
+	}
+
+	// GROW WORD BUFFER
+	// (only for words longer than MAX_WORD_LENGTH) the old letters stay in the scratch memory
+	void Dawg::GrowWordBuffer(WordBuffer& word)
+	{
+		char* pLetters = word.pScratchMemory->Allocate<char>(word.capacity * 2 + 1);
+		memcpy(pLetters, word.pLetters, word.length + 1);
+		word.pLetters = pLetters;
+		word.capacity *= 2;
+	}
+
 	// INITIALIZE
-	void Dawg::Initialize(const string& fileName) throw(...)
+	void Dawg::Initialize(const string& fileName, LoadMode loadMode, bool isChildMasks)
 	{
 		// clean up first
 		Cleanup();
 
-		// open the file and read header
-		ifstream dawgStream;
-		dawgStream.open(fileName, ifstream::in | ifstream::binary);
+		try
+		{
+			if (loadMode == LoadMode::MEMORY_MAPPED)
+			{
+				this->mappedFile.Open(fileName);
+				LoadMappedFile(isChildMasks);
+			}
+			else
+				LoadFile(fileName, loadMode == LoadMode::PACKED, isChildMasks);
+		}
+		catch (...)
+		{
+			Cleanup();
+			throw;
+		}
 
-		// find the length of file
-		dawgStream.seekg(0, dawgStream.end);
-		unsigned int fileLength = dawgStream.tellg();
-		dawgStream.seekg(0, dawgStream.beg);
-		if (fileLength < sizeof DawgHeader)
-			throw(std::exception("File length is smaller than Header information! Bug or file corruption?"));
+		// validate the header and the number of nodes match the minimum
+		if (this->fileFormat == DawgFileFormat::V1 && this->header.size != sizeof(DawgHeader))
+		{
+			Cleanup();
+			throw(std::runtime_error("Header size does not match! Bug or file corruption?"));
+		}
 
-		// read header and allocate memory for reading nodes
-		dawgStream.read((char*)(&(this->header)), sizeof(this->header));
-		unsigned int expectedFileLength = sizeof DawgHeader + (sizeof DawgNode * this->header.numNodes);
-		if (fileLength < expectedFileLength)
-			throw(std::exception("File length is smaller than expected! Bug or file corruption?"));
+		if (this->header.numNodes < Dawg::MINIMUM_NUMBER_OF_NODES)
+		{
+			Cleanup();
+			throw(std::runtime_error("Number of nodes in Dawg does not match the minimum! Bug or file corruption?"));
+		}
 
-		this->pNodes = new DawgNode[this->header.numNodes];
+		// the header is trusted when memory mapped (counting needs a full traversal)
+		if (loadMode != LoadMode::MEMORY_MAPPED)
+		{
+			// count words and reverse part words
+			unsigned int numWords = CountNumWords();
+			NumReversePartWords();
 
-		// read nodes and close the stream
-		dawgStream.read((char*)(this->pNodes), sizeof(DawgNode) * this->header.numNodes);
-		dawgStream.close();
+			// validate that the number of words match
+			if (numWords != this->header.numWords)
+			{
+				Cleanup();
+				throw(std::runtime_error("Number of words in Dawg does not match what is in the header! Bug or file corruption?"));
+			}
+		}
 
-		// count words and reverse part words
-		unsigned int numWords = CountNumWords();
-		this->numReversePartWords = CountNumReversePartWords();
+		try
+		{
+			BuildDirectIndexes();
+			if (isChildMasks && this->pChildIndex == NULL)
+				BuildChildMasks();
+		}
+		catch (...)
+		{
+			Cleanup();
+			throw;
+		}
+	}
 
-		// validate that the number of words match
-		assert(numWords == this->header.numWords);
-		if (numWords != this->header.numWords)
-			throw(std::exception("Number of words in Dawg does not match what is in the header! Bug or file corruption?"));
+	// INITIALIZE WORD BUFFER
+	// empty, with room for capacity letters (at least MAX_WORD_LENGTH)
+	void Dawg::InitializeWordBuffer(WordBuffer& word, ScratchMemory& scratchMemory, unsigned int capacity)
+	{
+		if (capacity < (unsigned int)Dawg::MAX_WORD_LENGTH)
+			capacity = Dawg::MAX_WORD_LENGTH;
 
-		// validate the number of nodes match the minimum
-		if (this->header.numNodes < Dawg::MINIMUM_NUMBER_OF_NODES)
-			throw(std::exception("Number of nodes in Dawg does not match the minimum! Bug or file corruption?"));
+		word.pLetters = scratchMemory.Allocate<char>(capacity + 1);
+		word.pLetters[0] = '\0';
+		word.length = 0;
+		word.capacity = capacity;
+		word.pScratchMemory = &scratchMemory;
 	}
 
 	// IS REVERSE PART WORD
 	bool Dawg::IsReversePartWord(const string& reversePartWord) const
 	{
-		assert(this->pNodes != NULL);
-		return IsWordFragment(reversePartWord, this->pNodes[Dawg::REVERSE_PARTWORD_NODE_ID].childNodeId, 0);
+		return IsReversePartWord(reversePartWord.c_str(), reversePartWord.length());
+	}
+
+	// IS REVERSE PART WORD
+	bool Dawg::IsReversePartWord(const char* pReversePartWord, unsigned int length) const
+	{
+		assert(IsLoaded());
+		return IsWordFragment(pReversePartWord, length, Dawg::REVERSE_PARTWORD_NODE_ID);
+	}
+
+	// IS TERMINAL NODE
+	bool Dawg::IsTerminalNode(unsigned int nodeId) const
+	{
+		if (this->pChildIndex != NULL)
+			return (this->pChildIndex[nodeId].childMask & Dawg::TERMINAL_NODE_BIT) != 0;
+
+		return GetNode(nodeId).isTerminal == TRUE;
 	}
 
 	// IS WORD
 	bool Dawg::IsWord(const string& word) const
 	{
-		assert(this->pNodes != NULL);
-		return IsWordFragment(word, this->pNodes[Dawg::FORWARD_WORD_NODE_ID].childNodeId, 0);
+		return IsWord(word.c_str(), word.length());
+	}
+
+	// IS WORD
+	bool Dawg::IsWord(const char* pWord, unsigned int length) const
+	{
+		assert(IsLoaded());
+		return IsWordFragment(pWord, length, Dawg::FORWARD_WORD_NODE_ID);
 	}
 
 	// IS WORD FRAGMENT
-	bool Dawg::IsWordFragment(const string& wordFragment, unsigned int nodeId, unsigned int matchedLength) const
+	bool Dawg::IsWordFragment(const char* pWordFragment, unsigned int length, unsigned int parentNodeId) const
 	{
-		// length check for edge cases (length = 0)
-		if (wordFragment.length() == 0)
-			return false;	// we can't match empty string
+		// we can't match empty string
+		if (length == 0)
+			return false;
+
+		// the first letters without scanning
+		unsigned int nodeId = parentNodeId;
+		unsigned int matchedLength = MatchDirectIndex(pWordFragment, length, parentNodeId, nodeId);
+		if (nodeId == 0)
+			return false;
+
+		for (; matchedLength < length; matchedLength++)
+		{
+			nodeId = FindChildNode(nodeId, pWordFragment[matchedLength]);
+			if (nodeId == 0)
+				return false;	// letter not found
+		}
+
+		return IsTerminalNode(nodeId);
+	}
+
+	// LOAD FILE
+	// reads the header and the nodes (of either version) into memory, packed or not, and the
+	// child masks if asked for and in the file
+	void Dawg::LoadFile(const string& fileName, bool isPacked, bool isChildMasks)
+	{
+		// open the file
+		ifstream dawgStream;
+		dawgStream.open(fileName, ifstream::in | ifstream::binary);
+		if (!dawgStream.is_open())
+			throw(std::runtime_error("Unable to open Dawg file!"));
+
+		// find the length of file
+		dawgStream.seekg(0, dawgStream.end);
+		unsigned long long fileLength = (unsigned long long)dawgStream.tellg();
+		dawgStream.seekg(0, dawgStream.beg);
+		if (fileLength < sizeof(DawgHeader))
+			throw(std::runtime_error("File length is smaller than Header information! Bug or file corruption?"));
 
-		// safety check!
-		assert(matchedLength < wordFragment.length());
+		vector<char> headerData(DawgFile::HEADER_SIZE, '\0');
+		dawgStream.read(&headerData[0], min((unsigned long long)DawgFile::HEADER_SIZE, fileLength));
+		if (!DawgFile::IsVersion2(&headerData[0], headerData.size()))
+		{
+			// V1: the header and the nodes as they were in memory
+			this->fileFormat = DawgFileFormat::V1;
+			memcpy(&(this->header), &headerData[0], sizeof(this->header));
+			unsigned long long expectedFileLength = sizeof(DawgHeader) + (unsigned long long)DawgFile::V1_NODE_SIZE * this->header.numNodes;
+			if (fileLength < expectedFileLength)
+				throw(std::runtime_error("File length is smaller than expected! Bug or file corruption?"));
+
+			vector<char> nodesData((size_t)(expectedFileLength - sizeof(DawgHeader)));
+			dawgStream.clear();		// (a V1 file can be shorter than a V2 header)
+			dawgStream.seekg(sizeof(DawgHeader));
+			dawgStream.read(nodesData.data(), nodesData.size());
+			DecodeNodes(nodesData.data(), true, isPacked);
+			return;
+		}
+
+		// V2: the section table follows the header
+		DawgFileHeader fileHeader;
+		DawgFile::ReadHeader(&headerData[0], fileHeader);
+		unsigned long long tableEnd = (unsigned long long)fileHeader.headerSize + (unsigned long long)fileHeader.numSections * DawgFile::SECTION_ENTRY_SIZE;
+		if (fileHeader.headerSize < DawgFile::HEADER_SIZE || tableEnd > fileLength)
+			throw(std::runtime_error("File length is smaller than expected! Bug or file corruption?"));
+
+		headerData.resize((size_t)tableEnd);
+		dawgStream.seekg(DawgFile::HEADER_SIZE);
+		dawgStream.read(&headerData[DawgFile::HEADER_SIZE], headerData.size() - DawgFile::HEADER_SIZE);
+
+		DawgFileSection nodesSection;
+		DawgFileSection childMasksSection;
+		LoadV2Header(&headerData[0], fileLength, nodesSection, childMasksSection);
+
+		// everything is read in order for the checksum (with the checksum field as zero)
+		memset(&headerData[DawgFile::HEADER_CHECKSUM_OFFSET], 0, sizeof(fileHeader.checksum));
+		unsigned int crc = DawgFile::Crc32(0, &headerData[0], headerData.size());
+
+		vector<char> skipData((size_t)(nodesSection.offset - tableEnd));
+		ReadChecksummed(dawgStream, skipData.data(), skipData.size(), crc);
+
+		if (isPacked)
+		{
+			// a chunk at a time, so all the nodes are never in memory unpacked
+			const unsigned int NODES_PER_CHUNK = 8192;
+			vector<char> nodesData((size_t)NODES_PER_CHUNK * DawgFile::NODE_SIZE);
+			this->packedNodes.Initialize(this->header.numNodes);
+			for (unsigned int chunkStart = 0; chunkStart < this->header.numNodes; chunkStart += NODES_PER_CHUNK)
+			{
+				unsigned int numChunkNodes = min(NODES_PER_CHUNK, this->header.numNodes - chunkStart);
+				ReadChecksummed(dawgStream, nodesData.data(), (size_t)numChunkNodes * DawgFile::NODE_SIZE, crc);
+				for (unsigned int idx = 0; idx < numChunkNodes; idx++)
+				{
+					DawgNode node;
+					DawgFile::ReadNode(&nodesData[(size_t)idx * DawgFile::NODE_SIZE], node);
+					this->packedNodes.SetNode(chunkStart + idx, node);
+				}
+			}
+		}
+		else
+		{
+			DawgNode* pReadNodes = new DawgNode[this->header.numNodes];
+			this->pNodes = pReadNodes;
+			ReadChecksummed(dawgStream, (char*)pReadNodes, (size_t)nodesSection.size, crc);
+			if (!DawgFile::IsLittleEndianMachine())
+			{
+				for (unsigned int idx = 0; idx < this->header.numNodes; idx++)
+				{
+					char nodeData[DawgFile::NODE_SIZE];
+					memcpy(nodeData, &pReadNodes[idx], DawgFile::NODE_SIZE);
+					DawgFile::ReadNode(nodeData, pReadNodes[idx]);
+				}
+			}
+		}
+
+		// the child masks (which follow the nodes)
+		unsigned long long sectionsEnd = nodesSection.offset + nodesSection.size;
+		if (isChildMasks && childMasksSection.size != 0)
+		{
+			skipData.resize((size_t)(childMasksSection.offset - sectionsEnd));
+			ReadChecksummed(dawgStream, skipData.data(), skipData.size(), crc);
+
+			ChildIndex* pIndex = new ChildIndex[this->header.numNodes];
+			this->pChildIndex = pIndex;
+			ReadChecksummed(dawgStream, (char*)pIndex, (size_t)childMasksSection.size, crc);
+			if (!DawgFile::IsLittleEndianMachine())
+			{
+				for (unsigned int idx = 0; idx < this->header.numNodes; idx++)
+				{
+					char childMaskData[DawgFile::CHILD_MASK_SIZE];
+					memcpy(childMaskData, &pIndex[idx], DawgFile::CHILD_MASK_SIZE);
+					DawgFile::ReadChildMask(childMaskData, pIndex[idx].childMask, pIndex[idx].childNodeId);
+				}
+			}
+			sectionsEnd = childMasksSection.offset + childMasksSection.size;
+		}
+
+		// the other sections (not used)
+		const unsigned long long CHUNK_SIZE = 64 * 1024;
+		skipData.resize((size_t)CHUNK_SIZE);
+		for (unsigned long long offset = sectionsEnd; offset < fileLength; offset += CHUNK_SIZE)
+			ReadChecksummed(dawgStream, skipData.data(), (size_t)min(CHUNK_SIZE, fileLength - offset), crc);
+
+		if (crc != fileHeader.checksum)
+			throw(std::runtime_error("Dawg file checksum does not match! Bug or file corruption?"));
+	}
+
+	// LOAD MAPPED FILE
+	// nodes (and child masks if asked for) are used in place if they are in the memory layout,
+	// converted into memory otherwise (the child masks are built then)
+	void Dawg::LoadMappedFile(bool isChildMasks)
+	{
+		const char* pData = this->mappedFile.Data();
+		unsigned long long fileLength = this->mappedFile.Length();
+		if (fileLength < sizeof(DawgHeader))
+			throw(std::runtime_error("File length is smaller than Header information! Bug or file corruption?"));
+
+		if (!DawgFile::IsVersion2(pData, (size_t)fileLength))
+		{
+			this->fileFormat = DawgFileFormat::V1;
+			memcpy(&(this->header), pData, sizeof(this->header));
+			if (fileLength < sizeof(DawgHeader) + (unsigned long long)DawgFile::V1_NODE_SIZE * this->header.numNodes)
+				throw(std::runtime_error("File length is smaller than expected! Bug or file corruption?"));
+
+			DecodeNodes(pData + sizeof(DawgHeader), true, false);
+			this->mappedFile.Close();
+			return;
+		}
+
+		DawgFileHeader fileHeader;
+		if (fileLength < DawgFile::HEADER_SIZE)
+			throw(std::runtime_error("File length is smaller than Header information! Bug or file corruption?"));
+		DawgFile::ReadHeader(pData, fileHeader);
+		if (fileHeader.headerSize < DawgFile::HEADER_SIZE ||
+			(unsigned long long)fileHeader.headerSize + (unsigned long long)fileHeader.numSections * DawgFile::SECTION_ENTRY_SIZE > fileLength)
+		{
+			throw(std::runtime_error("File length is smaller than expected! Bug or file corruption?"));
+		}
+
+		DawgFileSection nodesSection;
+		DawgFileSection childMasksSection;
+		LoadV2Header(pData, fileLength, nodesSection, childMasksSection);
+		if (DawgFile::IsLittleEndianMachine())
+		{
+			this->pNodes = (const DawgNode*)(pData + nodesSection.offset);
+			if (isChildMasks && childMasksSection.size != 0)
+			{
+				this->pChildIndex = (const ChildIndex*)(pData + childMasksSection.offset);
+				this->isChildIndexMapped = true;
+			}
+		}
+		else
+		{
+			DecodeNodes(pData + nodesSection.offset, false, false);
+			this->mappedFile.Close();
+		}
+	}
+
+	// LOAD V2 HEADER
+	// pData has the header and the section table (lengths checked), finds the nodes and
+	// child masks sections
+	void Dawg::LoadV2Header(const char* pData, unsigned long long fileLength, DawgFileSection& nodesSection,
+							DawgFileSection& childMasksSection)
+	{
+		DawgFileHeader fileHeader;
+		DawgFile::ReadHeader(pData, fileHeader);
+		if (fileHeader.version != DawgFile::VERSION)
+			throw(std::runtime_error("Dawg file version is not supported!"));
+
+		// (checked on every load, as a memory mapped file is used without reading the rest)
+		size_t tableEnd = (size_t)fileHeader.headerSize + (size_t)fileHeader.numSections * DawgFile::SECTION_ENTRY_SIZE;
+		if (DawgFile::HeaderChecksum(pData, tableEnd) != fileHeader.headerChecksum)
+			throw(std::runtime_error("Dawg file header checksum does not match! Bug or file corruption?"));
+
+		this->fileFormat = DawgFileFormat::V2;
+		this->header.size = fileHeader.headerSize;
+		this->header.numNodes = fileHeader.numNodes;
+		this->header.numWords = fileHeader.numWords;
+		memcpy(this->header.lexiconName, fileHeader.lexiconName, sizeof(this->header.lexiconName));
+
+		// the date as V1 files have it
+		struct tm creationTime;
+		memset(&creationTime, 0, sizeof(creationTime));
+		creationTime.tm_year = fileHeader.creationDate / 10000 - 1900;
+		creationTime.tm_mon = fileHeader.creationDate / 100 % 100 - 1;
+		creationTime.tm_mday = fileHeader.creationDate % 100;
+		strftime(this->header.date, Dawg::HEADER_DATE_LENGTH, "%d %B %Y", &creationTime);
+
+		// find the nodes and the child masks (other sections are skipped)
+		bool isNodesSectionFound = false;
+		childMasksSection.type = DawgFile::CHILD_MASKS_SECTION;
+		childMasksSection.offset = 0;
+		childMasksSection.size = 0;
+		for (unsigned int idx = 0; idx < fileHeader.numSections; idx++)
+		{
+			DawgFileSection section;
+			DawgFile::ReadSection(pData + fileHeader.headerSize + idx * DawgFile::SECTION_ENTRY_SIZE, section);
+			if (section.offset > fileLength || section.size > fileLength - section.offset)
+				throw(std::runtime_error("File length is smaller than expected! Bug or file corruption?"));
+
+			if (section.type == DawgFile::NODES_SECTION)
+			{
+				nodesSection = section;
+				isNodesSectionFound = true;
+			}
+			else if (section.type == DawgFile::CHILD_MASKS_SECTION)
+				childMasksSection = section;
+		}
+
+		if (!isNodesSectionFound || nodesSection.size != (unsigned long long)DawgFile::NODE_SIZE * this->header.numNodes ||
+			nodesSection.offset % DawgFile::SECTION_ALIGNMENT != 0 ||
+			nodesSection.offset < (unsigned long long)fileHeader.headerSize + (unsigned long long)fileHeader.numSections * DawgFile::SECTION_ENTRY_SIZE)
+		{
+			throw(std::runtime_error("Nodes section does not match! Bug or file corruption?"));
+		}
+
+		if (childMasksSection.size != 0 &&
+			(childMasksSection.size != (unsigned long long)DawgFile::CHILD_MASK_SIZE * this->header.numNodes ||
+			 childMasksSection.offset % DawgFile::SECTION_ALIGNMENT != 0 || childMasksSection.offset < nodesSection.offset + nodesSection.size))
+		{
+			throw(std::runtime_error("Child masks section does not match! Bug or file corruption?"));
+		}
+	}
+
+	// MATCH
+	unsigned int Dawg::Match(const string& pattern, const WordCallback& callback) const
+	{
+		assert(IsLoaded());
+
+		// we can't match empty string
+		if (pattern.length() == 0)
+			return 0;
+
+		CompiledPattern compiledPattern;
+		Dawg::CompilePattern(pattern, compiledPattern);
+
+		ScratchMemory scratchMemory;
+		WordBuffer word;
+		Dawg::InitializeWordBuffer(word, scratchMemory, Dawg::MAX_WORD_LENGTH);
+		return MatchTree(compiledPattern, GetNode(Dawg::FORWARD_WORD_NODE_ID).childNodeId,
+						 Dawg::GetPatternClosure(compiledPattern, 1ULL), word, callback);
+	}
+
+	// MATCH DIRECT INDEX
+	// Finds the node of the first one or two letters (up to length) of a word or a reverse part
+	// word, 0 if not found, and returns the number of letters matched. Nothing is matched (and
+	// nodeId is left alone) if a letter is outside the lexicon range, the lists are scanned then.
+	unsigned int Dawg::MatchDirectIndex(const char* pWordFragment, unsigned int length, unsigned int parentNodeId,
+										unsigned int& nodeId) const
+	{
+		assert(parentNodeId == Dawg::FORWARD_WORD_NODE_ID || parentNodeId == Dawg::REVERSE_PARTWORD_NODE_ID);
+		const DirectIndex& directIndex = this->directIndexes[parentNodeId == Dawg::FORWARD_WORD_NODE_ID ? 0 : 1];
+
+		if (length == 0)
+			return 0;
+
+		unsigned int firstLetterIdx = (unsigned int)(pWordFragment[0] - Dawg::START_LETTER);
+		if (firstLetterIdx >= Dawg::NUM_LETTERS)
+			return 0;
+
+		if (length == 1)
+		{
+			nodeId = directIndex.firstNodeIds[firstLetterIdx];
+			return 1;
+		}
+
+		unsigned int secondLetterIdx = (unsigned int)(pWordFragment[1] - Dawg::START_LETTER);
+		if (secondLetterIdx >= Dawg::NUM_LETTERS)
+			return 0;
+
+		nodeId = directIndex.secondNodeIds[firstLetterIdx][secondLetterIdx];
+		return 2;
+	}
+
+	// MATCH TREE
+	// *** To be called for first child only ***
+	// state is the set of pattern tokens matched so far (before the letters of the sibling list)
+	unsigned int Dawg::MatchTree(const CompiledPattern& compiledPattern, unsigned int nodeId, unsigned long long state,
+								 WordBuffer& word, const WordCallback& callback) const
+	{
+		unsigned int numMatches = 0;
+
+		// recursion stop condition
+		if (nodeId == 0)
+			return numMatches;
 
-		// is the letter available in the current node or its sibling
-		char letterToMatch = wordFragment[matchedLength];
 		do
 		{
-			if (this->pNodes[nodeId].letter == letterToMatch)
+			const DawgNode node = GetNode(nodeId);
+
+			// advance the pattern by the letter, no need to go further if nothing matches
+			unsigned long long nextState = ((state & compiledPattern.advanceStates[node.letter - Dawg::START_LETTER]) << 1) |
+											(state & compiledPattern.multiCharStates);
+			if (nextState != 0)
 			{
-				matchedLength++;
+				nextState = Dawg::GetPatternClosure(compiledPattern, nextState);
+				Dawg::PushLetter(word, (char)node.letter);
 
-				// is this the last letter in the wordFragment?
-				if (wordFragment.length() == matchedLength)
+				if (node.isTerminal == TRUE && (nextState & compiledPattern.matchState) != 0)
 				{
-					if (this->pNodes[nodeId].isTerminal == TRUE)
-						return true;
-					else
-						return false;
+					callback(word.pLetters);
+					numMatches++;
 				}
 
-				// not the last letter, need to match child letters
-				return IsWordFragment(wordFragment, this->pNodes[nodeId].childNodeId, matchedLength);
+				numMatches += MatchTree(compiledPattern, node.childNodeId, nextState, word, callback);
+				Dawg::PopLetter(word);
 			}
-		} while (this->pNodes[nodeId].isLastChild != TRUE);
+		} while (GetNode(nodeId++).isLastChild != TRUE);
 
-		// letter not found
-		return false;
+		return numMatches;
 	}
 
 	// NUM REVERSE PART WORDS
+	// (the first call of a memory mapped Dawg counts them, once even if several threads call)
 	unsigned int Dawg::NumReversePartWords() const
 	{
+		if (IsLoaded())
+			call_once(*this->pNumReversePartWordsOnce, [this]() { this->numReversePartWords = CountNumReversePartWords(); });
+
 		return this->numReversePartWords;
 	}
+
+	// POP LETTER
+	void Dawg::PopLetter(WordBuffer& word)
+	{
+		word.pLetters[--word.length] = '\0';
+	}
+
+	// PREFETCH NODE
+	void Dawg::PrefetchNode(unsigned int nodeId) const
+	{
+		if (this->pNodes != NULL)
+			LXP_PREFETCH(&(this->pNodes[nodeId]));
+		else
+			LXP_PREFETCH(this->packedNodes.GetNodeAddress(nodeId));
+	}
+
+	// PUSH LETTER
+	void Dawg::PushLetter(WordBuffer& word, char letter)
+	{
+		if (word.length == word.capacity)
+			Dawg::GrowWordBuffer(word);
+
+		word.pLetters[word.length++] = letter;
+		word.pLetters[word.length] = '\0';
+	}
+
+	// START BATCH LANE
+	// Empty words are skipped (not words). The first letters are matched with the direct index,
+	// leaving at least the last letter to the lane, and words not found there are skipped too.
+	bool Dawg::StartBatchLane(BatchLane& lane, const char* pWords, const unsigned int* pOffsets, unsigned int numWords,
+							  unsigned int& nextWordIdx) const
+	{
+		while (nextWordIdx < numWords)
+		{
+			unsigned int wordIdx = nextWordIdx++;
+			if (pOffsets[wordIdx + 1] > pOffsets[wordIdx])
+			{
+				lane.nodeId = Dawg::FORWARD_WORD_NODE_ID;
+				lane.letterIdx = pOffsets[wordIdx];
+				lane.endLetterIdx = pOffsets[wordIdx + 1];
+				lane.wordIdx = wordIdx;
+
+				unsigned int matchedLength = MatchDirectIndex(&pWords[lane.letterIdx], lane.endLetterIdx - lane.letterIdx - 1,
+															  Dawg::FORWARD_WORD_NODE_ID, lane.nodeId);
+				if (lane.nodeId == 0)
+					continue;
+
+				if (matchedLength != 0)
+				{
+					lane.letterIdx += matchedLength;
+					if (this->pChildIndex != NULL)
+						LXP_PREFETCH(&(this->pChildIndex[lane.nodeId]));
+					else
+						PrefetchNode(GetNode(lane.nodeId).childNodeId);
+				}
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	// READ CHECKSUMMED
+	void Dawg::ReadChecksummed(ifstream& dawgStream, char* pData, size_t length, unsigned int& crc)
+	{
+		dawgStream.read(pData, length);
+		if ((size_t)dawgStream.gcount() != length)
+			throw(std::runtime_error("Unable to read Dawg file!"));
+
+		crc = DawgFile::Crc32(crc, pData, length);
+	}
+
+	// SUB ANAGRAMS
+	unsigned int Dawg::SubAnagrams(const string& rack, const WordCallback& callback) const
+	{
+		return FindAnagrams(rack, true, callback);
+	}
+
+	// WORDS CONTAINING
+	// The reversed fragment is looked up in the reverse part words. Every terminal node
+	// below it (going left in the word) is the start of a word, giving a prefix ending with
+	// the fragment. The words are then the ones in the forward word tree of each prefix.
+	unsigned int Dawg::WordsContaining(const string& fragment, const WordCallback& callback) const
+	{
+		assert(IsLoaded());
+
+		ScratchMemory scratchMemory;
+		WordBuffer reversedPrefix;
+		Dawg::InitializeWordBuffer(reversedPrefix, scratchMemory, fragment.length());
+		for (unsigned int idx = fragment.length(); idx > 0; idx--)
+			Dawg::PushLetter(reversedPrefix, (char)toupper((unsigned char)fragment[idx - 1]));
+
+		unsigned int nodeId = FindFragmentNode(reversedPrefix.pLetters, reversedPrefix.length,
+											   GetNode(Dawg::REVERSE_PARTWORD_NODE_ID).childNodeId);
+		if (nodeId == 0)
+			return 0;
+
+		return WordsContainingTree(nodeId, fragment.length(), reversedPrefix, callback);
+	}
+
+	// WORDS CONTAINING TREE
+	// nodeId is the node of the last letter of reversedPrefix (in reverse part words)
+	unsigned int Dawg::WordsContainingTree(unsigned int nodeId, unsigned int fragmentLength, WordBuffer& reversedPrefix,
+										   const WordCallback& callback) const
+	{
+		unsigned int numWords = 0;
+
+		// reached the start of a word?
+		if (GetNode(nodeId).isTerminal == TRUE)
+			numWords += WordsWithPrefix(reversedPrefix, fragmentLength, callback);
+
+		// continue going left
+		unsigned int childNodeId = GetNode(nodeId).childNodeId;
+		if (childNodeId == 0)
+			return numWords;
+
+		do
+		{
+			Dawg::PushLetter(reversedPrefix, (char)GetNode(childNodeId).letter);
+			numWords += WordsContainingTree(childNodeId, fragmentLength, reversedPrefix, callback);
+			Dawg::PopLetter(reversedPrefix);
+		} while (GetNode(childNodeId++).isLastChild != TRUE);
+
+		return numWords;
+	}
+
+	// WORDS WITH PREFIX
+	// The prefix (reversedPrefix reversed) ends with the fragment. Words are reported only if
+	// this is the first occurrence of the fragment, so that words containing it more than once
+	// are reported only once.
+	unsigned int Dawg::WordsWithPrefix(const WordBuffer& reversedPrefix, unsigned int fragmentLength,
+									   const WordCallback& callback) const
+	{
+		ScratchMemory scratchMemory;
+		WordBuffer word;
+		Dawg::InitializeWordBuffer(word, scratchMemory, reversedPrefix.length);
+		for (unsigned int idx = reversedPrefix.length; idx > 0; idx--)
+			Dawg::PushLetter(word, reversedPrefix.pLetters[idx - 1]);
+
+		const char* pFragment = word.pLetters + word.length - fragmentLength;
+		if (strstr(word.pLetters, pFragment) != pFragment)
+			return 0;
+
+		unsigned int nodeId = FindFragmentNode(word.pLetters, word.length, GetNode(Dawg::FORWARD_WORD_NODE_ID).childNodeId);
+		assert(nodeId != 0);	// reverse part words and words must agree!
+		if (nodeId == 0)
+			return 0;
+
+		unsigned int numWords = 0;
+		if (GetNode(nodeId).isTerminal == TRUE)
+		{
+			callback(word.pLetters);
+			numWords++;
+		}
+
+		return numWords + FindWordsInTree(GetNode(nodeId).childNodeId, word, callback);
+	}
 };
\ No newline at end of file
@@ -3,29 +3,26 @@
 #ifndef DAWG_H
 #define DAWG_H
 
+#include "AtomicFileWriter.h"
+#include "DawgFile.h"
+#include "MappedFile.h"
+#include "PackedDawgNodes.h"
+#include "ScratchMemory.h"
+
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace LxpStd
 {
-	typedef struct DawgNodeStruct	DawgNode;
 	typedef struct DawgHeaderStruct	DawgHeader;
 
-	// NOTES FROM OEIGINAL DAWG.HPP (1990s?)
-	// Several tests were conducted (making childNodeId a long and the
-	// other members char for speed) and that didn't alter the performance.
-	// Another test was conducted (similar to above except childNodeId was
-	// made a pointer instead of int) and the performance improved by
-	// 2 or 3% which is not signifcant.
-	struct DawgNodeStruct
-	{
-		unsigned int	childNodeId : 22;
-				 int	letter : 8;
-		unsigned int	isTerminal : 1;
-		unsigned int	isLastChild : 1;
-	};
-
-	// Used for writing the header information in Dawg files
-	// (original layout from 1990s)
+	// Used for writing the header information in V1 Dawg files (original layout from 1990s).
+	// Filled from the header of V2 files when they are loaded (size is the header size).
 	struct DawgHeaderStruct
 	{
 		unsigned int	size;
@@ -35,30 +32,76 @@ namespace LxpStd
 		unsigned int	numWords;
 	} ;
 
+	// Order of the sibling lists in a saved Dawg. The builders number the nodes depth first,
+	// which puts the few sibling lists every lookup goes through (the first levels) among
+	// the many that are rarely used, so lookups read from all over the nodes. The other
+	// layouts move the hot lists to the start, up to DawgCreator::HOT_NODES nodes so they stay
+	// in the cache: BREADTH_FIRST the first levels, ACCESS_FREQUENCY the lists scanned most by
+	// the lookups of sample words (e.g. from a query log). The rest stays depth first, which
+	// keeps the deep lists of a word close together. Any layout is read the same way.
+	enum class DawgNodeLayout {DEPTH_FIRST, BREADTH_FIRST, ACCESS_FREQUENCY};
+
 	// The following class is used for constructing the DAWG.
 	// Trie is the class that performs all the addition of words
 	// and compression. Typically, it will use the following class
-	// to create a DAWG and save it
+	// to create a DAWG and save it. Files are saved as V2 unless
+	// V1 is asked for (for older readers, up to V1_MAX_NODES nodes).
+	// The nodes are kept until SaveDawg lays them out, unless the
+	// Dawg is streamed (depth first without child masks): then they
+	// are written to the file as they are added. Either way the file
+	// is written with AtomicFileWriter, so it only shows up complete.
 	class DawgCreator
 	{
 	public:
+		// constants
+		static const unsigned int	HOT_NODES = 32 * 1024;	// laid out first (256K, about the size of L2)
+
 		// Existence
-		DawgCreator(const std::string& lexiconName, unsigned int numNodes, unsigned int numWords);
+		DawgCreator(const std::string& lexiconName, unsigned int numNodes, unsigned int numWords,
+					DawgFileFormat fileFormat = DawgFileFormat::V2);
 											// lexiconName will be truncated to first 32 characters
 		~DawgCreator();
 
 		// Methods
 		void AddNode(DawgNode& dawgNode);				// sequential addition is implied
-		void SaveDawg(const std::string& fileName) throw(...);	// all nodes must be added before this call
+		void StreamDawg(const std::string& fileName);	// before the nodes are added, SaveDawg finishes the file
+		void SaveDawg(const std::string& fileName, DawgNodeLayout nodeLayout = DawgNodeLayout::DEPTH_FIRST,
+					  const std::vector<std::string>& sampleWords = std::vector<std::string>(), bool isChildMasks = false);
+											// all nodes must be added before this call (depth first),
+											// sampleWords are only used for ACCESS_FREQUENCY,
+											// child masks are saved with the nodes (V2 only)
 
 	private:
+		// constants
+		static const unsigned int	CHUNK_NODES = 4096;		// encoded at a time for the file
+
 		// Implementation
 		void	CreateHeader(const std::string& lexiconName, unsigned int numNodes, unsigned int numWords);
+		void	FinishFile();											// checksum, then commits the file
+		void	LayOutNodes(DawgNodeLayout nodeLayout, const std::vector<std::string>& sampleWords);	// renumbers the nodes
+		void	StartFile(const std::string& fileName, bool isChildMasks);	// header (and section table)
+		void	WriteChildMasks();										// after the nodes (V2 only)
+		void	WriteNodeChunk();										// the nodes encoded so far
+		void	WriteNodeToFile(const DawgNode& dawgNode);				// through the chunk
+		void	WriteToFile(const char* pData, size_t length);			// and adds to the checksum
+
+		// Not Implemented (copy constructor and equal operator)
+		DawgCreator(const DawgCreator& dawgCreator);
+		DawgCreator& operator=(const DawgCreator& dawgCreator);
 
 		// Data
-		DawgNode*		pNodes;
-		DawgHeader		header;
-		unsigned int	numAddedNodes;
+		DawgNode*			pNodes;			// NULL when streamed
+		DawgHeader			header;
+		unsigned int		creationDate;	// YYYYMMDD
+		unsigned int		numAddedNodes;
+		DawgFileFormat		fileFormat;
+		bool				isStreamed;
+		std::string			streamFileName;
+		AtomicFileWriter	dawgFile;		// open from StartFile to FinishFile
+		DawgFileHeader		fileHeader;		// (V2)
+		std::vector<char>	chunk;			// nodes or child masks being encoded
+		unsigned int		numChunkNodes;
+		unsigned int		crc;			// of the file so far (V2)
 	};
 
 	class Dawg
@@ -80,37 +123,262 @@ namespace LxpStd
 		static const char	FORWARD_WORD_DAWG_SYMBOL = '*';
 		static const char	REVERSE_PARTWORD_DAWG_SYMBOL = '<';
 
+		// COPY reads the nodes into memory and verifies the number of words by counting them
+		// (and the checksum of V2 files).
+		// MEMORY_MAPPED uses the nodes directly from the (read only) mapped file. The pages are
+		// shared by all the processes using the same file and the number of words in the header
+		// is trusted. Initialization time doesn't depend on the size of the Dawg (the reverse part
+		// words are counted on the first call of NumReversePartWords instead). This needs a
+		// V2 file (on a little endian machine), V1 files are converted into memory instead.
+		// Only the header and the section table are checked (their own checksum and the section
+		// sizes against the file length): the nodes are not, so a file corrupted after it was
+		// saved can make queries read outside the nodes instead of failing to load. Use COPY
+		// (or PACKED) for files that may not be intact.
+		// PACKED reads the nodes as COPY does but keeps them bit packed (see PackedDawgNodes),
+		// in less than half the memory. Queries use the packed nodes as they are, at the cost
+		// of a few instructions per node read.
+		enum class LoadMode {COPY, MEMORY_MAPPED, PACKED};
+
+		// Matching scans the sibling list for each letter. BuildChildMasks computes, for every
+		// node, a mask with a bit for each letter of its children. As sibling lists are sorted,
+		// the child of a letter is then found directly: its index in the list is the number of
+		// bits set for the letters before it. The masks can be saved with the Dawg (V2 files),
+		// in which case they are loaded instead of built (and used in place when mapped).
+		// The first two letters of every lookup are always found without scanning, in a small
+		// direct index of the first two levels built on Initialize.
+
+		// Queries that enumerate words call back for each word found (in sorted order unless
+		// noted otherwise). pWord is only valid for the duration of the call. The words are
+		// built in the ScratchMemory of the calling thread, so queries don't use the heap.
+		typedef std::function<void(const char* pWord)>	WordCallback;
+
 		// Existence
 		Dawg();
 		~Dawg();
-		void	Initialize(const std::string& fileName) throw(...);	// initializes from a saved Dawg file
+		void	Initialize(const std::string& fileName, LoadMode loadMode = LoadMode::COPY, bool isChildMasks = false);
+																	// initializes from a saved Dawg file, with child masks
+																	// (from the file if it has them, built otherwise)
+
+		// Methods
+		void	BuildChildMasks();	// speeds up matching at the cost of 8 bytes per node (see above)
 
 		// Access
+		DawgFileFormat	GetFileFormat() const;
 		void			GetHeader(DawgHeader& header) const;
 		unsigned int	NumReversePartWords() const;
 
+		// Diagnostics
+		size_t			GetNodesSize() const;	// bytes taken by the nodes (in memory, mapped or packed)
+
 		// Matching
 		bool	IsWord(const std::string& word) const;
+		bool	IsWord(const char* pWord, unsigned int length) const;
 		bool	IsReversePartWord(const std::string& reversePartWord) const;
+		bool	IsReversePartWord(const char* pReversePartWord, unsigned int length) const;
+		unsigned int	AreWords(const char* pWords, const unsigned int* pOffsets, unsigned int numWords,
+								 unsigned int* pIsWordBits) const;
+											// word N is pWords[pOffsets[N]] up to pWords[pOffsets[N + 1]] (numWords + 1
+											// offsets); bit N of pIsWordBits (numWords / 32 rounded up entries) is set
+											// if word N is a word; returns the number of words
+
+		// Queries (return the number of words found)
+		unsigned int	Anagrams(const std::string& rack, const WordCallback& callback) const;
+											// words using all the tiles of the rack (WILDCARD_CHAR is a blank tile)
+		unsigned int	SubAnagrams(const std::string& rack, const WordCallback& callback) const;
+											// words using any of the tiles of the rack (WILDCARD_CHAR is a blank tile)
+		unsigned int	Match(const std::string& pattern, const WordCallback& callback) const;
+											// pattern letters match themselves, WILDCARD_CHAR matches any one letter,
+											// MULTI_CHAR_MATCH_SYMBOL matches zero or more letters and NOT_MATCH_SYMBOL
+											// followed by a letter matches any one letter other than that letter
+		unsigned int	WordsContaining(const std::string& fragment, const WordCallback& callback) const;
+											// words containing the fragment anywhere (NOT in sorted order)
+
+		// Hooks (letters returned in sorted order, fragments in either case as for the queries)
+		void	GetBackHooks(const std::string& fragment, std::string& hooks) const;	// letters that make a word when placed after
+		void	GetFrontHooks(const std::string& fragment, std::string& hooks) const;	// letters that make a word when placed before
 
 	private:
+		friend class DawgCreator;	// lays out the nodes for the lookups
+		friend class MoveGenerator;	// generates moves on the nodes directly
+
 		// common constants
 		static const unsigned int	ROOT_NODE_ID = 0;
 		static const unsigned int	FORWARD_WORD_NODE_ID = 1;
 		static const unsigned int	REVERSE_PARTWORD_NODE_ID = 2;
 		static const unsigned int	MINIMUM_NUMBER_OF_NODES = 3;	// Root, forward and reverse
 
+		static const unsigned int	MAX_PATTERN_TOKENS = 63;		// one bit per token (and one for a match) in a 64 bit state
+
+		// Pattern compiled to a (bit parallel) NFA. Bit N of a state is set when the first N
+		// tokens of the pattern have been matched.
+		struct CompiledPatternStruct
+		{
+			unsigned long long	advanceStates[END_LETTER - START_LETTER + 1];	// states that advance on a letter
+			unsigned long long	multiCharStates;	// states that stay on any letter (MULTI_CHAR_MATCH_SYMBOL)
+			unsigned long long	matchState;
+		};
+		typedef struct CompiledPatternStruct	CompiledPattern;
+
+		// Tiles left in the rack during anagram searches
+		struct RackStruct
+		{
+			unsigned char	letterCounts[END_LETTER - START_LETTER + 1];
+			unsigned int	numBlanks;
+			unsigned int	numTiles;
+		};
+		typedef struct RackStruct	Rack;
+
+		// Word being matched by AreWords
+		static const unsigned int	BATCH_LANES = 8;	// words matched in lockstep
+		struct BatchLaneStruct
+		{
+			unsigned int	nodeId;			// parent of the sibling list to match the next letter in
+			unsigned int	letterIdx;		// into pWords
+			unsigned int	endLetterIdx;
+			unsigned int	wordIdx;
+		};
+		typedef struct BatchLaneStruct	BatchLane;
+
+		// Built by BuildChildMasks, one per node. The child id and terminal flag are copied
+		// from the node so matching reads one entry (one cache miss at most) per letter.
+		static const unsigned int	TERMINAL_NODE_BIT = 1U << 31;
+		struct ChildIndexStruct
+		{
+			unsigned int	childMask;		// bit per letter of the children (and TERMINAL_NODE_BIT)
+			unsigned int	childNodeId;
+		};
+		typedef struct ChildIndexStruct	ChildIndex;
+		static_assert(sizeof(ChildIndexStruct) == DawgFile::CHILD_MASK_SIZE, "ChildIndex must be laid out as a V2 file child mask!");
+
+		// Nodes of the first two letters of the words (or of the reverse part words), 0 if
+		// there are no such letters. Every lookup goes through these sibling lists.
+		static const unsigned int	NUM_LETTERS = END_LETTER - START_LETTER + 1;
+		struct DirectIndexStruct
+		{
+			unsigned int	firstNodeIds[NUM_LETTERS];
+			unsigned int	secondNodeIds[NUM_LETTERS][NUM_LETTERS];	// [first letter][second letter]
+		};
+		typedef struct DirectIndexStruct	DirectIndex;
+
+		// Word being built by a query, in scratch memory. Grows (in the same scratch memory)
+		// if the Dawg has words longer than MAX_WORD_LENGTH.
+		struct WordBufferStruct
+		{
+			char*			pLetters;	// NUL terminated
+			unsigned int	length;
+			unsigned int	capacity;	// letters (not including the NUL)
+			ScratchMemory*	pScratchMemory;
+		};
+		typedef struct WordBufferStruct	WordBuffer;
+
 		// Implementation
+		unsigned int	AnagramTree(unsigned int nodeId, Rack& rack, bool isSubAnagram, WordBuffer& word,
+									const WordCallback& callback) const;
+		void			BuildDirectIndexes();
 		void			Cleanup();	// cleans up existing stuff!
 		unsigned int	CountNumReversePartWords() const;
 		unsigned int	CountNumWords() const;
 		unsigned int	CountNumWordFragmentsForTree(unsigned int nodeId) const;	// includes word and part words
-		bool			IsWordFragment(const std::string& wordFragment, unsigned int nodeId, unsigned int matchedLength) const;
+		void			DecodeNodes(const char* pData, bool isV1, bool isPacked);	// into memory
+		unsigned int	FindAnagrams(const std::string& rack, bool isSubAnagram, const WordCallback& callback) const;
+		unsigned int	FindChildNode(unsigned int parentNodeId, char letter) const;	// 0 if not found
+		unsigned int	FindFragmentNode(const char* pWordFragment, unsigned int length, unsigned int nodeId) const;
+																	// returns the node of the last letter (0 if not found)
+		unsigned int	FindWordsInTree(unsigned int nodeId, WordBuffer& word, const WordCallback& callback) const;
+		DawgNode		GetNode(unsigned int nodeId) const;
+		bool			IsLoaded() const;
+		bool			IsTerminalNode(unsigned int nodeId) const;
+		bool			IsWordFragment(const char* pWordFragment, unsigned int length, unsigned int parentNodeId) const;
+		void			LoadFile(const std::string& fileName, bool isPacked, bool isChildMasks);
+		void			LoadMappedFile(bool isChildMasks);
+		void			LoadV2Header(const char* pData, unsigned long long fileLength, DawgFileSection& nodesSection,
+									 DawgFileSection& childMasksSection);
+																	// header and section table (in pData), the child
+																	// masks section has size 0 if there isn't one
+		unsigned int	MatchDirectIndex(const char* pWordFragment, unsigned int length, unsigned int parentNodeId,
+										 unsigned int& nodeId) const;	// returns the number of letters matched
+		unsigned int	MatchTree(const CompiledPattern& compiledPattern, unsigned int nodeId, unsigned long long state,
+								  WordBuffer& word, const WordCallback& callback) const;
+		void			PrefetchNode(unsigned int nodeId) const;
+		bool			StartBatchLane(BatchLane& lane, const char* pWords, const unsigned int* pOffsets, unsigned int numWords,
+									   unsigned int& nextWordIdx) const;	// false if there are no more words
+		unsigned int	WordsContainingTree(unsigned int nodeId, unsigned int fragmentLength, WordBuffer& reversedPrefix,
+											const WordCallback& callback) const;
+		unsigned int	WordsWithPrefix(const WordBuffer& reversedPrefix, unsigned int fragmentLength,
+										const WordCallback& callback) const;
+
+		// static methods
+		static void					CompilePattern(const std::string& pattern, CompiledPattern& compiledPattern);
+		template <typename GetNodeFunction>
+		static unsigned int			GetChildMask(const GetNodeFunction& getNode, unsigned int numNodes, unsigned int parentNodeId);
+		static unsigned long long	GetPatternClosure(const CompiledPattern& compiledPattern, unsigned long long state);
+		static void					ReadChecksummed(std::ifstream& dawgStream, char* pData, size_t length, unsigned int& crc);
+		static void					GrowWordBuffer(WordBuffer& word);
+		static void					InitializeWordBuffer(WordBuffer& word, ScratchMemory& scratchMemory, unsigned int capacity);
+		static void					PopLetter(WordBuffer& word);
+		static void					PushLetter(WordBuffer& word, char letter);
 
 		// Data
-		DawgNode*		pNodes;
-		DawgHeader		header;
-		unsigned int	numReversePartWords;
+		const DawgNode*			pNodes;		// points into mappedFile when memory mapped, NULL when packed
+		PackedDawgNodes			packedNodes;	// empty unless packed
+		DawgHeader				header;
+		DawgFileFormat			fileFormat;
+		mutable unsigned int	numReversePartWords;
+		std::unique_ptr<std::once_flag>	pNumReversePartWordsOnce;	// counted once (on the first call when memory mapped),
+																	// a new flag for each Initialize
+		MappedFile				mappedFile;
+		const ChildIndex*		pChildIndex;	// NULL unless child masks are built or loaded
+		bool					isChildIndexMapped;	// points into mappedFile
+		DirectIndex				directIndexes[2];	// of the forward words and of the reverse part words
 	};
+
+	// GET NODE
+	// (every node read goes through here, so queries work on packed nodes as well)
+	inline DawgNode Dawg::GetNode(unsigned int nodeId) const
+	{
+		if (this->pNodes != NULL)
+			return this->pNodes[nodeId];
+
+		return this->packedNodes.GetNode(nodeId);
+	}
+
+	// GET CHILD MASK
+	// of the children of parentNodeId (see ChildIndex) with getNode(nodeId) reading the nodes,
+	// throws if the sibling list can't be jumped into
+	template <typename GetNodeFunction>
+	unsigned int Dawg::GetChildMask(const GetNodeFunction& getNode, unsigned int numNodes, unsigned int parentNodeId)
+	{
+		DawgNode parentNode = getNode(parentNodeId);
+		unsigned int childMask = parentNode.isTerminal ? Dawg::TERMINAL_NODE_BIT : 0;
+
+		// the root's children are the forward and reverse symbols, not letters
+		if (parentNodeId == Dawg::ROOT_NODE_ID || parentNode.childNodeId == 0)
+			return childMask;
+
+		char previousLetter = Dawg::START_LETTER - 1;
+		DawgNode node;
+		unsigned int nodeId = parentNode.childNodeId;
+		do
+		{
+			// the jump needs letters in the lexicon range and sorted sibling lists
+			if (nodeId >= numNodes)
+				throw(std::runtime_error("Node id is out of range! Bug or file corruption?"));
+
+			node = getNode(nodeId++);
+			if (node.letter <= previousLetter || node.letter > Dawg::END_LETTER)
+				throw(std::runtime_error("Sibling list is not sorted or has invalid letters! Bug or file corruption?"));
+
+			childMask |= 1U << (node.letter - Dawg::START_LETTER);
+			previousLetter = node.letter;
+		} while (!node.isLastChild);
+
+		return childMask;
+	}
+
+	// IS LOADED
+	inline bool Dawg::IsLoaded() const
+	{
+		return this->pNodes != NULL || !this->packedNodes.IsEmpty();
+	}
 }
 #endif // !DAWG_H
\ No newline at end of file
@@ -0,0 +1,397 @@
+#include "pch.h"
+#include "DawgBuilder.h"
+#include "LxpStdLib.h"
+#include "Dawg.h"
+#include "TreeWalkStack.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+namespace LxpStd
+{
+	// CONSTRUCTOR
+	DawgBuilder::DawgBuilder() :
+		listRegister(0, ListHash{ this }, ListEqual{ this })
+	{
+		this->diagnostics.numNodes = 3;	// root node, forward word node and reverse part word node
+		this->diagnostics.numWords = 0;
+		this->diagnostics.numWordLetters = 0;
+		this->diagnostics.numLetters = 0;
+		this->diagnostics.numReversePartWords = 0;
+
+		this->diagnostics.numFirstChildrenAfterCompression = 0;
+		this->diagnostics.numFirstChildrenBeforeCompression = 1;	// forward word node (and its sibling)
+		this->diagnostics.numNodesAfterCompression = 0;
+
+		this->diagnostics.numFinishPasses = 0;
+		this->diagnostics.numberingSeconds = 0.0;
+		this->diagnostics.savingSeconds = 0.0;
+
+		this->state = BuilderState::ADDING_WORDS;
+		this->listStarts.push_back(0);
+		this->pathLength = 0;
+		this->rootListId = DawgBuilder::NO_LIST;
+		this->numSaves = 0;
+		this->saveSeconds = 0.0;
+	}
+
+	// DESTRUCTOR
+	DawgBuilder::~DawgBuilder()
+	{
+	}
+
+	// ADD REVERSE PART WORDS
+	// The reverse part words are the suffixes of the reversed words. For example, if the
+	// word is CATS, the reversed word is STAC and the reverse part words are:
+	//
+	// STAC
+	// TAC
+	// AC
+	// C
+	//
+	// All of them are sorted and added to the DAWG the same way as words.
+	void DawgBuilder::AddReversePartWords(void)
+	{
+		const char* pReversedWords = this->reversedWords.data();
+		sort(this->reversePartWordOffsets.begin(), this->reversePartWordOffsets.end(),
+			[pReversedWords](unsigned int offset1, unsigned int offset2)
+			{
+				return strcmp(pReversedWords + offset1, pReversedWords + offset2) < 0;
+			});
+
+		const char* pPreviousPartWord = "";
+		for (unsigned int idx = 0; idx < this->reversePartWordOffsets.size(); idx++)
+		{
+			const char* pPartWord = pReversedWords + this->reversePartWordOffsets[idx];
+			unsigned int commonPrefixLength = DawgBuilder::GetCommonPrefixLength(pPartWord, pPreviousPartWord);
+			unsigned int partWordLength = strlen(pPartWord);
+
+			// the same reverse part word may come from many words
+			if (commonPrefixLength != partWordLength)
+				AddString(pPartWord, partWordLength, commonPrefixLength);
+
+			pPreviousPartWord = pPartWord;
+		}
+	}
+
+	// ADD STRING
+	// Adds a string that sorts after the previously added string (of the same kind).
+	// Only the first commonPrefixLength letters are shared with the previous string.
+	void DawgBuilder::AddString(const char* pString, unsigned int length, unsigned int commonPrefixLength)
+	{
+		assert(commonPrefixLength < length);
+
+		// nothing can be added anymore below the common prefix
+		FreezePath(commonPrefixLength + 1);
+
+		// add the rest of the letters
+		if (this->path.size() < length)
+			this->path.resize(length);
+
+		for (unsigned int depth = commonPrefixLength; depth < length; depth++)
+		{
+			assert(pString[depth] >= Dawg::START_LETTER && pString[depth] <= Dawg::END_LETTER);
+
+			DawgBuilderNode node;
+			node.childListId = DawgBuilder::NO_LIST;
+			node.letter = pString[depth];
+			node.isWordTerminal = (depth == length - 1);
+			this->path[depth].push_back(node);
+
+			this->diagnostics.numNodes++;
+			if (this->path[depth].size() == 1)
+				this->diagnostics.numFirstChildrenBeforeCompression++;
+		}
+
+		this->pathLength = length;
+	}
+
+	// ADD WORD
+	void DawgBuilder::AddWord(const char* pWord)
+	{
+		// validation
+		assert(pWord != NULL);
+
+		// validate state for addition
+		if (this->state != BuilderState::ADDING_WORDS)
+			throw(std::runtime_error("DawgBuilder must be in ADDING_WORDS state!"));
+
+		unsigned int wordLength = strlen(pWord);
+		if (wordLength == 0)
+			return;
+
+		// words must be in sorted order
+		int comparison = strcmp(pWord, this->previousWord.c_str());
+		if (comparison < 0)
+			throw(std::runtime_error("Words must be added in sorted order!"));
+		if (comparison == 0)
+			return;	// duplicate
+
+		AddString(pWord, wordLength, DawgBuilder::GetCommonPrefixLength(pWord, this->previousWord.c_str()));
+		this->previousWord = pWord;
+
+		// keep the reversed word for the reverse part words (see AddReversePartWords)
+		unsigned int reversedWordOffset = this->reversedWords.size();
+		for (int idx = wordLength - 1; idx >= 0; idx--)
+			this->reversedWords.push_back(pWord[idx]);
+		this->reversedWords.push_back('\0');
+
+		for (unsigned int idx = 0; idx < wordLength; idx++)
+			this->reversePartWordOffsets.push_back(reversedWordOffset + idx);
+
+		// diagnostics (same as what Trie would count)
+		this->diagnostics.numWords++;
+		this->diagnostics.numWordLetters += wordLength;
+		this->diagnostics.numReversePartWords += wordLength;
+		this->diagnostics.numLetters += wordLength + (wordLength * (wordLength + 1)) / 2;
+	}
+
+	// ARE LISTS SIMILAR
+	// Children are compared by list id as they are unique already
+	bool DawgBuilder::AreListsSimilar(unsigned int listId1, unsigned int listId2) const
+	{
+		unsigned int length = this->listStarts[listId1 + 1] - this->listStarts[listId1];
+		if (length != this->listStarts[listId2 + 1] - this->listStarts[listId2])
+			return false;
+
+		const DawgBuilderNode* pNode1 = &this->nodes[this->listStarts[listId1]];
+		const DawgBuilderNode* pNode2 = &this->nodes[this->listStarts[listId2]];
+		for (unsigned int idx = 0; idx < length; idx++, pNode1++, pNode2++)
+		{
+			if (pNode1->letter != pNode2->letter ||
+				pNode1->isWordTerminal != pNode2->isWordTerminal ||
+				pNode1->childListId != pNode2->childListId)
+				return false;
+		}
+
+		return true;
+	}
+
+	// ASSIGN NODE NUMBER FOR LIST
+	// Same numbering as Trie::AssignNodeNumberForTree (siblings are contiguous and
+	// the lists are numbered depth first)
+	void DawgBuilder::AssignNodeNumberForList(unsigned int listId, unsigned int& nextNodeNumber)
+	{
+		// the sibling whose list is to be numbered next, one per level (nodes of a list are contiguous)
+		struct SiblingStruct
+		{
+			unsigned int	nodeIdx;
+			unsigned int	endNodeIdx;		// of its list
+		};
+		TreeWalkStack<SiblingStruct> siblings;
+		while (true)
+		{
+			// numbered lists are not touched
+			if (listId != DawgBuilder::NO_LIST && this->listNodeNumbers[listId] == DawgBuilder::DEFAULT_NODE_NUMBER)
+			{
+				// number the siblings
+				SiblingStruct sibling = { this->listStarts[listId], this->listStarts[listId + 1] };
+				this->listNodeNumbers[listId] = nextNodeNumber;
+				nextNodeNumber += sibling.endNodeIdx - sibling.nodeIdx;
+				this->orderedListIds.push_back(listId);
+
+				// and then the children of each sibling
+				if (sibling.nodeIdx < sibling.endNodeIdx)
+					siblings.Push(sibling);
+			}
+
+			if (siblings.IsEmpty())
+				break;
+
+			SiblingStruct sibling = siblings.Pop();
+			listId = this->nodes[sibling.nodeIdx].childListId;
+			if (++sibling.nodeIdx < sibling.endNodeIdx)
+				siblings.Push(sibling);
+		}
+	}
+
+	// FINISH
+	void DawgBuilder::Finish(void)
+	{
+		if (this->state != BuilderState::ADDING_WORDS)
+			throw(std::runtime_error("DawgBuilder is already FINISHED!"));
+
+		// forward words
+		unsigned int forwardWordListId = DawgBuilder::NO_LIST;
+		FreezePath(1);
+		if (this->pathLength > 0)
+		{
+			forwardWordListId = RegisterList(this->path[0]);
+			this->path[0].clear();
+			this->pathLength = 0;
+		}
+
+		// reverse part words
+		AddReversePartWords();
+		vector<char>().swap(this->reversedWords);
+		vector<unsigned int>().swap(this->reversePartWordOffsets);
+
+		unsigned int reversePartWordListId = DawgBuilder::NO_LIST;
+		FreezePath(1);
+		if (this->pathLength > 0)
+			reversePartWordListId = RegisterList(this->path[0]);
+		vector<vector<DawgBuilderNode>>().swap(this->path);
+		this->pathLength = 0;
+
+		this->diagnostics.numFirstChildrenAfterCompression = this->listRegister.size() + 1;
+		ListRegister(0, ListHash{ this }, ListEqual{ this }).swap(this->listRegister);
+
+		// special nodes (not registered as they are unique)
+		vector<DawgBuilderNode> list(2);
+		list[0].letter = Dawg::FORWARD_WORD_DAWG_SYMBOL;
+		list[0].isWordTerminal = false;
+		list[0].childListId = forwardWordListId;
+		list[1].letter = Dawg::REVERSE_PARTWORD_DAWG_SYMBOL;
+		list[1].isWordTerminal = false;
+		list[1].childListId = reversePartWordListId;
+		unsigned int specialListId = StoreList(list);
+
+		list.resize(1);
+		list[0].letter = Dawg::DEFAULT_LETTER;
+		list[0].isWordTerminal = false;
+		list[0].childListId = specialListId;
+		this->rootListId = StoreList(list);
+
+		// number the nodes
+		chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+		this->listNodeNumbers.assign(this->listStarts.size() - 1, (int)DawgBuilder::DEFAULT_NODE_NUMBER);
+		unsigned int numNodes = 0;
+		AssignNodeNumberForList(this->rootListId, numNodes);
+		assert(numNodes == this->nodes.size());		// every stored list must be reachable
+
+		this->diagnostics.numNodesAfterCompression = numNodes;
+		this->diagnostics.numFinishPasses = 1;
+		this->diagnostics.numberingSeconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+		this->state = BuilderState::FINISHED;
+	}
+
+	// FREEZE PATH
+	// Registers the sibling lists on the path at minDepth and deeper. No more
+	// siblings will be added to them.
+	void DawgBuilder::FreezePath(unsigned int minDepth)
+	{
+		assert(minDepth > 0);
+
+		for (int depth = (int)this->pathLength - 1; depth >= (int)minDepth; depth--)
+		{
+			this->path[depth - 1].back().childListId = RegisterList(this->path[depth]);
+			this->path[depth].clear();
+		}
+
+		if (this->pathLength > minDepth)
+			this->pathLength = minDepth;
+	}
+
+	// GET COMMON PREFIX LENGTH
+	unsigned int DawgBuilder::GetCommonPrefixLength(const char* pString1, const char* pString2)
+	{
+		unsigned int length = 0;
+		while (pString1[length] != '\0' && pString1[length] == pString2[length])
+			length++;
+
+		return length;
+	}
+
+	// GET DIAGNOSTICS
+	void DawgBuilder::GetDiagnostics(TrieDiagnostics& diagnostics) const
+	{
+		diagnostics = this->diagnostics;
+		diagnostics.numFinishPasses += this->numSaves;
+		diagnostics.savingSeconds = this->saveSeconds;
+	}
+
+	// GET LIST HASH
+	// Hash is computed from the same attributes compared by AreListsSimilar
+	size_t DawgBuilder::GetListHash(unsigned int listId) const
+	{
+		size_t hash = 0;
+		for (unsigned int idx = this->listStarts[listId]; idx < this->listStarts[listId + 1]; idx++)
+		{
+			const DawgBuilderNode& node = this->nodes[idx];
+			hash = hash * 31 + (unsigned char)node.letter;
+			hash = hash * 31 + (node.isWordTerminal ? 1 : 0);
+			hash = hash * 31 + node.childListId;
+		}
+
+		return hash;
+	}
+
+	// REGISTER LIST
+	// returns the id of the unique list similar to the given list
+	unsigned int DawgBuilder::RegisterList(const vector<DawgBuilderNode>& list)
+	{
+		// store it so that it can be looked up, and take it back if it is a duplicate
+		unsigned int listId = StoreList(list);
+		pair<ListRegister::iterator, bool> result = this->listRegister.insert(listId);
+		if (result.second)
+			return listId;
+
+		this->nodes.resize(this->listStarts[listId]);
+		this->listStarts.pop_back();
+		return *result.first;
+	}
+
+	// SAVE AS DAWG
+	void DawgBuilder::SaveAsDawg(string fileName, string lexiconName, DawgFileFormat fileFormat, DawgNodeLayout nodeLayout,
+								 const vector<string>& sampleWords, bool isChildMasks) const
+	{
+		if (this->state != BuilderState::FINISHED)
+			throw(std::runtime_error("DawgBuilder must be FINISHED before saving!"));
+
+		chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+		DawgCreator dawgCreator(lexiconName, this->diagnostics.numNodesAfterCompression, this->diagnostics.numWords, fileFormat);
+		if (nodeLayout == DawgNodeLayout::DEPTH_FIRST && !isChildMasks)
+			dawgCreator.StreamDawg(fileName);	// (the nodes aren't kept a second time)
+
+		DawgNode dawgNode;
+		for (unsigned int listIdx = 0; listIdx < this->orderedListIds.size(); listIdx++)
+		{
+			unsigned int listId = this->orderedListIds[listIdx];
+			for (unsigned int idx = this->listStarts[listId]; idx < this->listStarts[listId + 1]; idx++)
+			{
+				const DawgBuilderNode& node = this->nodes[idx];
+				dawgNode.letter = node.letter;
+
+				if (node.childListId != DawgBuilder::NO_LIST)
+					dawgNode.childNodeId = this->listNodeNumbers[node.childListId];
+				else
+					dawgNode.childNodeId = 0;
+
+				// needed as the two types are different (bool vs unsigned char)
+				if (node.isWordTerminal)
+					dawgNode.isTerminal = TRUE;
+				else
+					dawgNode.isTerminal = FALSE;
+
+				if (idx == this->listStarts[listId + 1] - 1)
+					dawgNode.isLastChild = TRUE;
+				else
+					dawgNode.isLastChild = FALSE;
+
+				dawgCreator.AddNode(dawgNode);
+			}
+		}
+
+		this->numSaves++;
+		this->saveSeconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+
+		dawgCreator.SaveDawg(fileName, nodeLayout, sampleWords, isChildMasks);
+	}
+
+	// STORE LIST
+	// returns the id of the stored list
+	unsigned int DawgBuilder::StoreList(const vector<DawgBuilderNode>& list)
+	{
+		unsigned int listId = this->listStarts.size() - 1;
+		this->nodes.insert(this->nodes.end(), list.begin(), list.end());
+		this->listStarts.push_back(this->nodes.size());
+
+		return listId;
+	}
+}
@@ -0,0 +1,119 @@
+// DawgBuilder.h
+
+#ifndef DAWG_BUILDER_H
+#define DAWG_BUILDER_H
+
+#include "Dawg.h"
+#include "Trie.h"
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace LxpStd
+{
+	typedef struct DawgBuilderNodeStruct	DawgBuilderNode;
+
+	// this structure is used for the sibling lists built by DawgBuilder
+	struct DawgBuilderNodeStruct
+	{
+		unsigned int	childListId;	// DawgBuilder::NO_LIST if there are no children
+		char			letter;
+		bool			isWordTerminal;
+	};
+
+	// DawgBuilder is an alternative to Trie for building a DAWG when the words are
+	// available in sorted order. Instead of building the whole Trie and compressing it
+	// afterwards, the DAWG is minimized on the fly (incremental construction as described
+	// by Daciuk et al.). Only the sibling lists on the path of the last added word are
+	// kept uncompressed; all the others have already been merged into a register of
+	// unique sibling lists.
+	//
+	// Reverse part words can't be added in sorted order as the words arrive. Hence, the
+	// builder only keeps the reversed words (one byte per letter) until Finish is called.
+	// The reverse part words are the suffixes of the reversed words; they are sorted then
+	// and added to the register the same way.
+	//
+	// The resulting DAWG (and the diagnostics) are the same as what a Trie would produce
+	// for the same words, with a fraction of the peak memory.
+
+	class DawgBuilder
+	{
+	public:
+		// constants
+		static const unsigned int	NO_LIST = 0xFFFFFFFF;
+
+		// Existence
+		DawgBuilder();
+		~DawgBuilder();
+
+		// Methods
+		void	AddWord(const char* pWord);	// words MUST be added in sorted order (duplicates are ignored)
+		void	Finish(void);				// SHOULD be called after all the words are added
+		void	SaveAsDawg(std::string fileName, std::string lexiconName, DawgFileFormat fileFormat = DawgFileFormat::V2,
+						   DawgNodeLayout nodeLayout = DawgNodeLayout::DEPTH_FIRST,
+						   const std::vector<std::string>& sampleWords = std::vector<std::string>(),
+						   bool isChildMasks = false) const;
+													// (see DawgNodeLayout and DawgCreator::SaveDawg)
+
+		// Diagnostics
+		void	GetDiagnostics(TrieDiagnostics& diagnostics) const;	// same meaning as for Trie
+
+	private:
+		enum class BuilderState {ADDING_WORDS, FINISHED};
+		static const int DEFAULT_NODE_NUMBER = -1;
+
+		// Implementation
+		void			AddString(const char* pString, unsigned int length, unsigned int commonPrefixLength);
+		void			AddReversePartWords(void);
+		void			AssignNodeNumberForList(unsigned int listId, unsigned int& nextNodeNumber);
+		bool			AreListsSimilar(unsigned int listId1, unsigned int listId2) const;
+		void			FreezePath(unsigned int minDepth);
+		size_t			GetListHash(unsigned int listId) const;
+		unsigned int	RegisterList(const std::vector<DawgBuilderNode>& list);
+		unsigned int	StoreList(const std::vector<DawgBuilderNode>& list);
+
+		// static methods
+		static unsigned int	GetCommonPrefixLength(const char* pString1, const char* pString2);
+
+		// Register of unique sibling lists
+		struct ListHash
+		{
+			const DawgBuilder*	pBuilder;
+			size_t operator()(unsigned int listId) const { return pBuilder->GetListHash(listId); }
+		};
+		struct ListEqual
+		{
+			const DawgBuilder*	pBuilder;
+			bool operator()(unsigned int listId1, unsigned int listId2) const { return pBuilder->AreListsSimilar(listId1, listId2); }
+		};
+		typedef std::unordered_set<unsigned int, ListHash, ListEqual>	ListRegister;
+
+		// Not Implemented
+		DawgBuilder(const DawgBuilder& dawgBuilder);
+		DawgBuilder& operator=(const DawgBuilder& dawgBuilder);
+
+		// Data
+		BuilderState		state;
+		TrieDiagnostics		diagnostics;
+
+		std::vector<DawgBuilderNode>	nodes;			// nodes of all the stored sibling lists
+		std::vector<unsigned int>		listStarts;		// list N is nodes[listStarts[N]] to nodes[listStarts[N + 1] - 1]
+		ListRegister					listRegister;	// unique sibling lists
+
+		std::vector<std::vector<DawgBuilderNode>>	path;		// sibling lists (by depth) not yet registered
+		unsigned int								pathLength;	// length of the last added string
+		std::string									previousWord;
+
+		std::vector<char>			reversedWords;			// '\0' separated
+		std::vector<unsigned int>	reversePartWordOffsets;	// into reversedWords
+
+		unsigned int				rootListId;
+		std::vector<int>			listNodeNumbers;	// node number of the first node of the list
+		std::vector<unsigned int>	orderedListIds;		// in the order they are saved
+		mutable unsigned int		numSaves;			// (SaveAsDawg is const)
+		mutable double				saveSeconds;		// nodes pass of the last one
+	};
+}
+
+#endif // !DAWG_BUILDER_H
@@ -0,0 +1,246 @@
+#include "pch.h"
+#include "DawgFile.h"
+#include "Dawg.h"
+
+#include <cstring>
+
+namespace LxpStd
+{
+	namespace
+	{
+		// node of a V1 file (in the layout of the compiler, as it was written)
+		struct DawgV1NodeStruct
+		{
+			unsigned int	childNodeId : 22;
+					 int	letter : 8;
+			unsigned int	isTerminal : 1;
+			unsigned int	isLastChild : 1;
+		};
+		typedef struct DawgV1NodeStruct	DawgV1Node;
+
+		// byte offsets of the header fields
+		const unsigned int	HEADER_VERSION_OFFSET = 8;
+		const unsigned int	HEADER_SIZE_OFFSET = 12;
+		const unsigned int	HEADER_NUM_SECTIONS_OFFSET = 16;
+		const unsigned int	HEADER_NUM_NODES_OFFSET = 20;
+		const unsigned int	HEADER_NUM_WORDS_OFFSET = 24;
+		const unsigned int	HEADER_CREATION_DATE_OFFSET = 28;
+		const unsigned int	HEADER_LEXICON_NAME_OFFSET = 36;
+	}
+
+	const char DawgFile::MAGIC[DawgFile::MAGIC_LENGTH] = { 'L', 'X', 'P', 'D', 'A', 'W', 'G', '\x1A' };
+
+	// ALIGN SECTION
+	unsigned long long DawgFile::AlignSection(unsigned long long offset)
+	{
+		return (offset + DawgFile::SECTION_ALIGNMENT - 1) / DawgFile::SECTION_ALIGNMENT * DawgFile::SECTION_ALIGNMENT;
+	}
+
+	// CRC 32
+	// (IEEE 802.3, as zip and png) eight bytes at a time with eight tables (slicing by 8)
+	unsigned int DawgFile::Crc32(unsigned int crc, const void* pData, size_t length)
+	{
+		struct Crc32TablesStruct
+		{
+			unsigned int	entries[8][256];
+
+			Crc32TablesStruct()
+			{
+				for (unsigned int idx = 0; idx < 256; idx++)
+				{
+					unsigned int entry = idx;
+					for (int bit = 0; bit < 8; bit++)
+						entry = (entry & 1) ? (entry >> 1) ^ 0xEDB88320U : entry >> 1;
+					this->entries[0][idx] = entry;
+				}
+
+				for (unsigned int idx = 0; idx < 256; idx++)
+				{
+					for (int table = 1; table < 8; table++)
+						this->entries[table][idx] = (this->entries[table - 1][idx] >> 8) ^ this->entries[0][this->entries[table - 1][idx] & 0xFF];
+				}
+			}
+		};
+		static const Crc32TablesStruct tables;
+
+		const unsigned char* pBytes = (const unsigned char*)pData;
+		crc = ~crc;
+		for (; length >= 8; length -= 8, pBytes += 8)
+		{
+			unsigned int low = crc ^ ((unsigned int)pBytes[0] | ((unsigned int)pBytes[1] << 8) | ((unsigned int)pBytes[2] << 16) | ((unsigned int)pBytes[3] << 24));
+			crc = tables.entries[7][low & 0xFF] ^ tables.entries[6][(low >> 8) & 0xFF] ^
+				  tables.entries[5][(low >> 16) & 0xFF] ^ tables.entries[4][low >> 24] ^
+				  tables.entries[3][pBytes[4]] ^ tables.entries[2][pBytes[5]] ^
+				  tables.entries[1][pBytes[6]] ^ tables.entries[0][pBytes[7]];
+		}
+
+		for (; length > 0; length--, pBytes++)
+			crc = tables.entries[0][(crc ^ *pBytes) & 0xFF] ^ (crc >> 8);
+
+		return ~crc;
+	}
+
+	// HEADER CHECKSUM
+	// length bytes from the start of the file (up to the end of the section table)
+	unsigned int DawgFile::HeaderChecksum(const char* pData, size_t length)
+	{
+		char headerData[DawgFile::HEADER_SIZE];
+		memcpy(headerData, pData, DawgFile::HEADER_SIZE);
+		memset(headerData + DawgFile::HEADER_CHECKSUM_OFFSET, 0, 4);
+		memset(headerData + DawgFile::HEADER_HEADER_CHECKSUM_OFFSET, 0, 4);
+
+		unsigned int crc = Crc32(0, headerData, DawgFile::HEADER_SIZE);
+		return Crc32(crc, pData + DawgFile::HEADER_SIZE, length - DawgFile::HEADER_SIZE);
+	}
+
+	// IS LITTLE ENDIAN MACHINE
+	bool DawgFile::IsLittleEndianMachine()
+	{
+		const unsigned int one = 1;
+		return *(const unsigned char*)&one == 1;
+	}
+
+	// IS VERSION 2
+	bool DawgFile::IsVersion2(const char* pData, size_t length)
+	{
+		return length >= DawgFile::MAGIC_LENGTH && memcmp(pData, DawgFile::MAGIC, DawgFile::MAGIC_LENGTH) == 0;
+	}
+
+	// READ CHILD MASK
+	void DawgFile::ReadChildMask(const char* pData, unsigned int& childMask, unsigned int& childNodeId)
+	{
+		childMask = ReadUInt32(pData);
+		childNodeId = ReadUInt32(pData + 4);
+	}
+
+	// READ HEADER
+	void DawgFile::ReadHeader(const char* pData, DawgFileHeader& header)
+	{
+		header.version = ReadUInt32(pData + HEADER_VERSION_OFFSET);
+		header.headerSize = ReadUInt32(pData + HEADER_SIZE_OFFSET);
+		header.numSections = ReadUInt32(pData + HEADER_NUM_SECTIONS_OFFSET);
+		header.numNodes = ReadUInt32(pData + HEADER_NUM_NODES_OFFSET);
+		header.numWords = ReadUInt32(pData + HEADER_NUM_WORDS_OFFSET);
+		header.creationDate = ReadUInt32(pData + HEADER_CREATION_DATE_OFFSET);
+		header.checksum = ReadUInt32(pData + DawgFile::HEADER_CHECKSUM_OFFSET);
+		memcpy(header.lexiconName, pData + HEADER_LEXICON_NAME_OFFSET, sizeof(header.lexiconName));
+		header.headerChecksum = ReadUInt32(pData + DawgFile::HEADER_HEADER_CHECKSUM_OFFSET);
+	}
+
+	// READ NODE
+	void DawgFile::ReadNode(const char* pData, DawgNode& node)
+	{
+		node.childNodeId = ReadUInt32(pData);
+		node.letter = pData[4];
+		node.isTerminal = (unsigned char)pData[5];
+		node.isLastChild = (unsigned char)pData[6];
+		node.reserved = 0;
+	}
+
+	// READ SECTION
+	void DawgFile::ReadSection(const char* pData, DawgFileSection& section)
+	{
+		section.type = ReadUInt32(pData);
+		section.offset = ReadUInt64(pData + 8);
+		section.size = ReadUInt64(pData + 16);
+	}
+
+	// READ UINT 32
+	unsigned int DawgFile::ReadUInt32(const char* pData)
+	{
+		const unsigned char* pBytes = (const unsigned char*)pData;
+		return (unsigned int)pBytes[0] | ((unsigned int)pBytes[1] << 8) | ((unsigned int)pBytes[2] << 16) | ((unsigned int)pBytes[3] << 24);
+	}
+
+	// READ UINT 64
+	unsigned long long DawgFile::ReadUInt64(const char* pData)
+	{
+		return (unsigned long long)ReadUInt32(pData) | ((unsigned long long)ReadUInt32(pData + 4) << 32);
+	}
+
+	// READ V1 NODE
+	void DawgFile::ReadV1Node(const char* pData, DawgNode& node)
+	{
+		DawgV1Node v1Node;
+		memcpy(&v1Node, pData, sizeof(v1Node));
+
+		node.childNodeId = v1Node.childNodeId;
+		node.letter = (char)v1Node.letter;
+		node.isTerminal = (unsigned char)v1Node.isTerminal;
+		node.isLastChild = (unsigned char)v1Node.isLastChild;
+		node.reserved = 0;
+	}
+
+	// WRITE CHILD MASK
+	void DawgFile::WriteChildMask(unsigned int childMask, unsigned int childNodeId, char* pData)
+	{
+		WriteUInt32(childMask, pData);
+		WriteUInt32(childNodeId, pData + 4);
+	}
+
+	// WRITE HEADER
+	// (the magic number and the version too) unused bytes are zero
+	void DawgFile::WriteHeader(const DawgFileHeader& header, char* pData)
+	{
+		memset(pData, 0, DawgFile::HEADER_SIZE);
+		memcpy(pData, DawgFile::MAGIC, DawgFile::MAGIC_LENGTH);
+
+		WriteUInt32(header.version, pData + HEADER_VERSION_OFFSET);
+		WriteUInt32(header.headerSize, pData + HEADER_SIZE_OFFSET);
+		WriteUInt32(header.numSections, pData + HEADER_NUM_SECTIONS_OFFSET);
+		WriteUInt32(header.numNodes, pData + HEADER_NUM_NODES_OFFSET);
+		WriteUInt32(header.numWords, pData + HEADER_NUM_WORDS_OFFSET);
+		WriteUInt32(header.creationDate, pData + HEADER_CREATION_DATE_OFFSET);
+		WriteUInt32(header.checksum, pData + DawgFile::HEADER_CHECKSUM_OFFSET);
+		memcpy(pData + HEADER_LEXICON_NAME_OFFSET, header.lexiconName, sizeof(header.lexiconName));
+		WriteUInt32(header.headerChecksum, pData + DawgFile::HEADER_HEADER_CHECKSUM_OFFSET);
+	}
+
+	// WRITE NODE
+	void DawgFile::WriteNode(const DawgNode& node, char* pData)
+	{
+		WriteUInt32(node.childNodeId, pData);
+		pData[4] = node.letter;
+		pData[5] = node.isTerminal ? 1 : 0;
+		pData[6] = node.isLastChild ? 1 : 0;
+		pData[7] = 0;
+	}
+
+	// WRITE SECTION
+	void DawgFile::WriteSection(const DawgFileSection& section, char* pData)
+	{
+		WriteUInt32(section.type, pData);
+		WriteUInt32(0, pData + 4);
+		WriteUInt64(section.offset, pData + 8);
+		WriteUInt64(section.size, pData + 16);
+	}
+
+	// WRITE UINT 32
+	void DawgFile::WriteUInt32(unsigned int value, char* pData)
+	{
+		pData[0] = (char)(value & 0xFF);
+		pData[1] = (char)((value >> 8) & 0xFF);
+		pData[2] = (char)((value >> 16) & 0xFF);
+		pData[3] = (char)((value >> 24) & 0xFF);
+	}
+
+	// WRITE UINT 64
+	void DawgFile::WriteUInt64(unsigned long long value, char* pData)
+	{
+		WriteUInt32((unsigned int)(value & 0xFFFFFFFF), pData);
+		WriteUInt32((unsigned int)(value >> 32), pData + 4);
+	}
+
+	// WRITE V1 NODE
+	void DawgFile::WriteV1Node(const DawgNode& node, char* pData)
+	{
+		DawgV1Node v1Node;
+		memset(&v1Node, 0, sizeof(v1Node));
+		v1Node.childNodeId = node.childNodeId;
+		v1Node.letter = node.letter;
+		v1Node.isTerminal = node.isTerminal ? 1 : 0;
+		v1Node.isLastChild = node.isLastChild ? 1 : 0;
+
+		memcpy(pData, &v1Node, sizeof(v1Node));
+	}
+}
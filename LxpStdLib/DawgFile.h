@@ -0,0 +1,129 @@
+// DawgFile.h
+
+#ifndef DAWG_FILE_H
+#define DAWG_FILE_H
+
+#include <cstddef>
+
+namespace LxpStd
+{
+	typedef struct DawgNodeStruct			DawgNode;
+	typedef struct DawgFileHeaderStruct		DawgFileHeader;
+	typedef struct DawgFileSectionStruct	DawgFileSection;
+
+	// NOTES FROM OEIGINAL DAWG.HPP (1990s?)
+	// Several tests were conducted (making childNodeId a long and the
+	// other members char for speed) and that didn't alter the performance.
+	// Another test was conducted (similar to above except childNodeId was
+	// made a pointer instead of int) and the performance improved by
+	// 2 or 3% which is not signifcant.
+	//
+	// The node was 4 bytes with a 22 bit childNodeId (as it still is in V1 files), which
+	// limited a Dawg to 4M nodes. It is laid out as in V2 files (see below, the layout is
+	// checked after DawgFile).
+	struct DawgNodeStruct
+	{
+		unsigned int	childNodeId;
+		char			letter;
+		unsigned char	isTerminal;
+		unsigned char	isLastChild;
+		unsigned char	reserved;		// zero
+	};
+
+	// V1 is the original file: the DawgHeader and 4 byte nodes (22 bit child ids) written
+	// as they are in memory, i.e. only readable on machines with the same layout and limited
+	// to V1_MAX_NODES nodes.
+	// V2 starts with a header identified by a magic number and a section table. Every field
+	// is written explicitly in little endian order. Nodes have 32 bit child ids and are laid
+	// out as DawgNode is in memory (on little endian machines), so a memory mapped file can be
+	// used in place. A CRC-32 of the whole file (with the checksum field as zero) is kept in
+	// the header, and one of the header and the section table only (with both checksum fields
+	// as zero), which is checked even when the rest of the file isn't read (memory mapped).
+	// Sections of unknown types are skipped, so sections can be added later.
+	//
+	//		header			HEADER_SIZE bytes (see DawgFileHeader for the fields)
+	//		section table	numSections entries of SECTION_ENTRY_SIZE bytes
+	//		sections		each starting at a multiple of SECTION_ALIGNMENT
+	//
+	// The sections are the nodes and, optionally after them, the child masks of the nodes
+	// (see Dawg::BuildChildMasks): per node, the mask and the child id as two 32 bit values,
+	// so they can also be used in place when memory mapped.
+	enum class DawgFileFormat {V1, V2};
+
+	// header of a V2 file
+	struct DawgFileHeaderStruct
+	{
+		unsigned int	version;
+		unsigned int	headerSize;
+		unsigned int	numSections;
+		unsigned int	numNodes;
+		unsigned int	numWords;
+		unsigned int	creationDate;		// YYYYMMDD (local time)
+		unsigned int	checksum;
+		char			lexiconName[32];	// NUL terminated unless all 32 are used
+		unsigned int	headerChecksum;		// of the header and the section table
+	};
+
+	// entry of the section table of a V2 file
+	struct DawgFileSectionStruct
+	{
+		unsigned int		type;
+		unsigned long long	offset;		// from the start of the file
+		unsigned long long	size;		// bytes
+	};
+
+	// Reading and writing the parts of Dawg files (see above)
+
+	class DawgFile
+	{
+	public:
+		// constants
+		static const unsigned int	MAGIC_LENGTH = 8;
+		static const char			MAGIC[MAGIC_LENGTH];
+		static const unsigned int	VERSION = 2;
+		static const unsigned int	HEADER_SIZE = 128;
+		static const unsigned int	HEADER_CHECKSUM_OFFSET = 32;	// (4 bytes)
+		static const unsigned int	HEADER_HEADER_CHECKSUM_OFFSET = 68;	// (4 bytes)
+		static const unsigned int	SECTION_ENTRY_SIZE = 24;
+		static const unsigned int	SECTION_ALIGNMENT = 64;
+		static const unsigned int	NODE_SIZE = 8;
+		static const unsigned int	CHILD_MASK_SIZE = 8;
+		static const unsigned int	V1_NODE_SIZE = 4;
+		static const unsigned int	V1_MAX_NODES = 1 << 22;
+
+		// section types
+		static const unsigned int	NODES_SECTION = 1;
+		static const unsigned int	CHILD_MASKS_SECTION = 2;
+
+		// Methods (pData has room for the header, the entry or the node)
+		static bool		IsVersion2(const char* pData, size_t length);	// starts with the magic number?
+		static void		ReadChildMask(const char* pData, unsigned int& childMask, unsigned int& childNodeId);
+		static void		ReadHeader(const char* pData, DawgFileHeader& header);
+		static void		ReadNode(const char* pData, DawgNode& node);
+		static void		ReadSection(const char* pData, DawgFileSection& section);
+		static void		ReadV1Node(const char* pData, DawgNode& node);
+		static void		WriteChildMask(unsigned int childMask, unsigned int childNodeId, char* pData);
+		static void		WriteHeader(const DawgFileHeader& header, char* pData);
+		static void		WriteNode(const DawgNode& node, char* pData);
+		static void		WriteSection(const DawgFileSection& section, char* pData);
+		static void		WriteV1Node(const DawgNode& node, char* pData);
+
+		static unsigned long long	AlignSection(unsigned long long offset);	// up to SECTION_ALIGNMENT
+		static unsigned int			Crc32(unsigned int crc, const void* pData, size_t length);	// crc is 0 to start
+		static unsigned int			HeaderChecksum(const char* pData, size_t length);	// header and section table
+		static bool					IsLittleEndianMachine();
+
+	private:
+		// Implementation
+		static unsigned int			ReadUInt32(const char* pData);
+		static unsigned long long	ReadUInt64(const char* pData);
+		static void					WriteUInt32(unsigned int value, char* pData);
+		static void					WriteUInt64(unsigned long long value, char* pData);
+	};
+
+	// the nodes of V2 files are read into DawgNode arrays and used in place when mapped
+	static_assert(sizeof(DawgNode) == DawgFile::NODE_SIZE, "DawgNode must be the size of a V2 file node!");
+	static_assert(offsetof(DawgNode, childNodeId) == 0 && offsetof(DawgNode, letter) == 4 && offsetof(DawgNode, isTerminal) == 5 &&
+				  offsetof(DawgNode, isLastChild) == 6 && offsetof(DawgNode, reserved) == 7, "DawgNode must be laid out as a V2 file node!");
+}
+#endif // !DAWG_FILE_H
@@ -1,2 +1,52 @@
 ﻿#include "pch.h"
 #include "LxpStdLib.h"
+
+#include <exception>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace LxpStd
+{
+	// RUN ON THREADS
+	// calls the function on each thread (threadIdx 0 on the calling thread) and waits for them;
+	// an exception thrown by any of them is rethrown
+	void RunOnThreads(unsigned int numThreads, const std::function<void(unsigned int threadIdx)>& function)
+	{
+		vector<exception_ptr> exceptions(numThreads);
+		vector<thread> threads;
+		for (unsigned int threadIdx = 1; threadIdx < numThreads; threadIdx++)
+		{
+			threads.push_back(thread([&function, &exceptions, threadIdx]()
+			{
+				try
+				{
+					function(threadIdx);
+				}
+				catch (...)
+				{
+					exceptions[threadIdx] = current_exception();
+				}
+			}));
+		}
+
+		try
+		{
+			function(0);
+		}
+		catch (...)
+		{
+			exceptions[0] = current_exception();
+		}
+
+		for (unsigned int idx = 0; idx < threads.size(); idx++)
+			threads[idx].join();
+
+		for (unsigned int idx = 0; idx < exceptions.size(); idx++)
+		{
+			if (exceptions[idx])
+				rethrow_exception(exceptions[idx]);
+		}
+	}
+}
@@ -3,6 +3,18 @@
 #ifndef LXPSTDLIB_H
 #define LXPSTDLIB_H
 
+// hint to bring the cache line of an address in (no effect where not supported)
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <xmmintrin.h>
+#define LXP_PREFETCH(pAddress)	_mm_prefetch((const char*)(pAddress), _MM_HINT_T0)
+#elif defined(__GNUC__) || defined(__clang__)
+#define LXP_PREFETCH(pAddress)	__builtin_prefetch(pAddress)
+#else
+#define LXP_PREFETCH(pAddress)	((void)0)
+#endif
+
+#include <functional>
+
 namespace LxpStd
 {
 	// common typedefs
@@ -12,6 +24,21 @@ namespace LxpStd
 
 	// common constants
 
+	// common functions
+	inline unsigned int PopCount(unsigned int value);	// number of bits set
+	void RunOnThreads(unsigned int numThreads, const std::function<void(unsigned int threadIdx)>& function);
+														// threadIdx 0 on the calling thread, rethrows exceptions
+
+	inline unsigned int PopCount(unsigned int value)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		return (unsigned int)__builtin_popcount(value);
+#else
+		value = value - ((value >> 1) & 0x55555555);
+		value = (value & 0x33333333) + ((value >> 2) & 0x33333333);
+		return (((value + (value >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+#endif
+	}
 }
 #endif // !LXPSTDLIB_H
 
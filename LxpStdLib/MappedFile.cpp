@@ -0,0 +1,139 @@
+#include "pch.h"
+#include "MappedFile.h"
+
+#include <stdexcept>
+#include <string>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace LxpStd
+{
+	// CONSTRUCTOR
+	MappedFile::MappedFile()
+	{
+		this->pData = NULL;
+		this->length = 0;
+#ifdef _WIN32
+		this->fileHandle = INVALID_HANDLE_VALUE;
+		this->mappingHandle = NULL;
+#else
+		this->fileDescriptor = -1;
+#endif
+	}
+
+	// DESTRUCTOR
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+	// CLOSE
+	void MappedFile::Close()
+	{
+#ifdef _WIN32
+		if (this->pData != NULL)
+			UnmapViewOfFile(this->pData);
+		if (this->mappingHandle != NULL)
+			CloseHandle(this->mappingHandle);
+		if (this->fileHandle != INVALID_HANDLE_VALUE)
+			CloseHandle(this->fileHandle);
+
+		this->fileHandle = INVALID_HANDLE_VALUE;
+		this->mappingHandle = NULL;
+#else
+		if (this->pData != NULL)
+			munmap((void*)this->pData, this->length);
+		if (this->fileDescriptor != -1)
+			close(this->fileDescriptor);
+
+		this->fileDescriptor = -1;
+#endif
+		this->pData = NULL;
+		this->length = 0;
+	}
+
+	// DATA
+	const char* MappedFile::Data() const
+	{
+		return this->pData;
+	}
+
+	// IS OPEN
+	bool MappedFile::IsOpen() const
+	{
+		return this->pData != NULL;
+	}
+
+	// LENGTH
+	size_t MappedFile::Length() const
+	{
+		return this->length;
+	}
+
+	// OPEN
+	void MappedFile::Open(const string& fileName)
+	{
+		// clean up first
+		Close();
+
+#ifdef _WIN32
+		// file name needs to be wide for CreateFile2
+		int wideLength = MultiByteToWideChar(CP_UTF8, 0, fileName.c_str(), -1, NULL, 0);
+		wstring wideFileName(wideLength, L'\0');
+		MultiByteToWideChar(CP_UTF8, 0, fileName.c_str(), -1, &wideFileName[0], wideLength);
+
+		this->fileHandle = CreateFile2(wideFileName.c_str(), GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING, NULL);
+		if (this->fileHandle == INVALID_HANDLE_VALUE)
+			throw(std::runtime_error("Unable to open file for mapping!"));
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(this->fileHandle, &fileSize) || fileSize.QuadPart == 0)
+		{
+			Close();
+			throw(std::runtime_error("Unable to map an empty file!"));
+		}
+
+		this->mappingHandle = CreateFileMappingFromApp(this->fileHandle, NULL, PAGE_READONLY, 0, NULL);
+		if (this->mappingHandle == NULL)
+		{
+			Close();
+			throw(std::runtime_error("Unable to create file mapping!"));
+		}
+
+		this->pData = (const char*)MapViewOfFileFromApp(this->mappingHandle, FILE_MAP_READ, 0, 0);
+		if (this->pData == NULL)
+		{
+			Close();
+			throw(std::runtime_error("Unable to map view of file!"));
+		}
+		this->length = (size_t)fileSize.QuadPart;
+#else
+		this->fileDescriptor = open(fileName.c_str(), O_RDONLY);
+		if (this->fileDescriptor == -1)
+			throw(std::runtime_error("Unable to open file for mapping!"));
+
+		struct stat fileStat;
+		if (fstat(this->fileDescriptor, &fileStat) != 0 || fileStat.st_size == 0)
+		{
+			Close();
+			throw(std::runtime_error("Unable to map an empty file!"));
+		}
+
+		void* pMapped = mmap(NULL, (size_t)fileStat.st_size, PROT_READ, MAP_SHARED, this->fileDescriptor, 0);
+		if (pMapped == MAP_FAILED)
+		{
+			Close();
+			throw(std::runtime_error("Unable to map file!"));
+		}
+		this->pData = (const char*)pMapped;
+		this->length = (size_t)fileStat.st_size;
+#endif
+	}
+}
@@ -0,0 +1,48 @@
+// MappedFile.h
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+namespace LxpStd
+{
+	// This class maps a whole file into memory (read only). Pages are loaded
+	// by the OS on demand and are shared with all the other processes that
+	// map the same file. The mapping stays valid until Close is called or
+	// the object is destroyed.
+
+	class MappedFile
+	{
+	public:
+		// Existence
+		MappedFile();
+		~MappedFile();
+
+		// Methods
+		void	Open(const std::string& fileName);	// maps the whole file
+		void	Close();
+
+		// Access
+		const char*	Data() const;		// NULL if not open
+		size_t		Length() const;
+		bool		IsOpen() const;
+
+	private:
+		// Not Implemented (copy constructor and equal operator)
+		MappedFile(const MappedFile& mappedFile);
+		MappedFile& operator=(const MappedFile& mappedFile);
+
+		// Data
+		const char*	pData;
+		size_t		length;
+#ifdef _WIN32
+		void*		fileHandle;
+		void*		mappingHandle;
+#else
+		int			fileDescriptor;
+#endif
+	};
+}
+#endif // !MAPPED_FILE_H
@@ -0,0 +1,453 @@
+#include "pch.h"
+#include "MoveGenerator.h"
+
+#include <assert.h>
+#include <cctype>
+#include <cstring>
+#include <stdexcept>
+
+using namespace std;
+
+namespace LxpStd
+{
+	// CONSTRUCTOR
+	MoveGenerator::MoveGenerator(const Dawg& dawg) : dawg(dawg)
+	{
+		this->pBoard = NULL;
+		this->pCallback = NULL;
+		memset(this->letterCounts, 0, sizeof(this->letterCounts));
+		this->numBlanks = 0;
+		this->numRackTiles = 0;
+		this->isAcross = true;
+		this->line = 0;
+		this->anchorPos = 0;
+		this->startPos = 0;
+		this->numTilesPlaced = 0;
+	}
+
+	// DESTRUCTOR
+	MoveGenerator::~MoveGenerator()
+	{
+	}
+
+	// EXTEND LEFT
+	// reverseNodeId is the node of the letter at startPos (in the reverse part words)
+	unsigned int MoveGenerator::ExtendLeft(unsigned int reverseNodeId, int startPos)
+	{
+		unsigned int numMoves = 0;
+		const DawgNode reverseNode = this->dawg.GetNode(reverseNodeId);
+
+		// the word can start here if there is no tile before it
+		if (reverseNode.isTerminal == TRUE && (startPos == 0 || GetLineTile(this->line, startPos - 1) == Board::EMPTY_SQUARE))
+		{
+			// continue with the forward word node of the letters up to the anchor
+			unsigned int nodeId = WalkFragment(this->dawg.GetNode(Dawg::FORWARD_WORD_NODE_ID).childNodeId,
+											   &(this->lineLetters[startPos]), this->anchorPos - startPos + 1);
+			if (nodeId != 0)
+			{
+				this->startPos = startPos;
+				numMoves += ExtendRight(nodeId, this->anchorPos + 1);
+			}
+		}
+
+		// extend further to the left
+		if (startPos == 0 || reverseNode.childNodeId == 0)
+			return numMoves;
+
+		int pos = startPos - 1;
+		char tile = GetLineTile(this->line, pos);
+		if (tile != Board::EMPTY_SQUARE)
+		{
+			unsigned int childNodeId = FindChildNode(reverseNode.childNodeId, (char)toupper((unsigned char)tile));
+			if (childNodeId != 0)
+			{
+				PlaceBoardTile(pos);
+				numMoves += ExtendLeft(childNodeId, pos);
+			}
+		}
+		else if (!this->isAnchor[this->line][pos])
+		{
+			// the left part only covers squares that are not anchors (the move is generated from the leftmost anchor)
+			numMoves += PlaceFromRack(reverseNode.childNodeId, pos, true);
+		}
+
+		return numMoves;
+	}
+
+	// EXTEND RIGHT
+	// nodeId is the node of the letter at pos - 1 (in the forward words)
+	unsigned int MoveGenerator::ExtendRight(unsigned int nodeId, int pos)
+	{
+		unsigned int numMoves = 0;
+		const DawgNode node = this->dawg.GetNode(nodeId);
+
+		// tiles on the board must be part of the word
+		if (pos < Board::SIZE)
+		{
+			char tile = GetLineTile(this->line, pos);
+			if (tile != Board::EMPTY_SQUARE)
+			{
+				unsigned int childNodeId = FindChildNode(node.childNodeId, (char)toupper((unsigned char)tile));
+				if (childNodeId == 0)
+					return numMoves;
+
+				PlaceBoardTile(pos);
+				return ExtendRight(childNodeId, pos + 1);
+			}
+		}
+
+		// the word can end here
+		if (node.isTerminal == TRUE)
+			numMoves += RecordMove(pos - 1);
+
+		// extend further to the right
+		if (pos < Board::SIZE && node.childNodeId != 0)
+			numMoves += PlaceFromRack(node.childNodeId, pos, false);
+
+		return numMoves;
+	}
+
+	// FIND CHILD NODE
+	// *** To be called for first child only ***
+	unsigned int MoveGenerator::FindChildNode(unsigned int nodeId, char letter) const
+	{
+		if (nodeId == 0)
+			return 0;
+
+		do
+		{
+			if (this->dawg.GetNode(nodeId).letter == letter)
+				return nodeId;
+		} while (this->dawg.GetNode(nodeId++).isLastChild != TRUE);
+
+		return 0;
+	}
+
+	// GENERATE LINE
+	unsigned int MoveGenerator::GenerateLine(int line)
+	{
+		unsigned int numMoves = 0;
+		this->line = line;
+
+		for (int pos = 0; pos < Board::SIZE; pos++)
+		{
+			if (!this->isAnchor[line][pos])
+				continue;
+
+			// the letter on the anchor is the first letter of the reverse part word
+			this->anchorPos = pos;
+			numMoves += PlaceFromRack(this->dawg.GetNode(Dawg::REVERSE_PARTWORD_NODE_ID).childNodeId, pos, true);
+		}
+
+		return numMoves;
+	}
+
+	// GENERATE MOVES
+	unsigned int MoveGenerator::GenerateMoves(const Board& board, const string& rack, const MoveCallback& callback)
+	{
+		assert(this->dawg.IsLoaded());
+
+		if (rack.length() > MoveGenerator::RACK_SIZE)
+			throw(std::runtime_error("Rack has too many tiles!"));
+
+		// count the tiles
+		memset(this->letterCounts, 0, sizeof(this->letterCounts));
+		this->numBlanks = 0;
+		for (unsigned int idx = 0; idx < rack.length(); idx++)
+		{
+			char tile = (char)toupper((unsigned char)rack[idx]);
+			if (tile == Dawg::WILDCARD_CHAR)
+				this->numBlanks++;
+			else if (tile >= Dawg::START_LETTER && tile <= Dawg::END_LETTER)
+				this->letterCounts[tile - Dawg::START_LETTER]++;
+			else
+				throw(std::runtime_error("Invalid tile in rack!"));
+		}
+
+		this->numRackTiles = rack.length();
+		this->numTilesPlaced = 0;
+		this->pBoard = &board;
+		this->pCallback = &callback;
+
+		// across moves, then down moves on the transposed board
+		unsigned int numMoves = 0;
+		if (this->numRackTiles > 0)
+		{
+			for (int direction = 0; direction < 2; direction++)
+			{
+				PrepareDirection(direction == 0);
+				for (int line = 0; line < Board::SIZE; line++)
+					numMoves += GenerateLine(line);
+			}
+		}
+
+		this->pBoard = NULL;
+		this->pCallback = NULL;
+		return numMoves;
+	}
+
+	// GET CROSS CHECK
+	// letters that form a word with the tiles before and after the square in the
+	// perpendicular direction (crossScore is the score of those tiles)
+	unsigned int MoveGenerator::GetCrossCheck(int line, int pos, int& crossScore) const
+	{
+		int firstLine = line;
+		while (firstLine > 0 && GetLineTile(firstLine - 1, pos) != Board::EMPTY_SQUARE)
+			firstLine--;
+
+		int lastLine = line;
+		while (lastLine < Board::SIZE - 1 && GetLineTile(lastLine + 1, pos) != Board::EMPTY_SQUARE)
+			lastLine++;
+
+		// no tiles before or after, any letter will do
+		if (firstLine == line && lastLine == line)
+		{
+			crossScore = MoveGenerator::NO_CROSS_WORD;
+			return MoveGenerator::ALL_LETTERS_MASK;
+		}
+
+		char beforeLetters[Board::SIZE];
+		char afterLetters[Board::SIZE];
+		int numBeforeLetters = 0;
+		int numAfterLetters = 0;
+		crossScore = 0;
+		for (int crossLine = firstLine; crossLine <= lastLine; crossLine++)
+		{
+			if (crossLine == line)
+				continue;
+
+			char tile = GetLineTile(crossLine, pos);
+			crossScore += Board::GetTileScore(tile);
+			if (crossLine < line)
+				beforeLetters[numBeforeLetters++] = (char)toupper((unsigned char)tile);
+			else
+				afterLetters[numAfterLetters++] = (char)toupper((unsigned char)tile);
+		}
+
+		// sibling list of the letters that can follow the tiles before
+		unsigned int nodeId = this->dawg.GetNode(Dawg::FORWARD_WORD_NODE_ID).childNodeId;
+		if (numBeforeLetters > 0)
+		{
+			nodeId = WalkFragment(nodeId, beforeLetters, numBeforeLetters);
+			if (nodeId == 0)
+				return 0;
+			nodeId = this->dawg.GetNode(nodeId).childNodeId;
+		}
+
+		if (nodeId == 0)
+			return 0;
+
+		// the tiles after must complete the word
+		unsigned int crossCheck = 0;
+		do
+		{
+			const DawgNode node = this->dawg.GetNode(nodeId);
+			bool isWord;
+			if (numAfterLetters == 0)
+				isWord = node.isTerminal == TRUE;
+			else
+			{
+				unsigned int lastNodeId = WalkFragment(node.childNodeId, afterLetters, numAfterLetters);
+				isWord = lastNodeId != 0 && this->dawg.GetNode(lastNodeId).isTerminal == TRUE;
+			}
+
+			if (isWord)
+				crossCheck |= 1U << (node.letter - Dawg::START_LETTER);
+		} while (this->dawg.GetNode(nodeId++).isLastChild != TRUE);
+
+		return crossCheck;
+	}
+
+	// GET LINE TILE
+	char MoveGenerator::GetLineTile(int line, int pos) const
+	{
+		return this->isAcross ? this->pBoard->GetTile(line, pos) : this->pBoard->GetTile(pos, line);
+	}
+
+	// PLACE BOARD TILE
+	// the tile already on the board is part of the move
+	void MoveGenerator::PlaceBoardTile(int pos)
+	{
+		char tile = GetLineTile(this->line, pos);
+		this->lineLetters[pos] = (char)toupper((unsigned char)tile);
+		this->isBlank[pos] = tile != this->lineLetters[pos];
+		this->isPlaced[pos] = false;
+	}
+
+	// PLACE FROM RACK
+	// *** To be called for first child only ***
+	// Tries each letter of the sibling list on the (empty) square at pos, using a tile for
+	// it and/or a blank (the scores differ). Then continues to the left or to the right.
+	unsigned int MoveGenerator::PlaceFromRack(unsigned int nodeId, int pos, bool isLeft)
+	{
+		unsigned int numMoves = 0;
+		if (nodeId == 0 || this->numTilesPlaced == this->numRackTiles)
+			return numMoves;
+
+		unsigned int crossCheck = this->crossChecks[this->line][pos];
+		do
+		{
+			const DawgNode node = this->dawg.GetNode(nodeId);
+			int letterIdx = node.letter - Dawg::START_LETTER;
+			if ((crossCheck & (1U << letterIdx)) == 0)
+				continue;
+
+			for (int useBlank = 0; useBlank < 2; useBlank++)
+			{
+				// take the tile from the rack
+				if (useBlank == 0)
+				{
+					if (this->letterCounts[letterIdx] == 0)
+						continue;
+					this->letterCounts[letterIdx]--;
+				}
+				else
+				{
+					if (this->numBlanks == 0)
+						continue;
+					this->numBlanks--;
+				}
+
+				this->lineLetters[pos] = (char)node.letter;
+				this->isBlank[pos] = useBlank != 0;
+				this->isPlaced[pos] = true;
+				this->numTilesPlaced++;
+
+				if (isLeft)
+					numMoves += ExtendLeft(nodeId, pos);
+				else
+					numMoves += ExtendRight(nodeId, pos + 1);
+
+				// put the tile back
+				this->numTilesPlaced--;
+				if (useBlank == 0)
+					this->letterCounts[letterIdx]++;
+				else
+					this->numBlanks++;
+			}
+		} while (this->dawg.GetNode(nodeId++).isLastChild != TRUE);
+
+		return numMoves;
+	}
+
+	// PREPARE DIRECTION
+	// anchors and cross-checks of all the squares for the direction
+	void MoveGenerator::PrepareDirection(bool isAcross)
+	{
+		this->isAcross = isAcross;
+		bool isBoardEmpty = this->pBoard->IsEmpty();
+
+		for (int line = 0; line < Board::SIZE; line++)
+		{
+			for (int pos = 0; pos < Board::SIZE; pos++)
+			{
+				this->crossChecks[line][pos] = 0;
+				this->crossScores[line][pos] = MoveGenerator::NO_CROSS_WORD;
+				this->isAnchor[line][pos] = false;
+
+				if (GetLineTile(line, pos) != Board::EMPTY_SQUARE)
+					continue;
+
+				// first move must cover the center square
+				if (isBoardEmpty)
+				{
+					this->crossChecks[line][pos] = MoveGenerator::ALL_LETTERS_MASK;
+					this->isAnchor[line][pos] = line == Board::CENTER && pos == Board::CENTER;
+					continue;
+				}
+
+				this->isAnchor[line][pos] =
+					(line > 0 && GetLineTile(line - 1, pos) != Board::EMPTY_SQUARE) ||
+					(line < Board::SIZE - 1 && GetLineTile(line + 1, pos) != Board::EMPTY_SQUARE) ||
+					(pos > 0 && GetLineTile(line, pos - 1) != Board::EMPTY_SQUARE) ||
+					(pos < Board::SIZE - 1 && GetLineTile(line, pos + 1) != Board::EMPTY_SQUARE);
+
+				this->crossChecks[line][pos] = GetCrossCheck(line, pos, this->crossScores[line][pos]);
+			}
+		}
+	}
+
+	// RECORD MOVE
+	// scores the move from startPos to endPos and calls back
+	unsigned int MoveGenerator::RecordMove(int endPos)
+	{
+		int length = endPos - this->startPos + 1;
+		if (length < 2)
+			return 0;	// one letter is not a word
+
+		// a single tile forming words in both directions is generated as an across move only
+		if (!this->isAcross && this->numTilesPlaced == 1)
+		{
+			for (int pos = this->startPos; pos <= endPos; pos++)
+			{
+				if (this->isPlaced[pos] && this->crossScores[this->line][pos] != MoveGenerator::NO_CROSS_WORD)
+					return 0;
+			}
+		}
+
+		int wordScore = 0;
+		int wordMultiplier = 1;
+		int crossWordsScore = 0;
+		this->move.placedMask = 0;
+		for (int pos = this->startPos; pos <= endPos; pos++)
+		{
+			int idx = pos - this->startPos;
+			int tileScore = this->isBlank[pos] ? 0 : Board::GetTileScore(this->lineLetters[pos]);
+			this->move.word[idx] = this->isBlank[pos] ? (char)tolower((unsigned char)this->lineLetters[pos]) : this->lineLetters[pos];
+
+			// premium squares only count for the tiles placed
+			if (!this->isPlaced[pos])
+			{
+				wordScore += tileScore;
+				continue;
+			}
+
+			PremiumSquare premiumSquare = this->isAcross ? this->pBoard->GetPremiumSquare(this->line, pos)
+														 : this->pBoard->GetPremiumSquare(pos, this->line);
+			int letterScore = tileScore * Board::GetLetterMultiplier(premiumSquare);
+			int squareWordMultiplier = Board::GetWordMultiplier(premiumSquare);
+
+			wordScore += letterScore;
+			wordMultiplier *= squareWordMultiplier;
+			if (this->crossScores[this->line][pos] != MoveGenerator::NO_CROSS_WORD)
+				crossWordsScore += (this->crossScores[this->line][pos] + letterScore) * squareWordMultiplier;
+
+			this->move.placedMask |= 1U << idx;
+		}
+
+		this->move.word[length] = '\0';
+		this->move.row = this->isAcross ? this->line : this->startPos;
+		this->move.col = this->isAcross ? this->startPos : this->line;
+		this->move.isAcross = this->isAcross;
+		this->move.numTilesPlaced = this->numTilesPlaced;
+		this->move.score = wordScore * wordMultiplier + crossWordsScore;
+		if (this->numTilesPlaced == MoveGenerator::RACK_SIZE)
+			this->move.score += MoveGenerator::BINGO_BONUS;
+
+		(*this->pCallback)(this->move);
+		return 1;
+	}
+
+	// WALK FRAGMENT
+	// *** To be called for first child only ***
+	unsigned int MoveGenerator::WalkFragment(unsigned int nodeId, const char* pLetters, int length) const
+	{
+		if (length == 0)
+			return 0;
+
+		for (int idx = 0; idx < length; idx++)
+		{
+			nodeId = FindChildNode(nodeId, pLetters[idx]);
+			if (nodeId == 0)
+				return 0;
+
+			// last letter is the node we are looking for
+			if (idx == length - 1)
+				return nodeId;
+
+			nodeId = this->dawg.GetNode(nodeId).childNodeId;
+		}
+
+		return 0;
+	}
+};
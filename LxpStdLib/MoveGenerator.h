@@ -0,0 +1,97 @@
+// MoveGenerator.h
+
+#ifndef MOVE_GENERATOR_H
+#define MOVE_GENERATOR_H
+
+#include "Board.h"
+#include "Dawg.h"
+
+#include <functional>
+#include <string>
+
+namespace LxpStd
+{
+	// MoveGenerator enumerates all the legal plays of a rack on a board (Appel & Jacobson).
+	// Every play covers an anchor: an empty square next to a tile (or the center square
+	// on an empty board). A play is generated once from the leftmost anchor it covers:
+	// - the part of the word up to the anchor is grown right to left from the anchor using
+	//   the reverse part words, only over empty squares that are not anchors (or over the
+	//   tiles already on the board, left of the anchor)
+	// - where the reverse part word is terminal (i.e. a word may start there), the rest of
+	//   the word is grown left to right using the forward words
+	// Letters placed must be allowed by the cross-checks of the square, i.e. they must form
+	// a word with the tiles above and below it. Down plays are generated the same way on
+	// the transposed board.
+	//
+	// Generation works on the Dawg nodes directly and all the working state is kept in
+	// fixed size members, so no memory is allocated while generating moves.
+
+	class MoveGenerator
+	{
+	public:
+		// common constants
+		static const int	RACK_SIZE = 7;
+		static const int	BINGO_BONUS = 50;	// for using all RACK_SIZE tiles
+
+		// Called for each move found. move is only valid for the duration of the call.
+		typedef std::function<void(const Move& move)>	MoveCallback;
+
+		// Existence
+		MoveGenerator(const Dawg& dawg);	// dawg must be initialized and outlive the generator
+		~MoveGenerator();
+
+		// Methods
+		unsigned int	GenerateMoves(const Board& board, const std::string& rack, const MoveCallback& callback);
+											// rack tiles are letters (Dawg::WILDCARD_CHAR is a blank); returns the number of moves
+
+	private:
+		static const unsigned int	ALL_LETTERS_MASK = (1U << (Dawg::END_LETTER - Dawg::START_LETTER + 1)) - 1;
+		static const int			NO_CROSS_WORD = -1;
+
+		// Implementation
+		unsigned int	ExtendLeft(unsigned int reverseNodeId, int startPos);
+		unsigned int	ExtendRight(unsigned int nodeId, int pos);
+		unsigned int	FindChildNode(unsigned int nodeId, char letter) const;	// in the sibling list (0 if not found)
+		unsigned int	GenerateLine(int line);
+		unsigned int	GetCrossCheck(int line, int pos, int& crossScore) const;
+		char			GetLineTile(int line, int pos) const;	// tile in the current direction
+		void			PlaceBoardTile(int pos);
+		unsigned int	PlaceFromRack(unsigned int nodeId, int pos, bool isLeft);
+		void			PrepareDirection(bool isAcross);
+		unsigned int	RecordMove(int endPos);
+		unsigned int	WalkFragment(unsigned int nodeId, const char* pLetters, int length) const;
+																// node of the last letter (0 if not found)
+
+		// Not Implemented
+		MoveGenerator(const MoveGenerator& moveGenerator);
+		MoveGenerator& operator=(const MoveGenerator& moveGenerator);
+
+		// Data
+		const Dawg&				dawg;
+		const Board*			pBoard;
+		const MoveCallback*		pCallback;
+
+		// rack
+		unsigned char			letterCounts[Dawg::END_LETTER - Dawg::START_LETTER + 1];
+		unsigned int			numBlanks;
+		unsigned int			numRackTiles;
+
+		// current direction (squares are addressed by line and position in the line)
+		bool					isAcross;
+		unsigned int			crossChecks[Board::SIZE][Board::SIZE];	// letters allowed (bit per letter)
+		int						crossScores[Board::SIZE][Board::SIZE];	// of the tiles in the cross word (or NO_CROSS_WORD)
+		bool					isAnchor[Board::SIZE][Board::SIZE];
+
+		// current move
+		int						line;
+		int						anchorPos;
+		int						startPos;
+		char					lineLetters[Board::SIZE];	// letters of the move by position (upper case)
+		bool					isBlank[Board::SIZE];
+		bool					isPlaced[Board::SIZE];
+		unsigned int			numTilesPlaced;
+		Move					move;
+	};
+}
+
+#endif // !MOVE_GENERATOR_H
@@ -0,0 +1,90 @@
+#include "pch.h"
+#include "PackedDawgNodes.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace LxpStd
+{
+	// CONSTRUCTOR
+	PackedDawgNodes::PackedDawgNodes()
+	{
+		this->pBits = NULL;
+		Clear();
+	}
+
+	// DESTRUCTOR
+	PackedDawgNodes::~PackedDawgNodes()
+	{
+		Clear();
+	}
+
+	// CLEAR
+	void PackedDawgNodes::Clear()
+	{
+		delete[] this->pBits;
+		this->pBits = NULL;
+		this->size = 0;
+		this->numNodes = 0;
+		this->bitsPerNode = 0;
+		this->nodeMask = 0;
+		this->numLetters = 0;
+		memset(this->letters, '\0', sizeof(this->letters));
+		memset(this->letterCodes, PackedDawgNodes::NO_LETTER_CODE, sizeof(this->letterCodes));
+	}
+
+	// INITIALIZE
+	void PackedDawgNodes::Initialize(unsigned int numNodes)
+	{
+		Clear();
+
+		// bits for the largest child id (numNodes - 1)
+		unsigned int childNodeIdBits = 1;
+		while (childNodeIdBits < 32 && (numNodes - 1) >> childNodeIdBits != 0)
+			childNodeIdBits++;
+
+		this->numNodes = numNodes;
+		this->bitsPerNode = PackedDawgNodes::CHILD_NODE_ID_SHIFT + childNodeIdBits;
+		this->nodeMask = (1ULL << this->bitsPerNode) - 1;
+		this->size = (size_t)(((unsigned long long)numNodes * this->bitsPerNode + 7) / 8) + PackedDawgNodes::PADDING_SIZE;
+		this->pBits = new unsigned char[this->size];
+		memset(this->pBits, 0, this->size);
+	}
+
+	// SET NODE
+	// letters get codes in the order they are first seen
+	void PackedDawgNodes::SetNode(unsigned int nodeId, const DawgNode& node)
+	{
+		if (nodeId >= this->numNodes || node.childNodeId >= this->numNodes)
+			throw(std::runtime_error("Node id is out of range! Bug or file corruption?"));
+
+		unsigned char& letterCode = this->letterCodes[(unsigned char)node.letter];
+		if (letterCode == PackedDawgNodes::NO_LETTER_CODE)
+		{
+			if (this->numLetters == PackedDawgNodes::MAX_LETTERS)
+				throw(std::runtime_error("Too many different letters to pack the nodes!"));
+
+			letterCode = (unsigned char)this->numLetters;
+			this->letters[this->numLetters++] = node.letter;
+		}
+
+		unsigned long long bits = (unsigned long long)letterCode |
+								  ((unsigned long long)(node.isTerminal ? 1 : 0) << PackedDawgNodes::TERMINAL_SHIFT) |
+								  ((unsigned long long)(node.isLastChild ? 1 : 0) << PackedDawgNodes::LAST_CHILD_SHIFT) |
+								  ((unsigned long long)node.childNodeId << PackedDawgNodes::CHILD_NODE_ID_SHIFT);
+
+		// the record shares its first and last bytes with its neighbours
+		unsigned long long bitIdx = (unsigned long long)nodeId * this->bitsPerNode;
+		unsigned char* pBytes = this->pBits + (size_t)(bitIdx >> 3);
+		unsigned int shift = (unsigned int)(bitIdx & 7);
+		unsigned long long value = LoadUInt64(pBytes) & ~(this->nodeMask << shift);
+		StoreUInt64(value | (bits << shift), pBytes);
+	}
+
+	// STORE UINT 64
+	void PackedDawgNodes::StoreUInt64(unsigned long long value, unsigned char* pBytes)
+	{
+		for (int idx = 0; idx < 8; idx++)
+			pBytes[idx] = (unsigned char)((value >> (idx * 8)) & 0xFF);
+	}
+}
@@ -0,0 +1,112 @@
+// PackedDawgNodes.h
+
+#ifndef PACKED_DAWG_NODES_H
+#define PACKED_DAWG_NODES_H
+
+#include "DawgFile.h"
+
+#include <cstddef>
+
+namespace LxpStd
+{
+	// The nodes of a Dawg in as few bits as they need, for keeping many Dawgs in memory.
+	// A DawgNode takes 8 bytes, but its letter is one of a few letters, its flags are one
+	// bit each and its child id never needs more bits than the number of nodes does. Each
+	// node is packed into a record of
+	//
+	//		LETTER_CODE_BITS	index of the letter in a table of the letters used
+	//		1					isTerminal
+	//		1					isLastChild
+	//		childNodeIdBits		just enough for numNodes - 1
+	//
+	// and the records follow each other in a bit stream (little endian, without padding),
+	// e.g. 30 bits per node for 4M nodes. As the records have the same width, node N is at
+	// bit N * bitsPerNode and is read directly (one unaligned load, a shift and a mask), so
+	// the packed nodes are queried as they are, without unpacking them first.
+	//
+	// The nodes are set once, in any order, after Initialize.
+
+	class PackedDawgNodes
+	{
+	public:
+		// constants
+		static const unsigned int	LETTER_CODE_BITS = 5;
+		static const unsigned int	MAX_LETTERS = 1 << LETTER_CODE_BITS;	// different letters in a Dawg
+
+		// Existence
+		PackedDawgNodes();
+		~PackedDawgNodes();
+		void	Initialize(unsigned int numNodes);	// all nodes zero (deletes existing nodes)
+
+		// Methods
+		void	Clear();
+		void	SetNode(unsigned int nodeId, const DawgNode& node);	// throws if the node doesn't fit (see above)
+
+		// Access
+		DawgNode		GetNode(unsigned int nodeId) const;
+		const void*		GetNodeAddress(unsigned int nodeId) const;	// of the first byte of the node (for prefetching)
+		bool			IsEmpty() const			{ return this->pBits == NULL; }
+
+		// Diagnostics
+		unsigned int	GetBitsPerNode() const	{ return this->bitsPerNode; }
+		size_t			GetSize() const			{ return this->size; }	// bytes
+
+	private:
+		// constants
+		static const unsigned int	TERMINAL_SHIFT = LETTER_CODE_BITS;
+		static const unsigned int	LAST_CHILD_SHIFT = LETTER_CODE_BITS + 1;
+		static const unsigned int	CHILD_NODE_ID_SHIFT = LETTER_CODE_BITS + 2;
+		static const unsigned char	NO_LETTER_CODE = 0xFF;
+		static const unsigned int	PADDING_SIZE = 8;	// so that a node is always read with one 8 byte load
+
+		// Implementation
+		static unsigned long long	LoadUInt64(const unsigned char* pBytes);	// little endian
+		static void					StoreUInt64(unsigned long long value, unsigned char* pBytes);
+
+		// Not Implemented
+		PackedDawgNodes(const PackedDawgNodes& packedDawgNodes);
+		PackedDawgNodes& operator=(const PackedDawgNodes& packedDawgNodes);
+
+		// Data
+		unsigned char*		pBits;
+		size_t				size;
+		unsigned int		numNodes;
+		unsigned int		bitsPerNode;
+		unsigned long long	nodeMask;		// bitsPerNode ones
+		unsigned int		numLetters;
+		char				letters[MAX_LETTERS];	// by letter code
+		unsigned char		letterCodes[256];		// by letter (NO_LETTER_CODE if not used yet)
+	};
+
+	// GET NODE
+	inline DawgNode PackedDawgNodes::GetNode(unsigned int nodeId) const
+	{
+		unsigned long long bitIdx = (unsigned long long)nodeId * this->bitsPerNode;
+		unsigned long long bits = (LoadUInt64(this->pBits + (size_t)(bitIdx >> 3)) >> (bitIdx & 7)) & this->nodeMask;
+
+		DawgNode node;
+		node.childNodeId = (unsigned int)(bits >> PackedDawgNodes::CHILD_NODE_ID_SHIFT);
+		node.letter = this->letters[bits & (PackedDawgNodes::MAX_LETTERS - 1)];
+		node.isTerminal = (unsigned char)((bits >> PackedDawgNodes::TERMINAL_SHIFT) & 1);
+		node.isLastChild = (unsigned char)((bits >> PackedDawgNodes::LAST_CHILD_SHIFT) & 1);
+		node.reserved = 0;
+		return node;
+	}
+
+	// GET NODE ADDRESS
+	inline const void* PackedDawgNodes::GetNodeAddress(unsigned int nodeId) const
+	{
+		return this->pBits + (size_t)(((unsigned long long)nodeId * this->bitsPerNode) >> 3);
+	}
+
+	// LOAD UINT 64
+	// (compilers turn this into a single load on little endian machines)
+	inline unsigned long long PackedDawgNodes::LoadUInt64(const unsigned char* pBytes)
+	{
+		return (unsigned long long)pBytes[0] | ((unsigned long long)pBytes[1] << 8) |
+			   ((unsigned long long)pBytes[2] << 16) | ((unsigned long long)pBytes[3] << 24) |
+			   ((unsigned long long)pBytes[4] << 32) | ((unsigned long long)pBytes[5] << 40) |
+			   ((unsigned long long)pBytes[6] << 48) | ((unsigned long long)pBytes[7] << 56);
+	}
+}
+#endif // !PACKED_DAWG_NODES_H
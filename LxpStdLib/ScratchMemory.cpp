@@ -0,0 +1,38 @@
+#include "pch.h"
+#include "ScratchMemory.h"
+
+namespace LxpStd
+{
+	// CONSTRUCTOR
+	ScratchMemory::ScratchMemory() :
+		blockMemory(ScratchMemory::GetThreadBlockMemory())
+	{
+		this->blockMemory.GetMark(this->mark);
+	}
+
+	// DESTRUCTOR
+	ScratchMemory::~ScratchMemory()
+	{
+		Release();
+	}
+
+	// GET THREAD BLOCK MEMORY
+	// created on the first use by the thread and freed when the thread exits
+	BlockMemory& ScratchMemory::GetThreadBlockMemory()
+	{
+		static thread_local BlockMemory threadBlockMemory(ScratchMemory::BLOCK_SIZE);
+		return threadBlockMemory;
+	}
+
+	// GET THREAD STATS
+	void ScratchMemory::GetThreadStats(BlockMemoryStats& stats)
+	{
+		ScratchMemory::GetThreadBlockMemory().GetStats(stats);
+	}
+
+	// RELEASE
+	void ScratchMemory::Release()
+	{
+		this->blockMemory.Release(this->mark);
+	}
+}
@@ -0,0 +1,56 @@
+// ScratchMemory.h
+
+#ifndef SCRATCH_MEMORY_H
+#define SCRATCH_MEMORY_H
+
+#include "BlockMemory.h"
+
+namespace LxpStd
+{
+	// Memory for the temporary buffers of a query (or of any request). Every thread has its
+	// own BlockMemory (its scratch arena), so allocating never takes a lock or goes to the
+	// heap once the arena has grown to what the queries of the thread need.
+	//
+	// A ScratchMemory marks the arena of its thread when constructed and releases back to the
+	// mark when destroyed, freeing everything allocated through it at once. It is meant to be
+	// a local variable: the ScratchMemory objects of a thread must be destroyed in the reverse
+	// order of their construction (as they are on the stack), and only the latest one of a
+	// thread should be allocated from. A query called from the callback of another query gets
+	// its own ScratchMemory above the one of the caller.
+	//
+	// The Dawg queries keep the words they build in scratch memory.
+
+	class ScratchMemory
+	{
+	public:
+		// constants
+		static const unsigned int	BLOCK_SIZE = 64 * 1024;
+
+		// Existence
+		ScratchMemory();
+		~ScratchMemory();
+
+		// Methods
+		void*	Allocate(unsigned int size, unsigned int alignment = 1)	{ return this->blockMemory.Allocate(size, alignment); }
+		template <typename T>
+		T*		Allocate(unsigned int count)							{ return this->blockMemory.Allocate<T>(count); }
+		void	Release();		// frees what was allocated so far (the ScratchMemory can still be used)
+
+		// Diagnostics
+		static void	GetThreadStats(BlockMemoryStats& stats);	// of the scratch arena of the calling thread
+
+	private:
+		// Implementation
+		static BlockMemory&	GetThreadBlockMemory();
+
+		// Not Implemented
+		ScratchMemory(const ScratchMemory& scratchMemory);
+		ScratchMemory& operator=(const ScratchMemory& scratchMemory);
+
+		// Data
+		BlockMemory&		blockMemory;	// of the thread
+		BlockMemoryMark		mark;
+	};
+}
+
+#endif // !SCRATCH_MEMORY_H
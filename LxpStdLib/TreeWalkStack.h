@@ -0,0 +1,70 @@
+// TreeWalkStack.h
+
+#ifndef TREE_WALK_STACK_H
+#define TREE_WALK_STACK_H
+
+#include <assert.h>
+#include <vector>
+
+namespace LxpStd
+{
+	// Stack of the depth first walks of the trees (Trie, Dawg and DawgBuilder), which loop
+	// with it instead of calling themselves for the first child and the next sibling. A walk
+	// keeps one entry per level of the tree (the sibling to go on with once the subtree below
+	// is done), so the stack is as deep as the longest word and not as long as the sibling
+	// lists. The entries are kept in the stack object itself (a local variable of the walk)
+	// up to CAPACITY; deeper trees (words longer than Dawg::MAX_WORD_LENGTH) go on to the
+	// heap. Walks don't need a large thread stack and don't allocate.
+
+	template <typename T, unsigned int CAPACITY = 80>
+	class TreeWalkStack
+	{
+	public:
+		// Existence
+		TreeWalkStack() : size(0) {}
+
+		// Methods
+		void	Push(const T& item);
+		T		Pop();
+
+		// Access
+		bool	IsEmpty() const		{ return this->size == 0; }
+		T&		Top()				{ assert(this->size > 0); return this->size <= CAPACITY ? this->items[this->size - 1] : this->overflowItems.back(); }
+
+	private:
+		// Not Implemented
+		TreeWalkStack(const TreeWalkStack& treeWalkStack);
+		TreeWalkStack& operator=(const TreeWalkStack& treeWalkStack);
+
+		// Data
+		T				items[CAPACITY];
+		std::vector<T>	overflowItems;	// the ones after CAPACITY
+		unsigned int	size;
+	};
+
+	// POP
+	template <typename T, unsigned int CAPACITY>
+	T TreeWalkStack<T, CAPACITY>::Pop()
+	{
+		assert(this->size > 0);
+		if (this->size-- <= CAPACITY)
+			return this->items[this->size];
+
+		T item = this->overflowItems.back();
+		this->overflowItems.pop_back();
+		return item;
+	}
+
+	// PUSH
+	template <typename T, unsigned int CAPACITY>
+	void TreeWalkStack<T, CAPACITY>::Push(const T& item)
+	{
+		if (this->size < CAPACITY)
+			this->items[this->size] = item;
+		else
+			this->overflowItems.push_back(item);
+		this->size++;
+	}
+}
+
+#endif // !TREE_WALK_STACK_H
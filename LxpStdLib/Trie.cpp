@@ -3,8 +3,14 @@
 #include "LxpStdLib.h"
 #include "Dawg.h"
 
+#include <algorithm>
 #include <assert.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
 #include <string>
+#include <thread>
 
 using namespace std;
 
@@ -12,7 +18,7 @@ namespace LxpStd
 {
 	// CONSTRUCTOR
 	Trie::Trie() :
-		blockMemory(65536)	// getting 64K memory blocks
+		siblingListRegister(0, SiblingListHash{ this }, SiblingListEqual{ this })
 	{
 		this->diagnostics.numNodes = 0;
 		this->diagnostics.numWords = 0;
@@ -24,102 +30,110 @@ namespace LxpStd
 		this->diagnostics.numFirstChildrenBeforeCompression = 0;
 		this->diagnostics.numNodesAfterCompression = 0;
 
+		this->diagnostics.numFinishPasses = 0;
+		this->diagnostics.numberingSeconds = 0.0;
+		this->diagnostics.savingSeconds = 0.0;
+
 		// get the special nodes initialized
-		this->pRootNode = AllocateNewNode();
-		this->pForwardWordNode = AllocateNewNode(this->pRootNode, Dawg::FORWARD_WORD_DAWG_SYMBOL, false);
-		this->pReversePartWordNode = AllocateNewNode(this->pRootNode, Dawg::REVERSE_PARTWORD_DAWG_SYMBOL, false);
+		this->rootNodeId = AllocateNewNode(this->nodePool, this->diagnostics);
+		this->forwardWordNodeId = AllocateNewNode(this->nodePool, this->diagnostics, this->rootNodeId, Dawg::FORWARD_WORD_DAWG_SYMBOL, false);
+		this->reversePartWordNodeId = AllocateNewNode(this->nodePool, this->diagnostics, this->rootNodeId, Dawg::REVERSE_PARTWORD_DAWG_SYMBOL, false);
 
-		this->pRootNode->pFirstChild = this->pForwardWordNode;
-		this->pForwardWordNode->pNextSibling = this->pReversePartWordNode;
+		this->nodePool[this->rootNodeId].firstChildId = this->forwardWordNodeId;
+		this->nodePool[this->forwardWordNodeId].nextSiblingId = this->reversePartWordNodeId;
 
 		// state and rest
 		this->state = TrieState::ADDING_WORDS;
 		this->firstChildrenCompressNodeIdx = 0;
+		this->numDuplicatesRemoved = 0;
+		this->compressStartSeconds = 0.0;
+		this->compressSeconds = 0.0;
+		this->numSaves = 0;
+		this->saveSeconds = 0.0;
 	}
 
 	// DESTRUCTOR
 	Trie::~Trie()
 	{
-		this->blockMemory.DeallocateAll();
+		this->nodePool.DeallocateAll();
 	}
 
 	// ADD CHILD NODE
-	TrieNode* Trie::AddChildNode(
-		TrieNode* pParentNode,
+	// (static, so that the shards of AddWords can use it on their own node pools)
+	unsigned int Trie::AddChildNode(
+		TrieNodePool& nodePool,
+		TrieDiagnostics& diagnostics,
+		unsigned int parentNodeId,
 		char childLetter,
 		bool isWordTerminal)
 	{
 		// validation
-		assert(pParentNode != NULL);
+		assert(parentNodeId != TrieNodePool::NO_NODE);
 		assert(Trie::IsValidLetter(childLetter));
 
 		// increment letter count
-		this->diagnostics.numLetters++;
+		diagnostics.numLetters++;
 
 		// does the parent have a child?
-		if (pParentNode->pFirstChild == NULL)
+		TrieNode& parentNode = nodePool[parentNodeId];
+		if (parentNode.firstChildId == TrieNodePool::NO_NODE)
 		{
-			pParentNode->pFirstChild = AllocateNewNode(pParentNode, childLetter, isWordTerminal);
-			return pParentNode->pFirstChild;
+			parentNode.firstChildId = AllocateNewNode(nodePool, diagnostics, parentNodeId, childLetter, isWordTerminal);
+			return parentNode.firstChildId;
 		}
 
 		// child already present, need to insert in the right place
-		TrieNode* pCurNode = pParentNode->pFirstChild;
-		TrieNode* pPrevSibling = NULL;
-		TrieNode* pNewNode = NULL;
-		while (pCurNode != NULL)
+		unsigned int curNodeId = parentNode.firstChildId;
+		unsigned int prevSiblingId = TrieNodePool::NO_NODE;
+		unsigned int newNodeId = TrieNodePool::NO_NODE;
+		while (curNodeId != TrieNodePool::NO_NODE)
 		{
+			TrieNode& curNode = nodePool[curNodeId];
+
 			// if the letter is already there
-			if (pCurNode->letter == childLetter)
+			if (curNode.letter == childLetter)
 			{
 				if (isWordTerminal)	// true always trumps what is already there
-					pCurNode->isWordTerminal = isWordTerminal;
-				return pCurNode;
+					curNode.isWordTerminal = isWordTerminal;
+				return curNodeId;
 			}
 
 			// is the letter to be inserted before curNode?
-			if (childLetter < pCurNode->letter)
+			if (childLetter < curNode.letter)
 			{
 				// create a new node and set its sibling
-				pNewNode = AllocateNewNode(pParentNode, childLetter, isWordTerminal);
-				pNewNode->pNextSibling = pCurNode;
+				newNodeId = AllocateNewNode(nodePool, diagnostics, parentNodeId, childLetter, isWordTerminal);
+				nodePool[newNodeId].nextSiblingId = curNodeId;
 
 				// need to link the newNode to its previous sibling or
 				// to parent (in the case of this being the first child)
-				if (pPrevSibling == NULL)
-					pParentNode->pFirstChild = pNewNode;
+				if (prevSiblingId == TrieNodePool::NO_NODE)
+					parentNode.firstChildId = newNodeId;
 				else
-					pPrevSibling->pNextSibling = pNewNode;
+					nodePool[prevSiblingId].nextSiblingId = newNodeId;
 
-				return pNewNode;
+				return newNodeId;
 			}
 
 			// advance to next sibling
-			pPrevSibling = pCurNode;
-			pCurNode = pCurNode->pNextSibling;
+			prevSiblingId = curNodeId;
+			curNodeId = curNode.nextSiblingId;
 		}
 
 		// node to be created is the last child, link it to previous sibling
-		assert(pCurNode == NULL);
-		pNewNode = AllocateNewNode(pParentNode, childLetter, isWordTerminal);
-		pPrevSibling->pNextSibling = pNewNode;
-		return pNewNode;
+		assert(curNodeId == TrieNodePool::NO_NODE);
+		newNodeId = AllocateNewNode(nodePool, diagnostics, parentNodeId, childLetter, isWordTerminal);
+		nodePool[prevSiblingId].nextSiblingId = newNodeId;
+		return newNodeId;
 	}
 
-	// ADD WORD
-	void Trie::AddWord(const char* pWord) throw(...)
+	// ADD FORWARD WORD
+	unsigned int Trie::AddForwardWord(const char* pWord)
 	{
-		// validation
-		assert(pWord != NULL);
-		
-		// validate state for addition
-		if (this->state != TrieState::ADDING_WORDS)
-			throw(std::exception("Trie must be in ADDING_WORDS state!"));
-		
 		// initializations
 		const char* pNextChar = pWord;
 		char curChar = *pNextChar++;
-		TrieNode* pCurNode = this->pForwardWordNode;
+		unsigned int curNodeId = this->forwardWordNodeId;
 		bool isWordTerminal = false;
 		unsigned int wordLength = 0;
 		
@@ -132,7 +146,7 @@ namespace LxpStd
 			if (*pNextChar == '\0')
 				isWordTerminal = true;
 
-			pCurNode = AddChildNode(pCurNode, curChar, isWordTerminal);
+			curNodeId = AddChildNode(this->nodePool, this->diagnostics, curNodeId, curChar, isWordTerminal);
 			curChar = *pNextChar++;
 		}
 
@@ -143,228 +157,373 @@ namespace LxpStd
 			this->diagnostics.numWordLetters += wordLength;
 		}
 
-		// add the reversed part word
-		AddReversedPartWords(pWord, wordLength);
+		return wordLength;
 	}
 
-	// ADD REVERSED PART WORDS
-	// For example, if the word is CATS, and the wordLength is 4, the following
-	// part words are added to the reverse part word part of the DAWG:
-	//
-	// STAC
-	// TAC
-	// AC
-	// C
-	void Trie::AddReversedPartWords(const char* pWord, unsigned int wordLength) throw(...)
+	// ADD WORD
+	void Trie::AddWord(const char* pWord)
 	{
 		// validation
 		assert(pWord != NULL);
-		assert(this->state == TrieState::ADDING_WORDS);
+		
+		// validate state for addition
+		if (this->state != TrieState::ADDING_WORDS)
+			throw(std::runtime_error("Trie must be in ADDING_WORDS state!"));
+		
+		unsigned int wordLength = AddForwardWord(pWord);
 
-		// recursion stopper
-		if (wordLength == 0)
+		// add the reversed part word
+		AddReversedPartWords(pWord, wordLength);
+	}
+
+	// ADD WORDS
+	// (see the notes in Trie.h)
+	void Trie::AddWords(const vector<string>& words, unsigned int numThreads)
+	{
+		// validate state for addition
+		if (this->state != TrieState::ADDING_WORDS)
+			throw(std::runtime_error("Trie must be in ADDING_WORDS state!"));
+
+		if (numThreads == 0)
+			numThreads = max(1U, thread::hardware_concurrency());
+
+		// shards can only be linked in under an empty '*' and '<'
+		bool isSharded = numThreads > 1 &&
+			this->nodePool[this->forwardWordNodeId].firstChildId == TrieNodePool::NO_NODE &&
+			this->nodePool[this->reversePartWordNodeId].firstChildId == TrieNodePool::NO_NODE;
+
+		// The reversed part words of each letter, then the words of each first letter, in one
+		// pass over the letters (a letter out of the range would have no shard). The letters
+		// of a shard are the most nodes it can have.
+		const unsigned int numLetters = Dawg::END_LETTER - Dawg::START_LETTER + 1;
+		vector<vector<PartWord>> partWords(isSharded ? numLetters : 0);
+		vector<vector<unsigned int>> wordIdxs(isSharded ? numLetters : 0);
+		vector<size_t> numShardLetters(2 * numLetters, 0);
+		for (unsigned int idx = 0; idx < (unsigned int)words.size(); idx++)
+		{
+			const string& word = words[idx];
+			for (unsigned int letterIdx = 0; letterIdx < (unsigned int)word.length(); letterIdx++)
+			{
+				if (word[letterIdx] < Dawg::START_LETTER || word[letterIdx] > Dawg::END_LETTER)
+					throw(std::runtime_error("Word has an invalid letter!"));
+				if (!isSharded)
+					continue;
+
+				// a reversed part word starts at each letter
+				unsigned int letterNum = word[letterIdx] - Dawg::START_LETTER;
+				partWords[letterNum].push_back(PartWord{ idx, letterIdx + 1 });
+				numShardLetters[letterNum] += letterIdx + 1;
+			}
+
+			if (isSharded && !word.empty())
+			{
+				unsigned int letterNum = word[0] - Dawg::START_LETTER;
+				wordIdxs[letterNum].push_back(idx);
+				numShardLetters[numLetters + letterNum] += word.length();
+			}
+		}
+
+		if (!isSharded)
+		{
+			for (size_t idx = 0; idx < words.size(); idx++)
+				AddWord(words[idx].c_str());
 			return;
+		}
+
+		// the largest shards first, so that the last ones to finish are small
+		vector<unsigned int> shardOrder(2 * numLetters);
+		for (unsigned int shardIdx = 0; shardIdx < shardOrder.size(); shardIdx++)
+			shardOrder[shardIdx] = shardIdx;
+		stable_sort(shardOrder.begin(), shardOrder.end(), [&](unsigned int shardIdx1, unsigned int shardIdx2)
+		{
+			return numShardLetters[shardIdx1] > numShardLetters[shardIdx2];
+		});
+
+		vector<unique_ptr<Shard>> shards(2 * numLetters);	// (none for a letter with no words)
+		atomic<unsigned int> nextOrderIdx(0);
+		RunOnThreads(min(numThreads, (unsigned int)shards.size()), [&](unsigned int)
+		{
+			for (unsigned int orderIdx = nextOrderIdx++; orderIdx < shardOrder.size(); orderIdx = nextOrderIdx++)
+			{
+				unsigned int shardIdx = shardOrder[orderIdx];
+				if (numShardLetters[shardIdx] == 0)
+					continue;
+
+				// (a huge page is faulted in whole, a shard that can't fill one is built on the heap)
+				bool isLarge = numShardLetters[shardIdx] * sizeof(TrieNode) >= BlockMemory::HUGE_PAGE_SIZE;
+				shards[shardIdx].reset(new Shard(isLarge ? BlockMemory::BlockSource::HUGE_PAGES : BlockMemory::BlockSource::HEAP));
+				Shard& shard = *shards[shardIdx];
+				if (shardIdx < numLetters)
+				{
+					for (const PartWord& partWord : partWords[shardIdx])
+					{
+						AddToShard(shard, words[partWord.wordIdx].c_str() + partWord.partLength - 1, partWord.partLength, true);
+						shard.diagnostics.numReversePartWords++;
+					}
+				}
+				else
+				{
+					for (unsigned int idx : wordIdxs[shardIdx - numLetters])
+					{
+						AddToShard(shard, words[idx].c_str(), (unsigned int)words[idx].length(), false);
+						shard.diagnostics.numWords++;
+						shard.diagnostics.numWordLetters += (unsigned int)words[idx].length();
+					}
+				}
+			}
+		});
 
-		// add letters in reverse starting at wordLength - 1
-		TrieNode* pCurNode = this->pReversePartWordNode;
+		// the ids of the nodes of each shard follow the ones before it
+		vector<unsigned int> idOffsets(shards.size());
+		unsigned int idOffset = this->nodePool.NumIds();
+		for (size_t shardIdx = 0; shardIdx < shards.size(); shardIdx++)
+		{
+			idOffsets[shardIdx] = idOffset;
+			if (shards[shardIdx])
+				idOffset += shards[shardIdx]->nodePool.NumIds();	// (Append throws if there are too many)
+		}
+
+		RunOnThreads(numThreads, [&](unsigned int threadIdx)
+		{
+			for (unsigned int shardIdx = threadIdx; shardIdx < shards.size(); shardIdx += numThreads)
+			{
+				if (shards[shardIdx])
+					shards[shardIdx]->nodePool.OffsetIds(idOffsets[shardIdx]);
+			}
+		});
+
+		// in the order of the letters, as sibling lists are sorted
+		unsigned int lastReversePartWordChildId = TrieNodePool::NO_NODE;
+		unsigned int lastWordChildId = TrieNodePool::NO_NODE;
+		for (unsigned int shardIdx = 0; shardIdx < shards.size(); shardIdx++)
+		{
+			if (!shards[shardIdx])
+				continue;
+			if (shardIdx < numLetters)
+				AddShard(*shards[shardIdx], idOffsets[shardIdx], true, lastReversePartWordChildId);
+			else
+				AddShard(*shards[shardIdx], idOffsets[shardIdx], false, lastWordChildId);
+		}
+	}
+
+	// ADD REVERSED PART WORD
+	// the first partLength letters of the word, reversed
+	void Trie::AddReversedPartWord(const char* pWord, unsigned int partLength)
+	{
+		// add letters in reverse starting at partLength - 1
+		unsigned int curNodeId = this->reversePartWordNodeId;
 		bool isWordTerminal = false;
-		for (int idx = wordLength - 1; idx >= 0; idx--)
+		for (int idx = partLength - 1; idx >= 0; idx--)
 		{
 			// final letter?
 			if (idx == 0)
 				isWordTerminal = true;
-			pCurNode = AddChildNode(pCurNode, pWord[idx], isWordTerminal);
+			curNodeId = AddChildNode(this->nodePool, this->diagnostics, curNodeId, pWord[idx], isWordTerminal);
 		}
 
 		// increment reverse part word count
 		this->diagnostics.numReversePartWords++;
+	}
+
+	// ADD REVERSED PART WORDS
+	// For example, if the word is CATS, and the wordLength is 4, the following
+	// part words are added to the reverse part word part of the DAWG:
+	//
+	// STAC
+	// TAC
+	// AC
+	// C
+	void Trie::AddReversedPartWords(const char* pWord, unsigned int wordLength)
+	{
+		// validation
+		assert(pWord != NULL);
+		assert(this->state == TrieState::ADDING_WORDS);
 
-		// need to add reverse part word starting at wordLength - 1
-		AddReversedPartWords(pWord, wordLength - 1);
+		// a reverse part word starting at each letter
+		for (unsigned int partLength = wordLength; partLength > 0; partLength--)
+			AddReversedPartWord(pWord, partLength);
 	}
 
-	// ADD TREE TO DAWG
-	// *** To be called on first child only ***
-	int Trie::AddTreeToDawg(TrieNode* pNode, DawgCreator& dawgCreator, int lastSavedNodeNumber) const
+	// ADD SHARD
+	// The nodes of the shard must have been offset to follow the nodes of the Trie (see
+	// TrieNodePool::Append). Its tree is linked in after the last child of '*' or '<'.
+	void Trie::AddShard(Shard& shard, unsigned int idOffset, bool isReversePartWords, unsigned int& lastChildId)
 	{
-		// recursion stop conditions
-		if (pNode == NULL)
-			return lastSavedNodeNumber;
-
-		if (pNode->nodeNumber == Trie::DEFAULT_NODE_NUMBER)
-			return lastSavedNodeNumber;
-
-		// node numbers are saved sequentially. Due to
-		// cyclical nature of DAWG, previous added nodes may be
-		// asked to be added again. Guard against that!
-		if (pNode->nodeNumber <= lastSavedNodeNumber)
-			return lastSavedNodeNumber;
-		
-		// save all the siblings first
-		TrieNode* pSaveNode = pNode;
-		DawgNode dawgNode;
-		while (pSaveNode != NULL)
-		{
-			assert(pSaveNode->nodeNumber == lastSavedNodeNumber + 1); // verifies sequencing
-			Trie::TrieNodeToDawgNode(pSaveNode, dawgNode);
-			dawgCreator.AddNode(dawgNode);
+		assert(idOffset == this->nodePool.NumIds());
+		assert(shard.rootNodeId != TrieNodePool::NO_NODE);
 
-			lastSavedNodeNumber = pSaveNode->nodeNumber;
-			pSaveNode = pSaveNode->pNextSibling;
-		}
+		unsigned int parentNodeId = isReversePartWords ? this->reversePartWordNodeId : this->forwardWordNodeId;
+		this->nodePool.Append(shard.nodePool);
 
-		// save all the first children and their tree of the current tree
-		pSaveNode = pNode;
-		while (pSaveNode != NULL)
-		{
-			lastSavedNodeNumber = AddTreeToDawg(pSaveNode->pFirstChild, dawgCreator, lastSavedNodeNumber);
-			pSaveNode = pSaveNode->pNextSibling;
-		}
+		unsigned int childId = shard.rootNodeId + idOffset;
+		this->nodePool[childId].originalParentId = parentNodeId;
+		if (lastChildId == TrieNodePool::NO_NODE)
+			this->nodePool[parentNodeId].firstChildId = childId;
+		else
+			this->nodePool[lastChildId].nextSiblingId = childId;
+		lastChildId = childId;
 
-		return lastSavedNodeNumber;
+		// diagnostics
+		this->diagnostics.numNodes += shard.diagnostics.numNodes;
+		this->diagnostics.numWords += shard.diagnostics.numWords;
+		this->diagnostics.numWordLetters += shard.diagnostics.numWordLetters;
+		this->diagnostics.numLetters += shard.diagnostics.numLetters;
+		this->diagnostics.numReversePartWords += shard.diagnostics.numReversePartWords;
+	}
+
+	// ADD TO SHARD
+	// The letters go forward from pLetters for a word and backward for a reversed part word.
+	// The first letter is the root of the shard (its parent is linked in by AddShard).
+	void Trie::AddToShard(Shard& shard, const char* pLetters, unsigned int length, bool isReversed)
+	{
+		assert(length > 0);
+
+		if (shard.rootNodeId == TrieNodePool::NO_NODE)
+			shard.rootNodeId = AllocateNewNode(shard.nodePool, shard.diagnostics, TrieNodePool::NO_NODE, *pLetters, length == 1);
+		else if (length == 1)
+			shard.nodePool[shard.rootNodeId].isWordTerminal = true;
+		shard.diagnostics.numLetters++;
+
+		int step = isReversed ? -1 : 1;
+		unsigned int curNodeId = shard.rootNodeId;
+		for (unsigned int letterIdx = 1; letterIdx < length; letterIdx++)
+			curNodeId = AddChildNode(shard.nodePool, shard.diagnostics, curNodeId, pLetters[step * (int)letterIdx], letterIdx == length - 1);
 	}
 
 	// ALLOCATE NEW NODE
-	TrieNode* Trie::AllocateNewNode(void)
+	unsigned int Trie::AllocateNewNode(TrieNodePool& nodePool, TrieDiagnostics& diagnostics)
 	{
 		// get new memory and initialize values
-		TrieNode* pNewNode = (TrieNode*) this->blockMemory.Allocate(sizeof(TrieNode));
-		this->diagnostics.numNodes++;
+		unsigned int newNodeId = nodePool.Allocate();
+		diagnostics.numNodes++;
 
-		pNewNode->pFirstChild = NULL;
-		pNewNode->pNextSibling = NULL;
-		pNewNode->pOriginalParent = NULL;
-		pNewNode->letter = Dawg::DEFAULT_LETTER;
-		pNewNode->isWordTerminal = false;
+		TrieNode& newNode = nodePool[newNodeId];
+		newNode.firstChildId = TrieNodePool::NO_NODE;
+		newNode.nextSiblingId = TrieNodePool::NO_NODE;
+		newNode.originalParentId = TrieNodePool::NO_NODE;
+		newNode.letter = Dawg::DEFAULT_LETTER;
+		newNode.isWordTerminal = false;
 
-		pNewNode->isCounted = false;
-		pNewNode->isDuplicate = false;
+		newNode.isNumbered = false;
+		newNode.isDuplicate = false;
 
-		return pNewNode;
+		return newNodeId;
 	}
 
 	// ALLOCATE NEW NODE
-	TrieNode* Trie::AllocateNewNode(
-		TrieNode*	pOriginalParent,
-		char		letter,
-		bool		isWordTerminal)
+	unsigned int Trie::AllocateNewNode(
+		TrieNodePool&		nodePool,
+		TrieDiagnostics&	diagnostics,
+		unsigned int		originalParentId,
+		char				letter,
+		bool				isWordTerminal)
 	{
 		assert(Trie::IsValidLetter(letter));
 
-		TrieNode* pNewNode = AllocateNewNode();
-		pNewNode->pOriginalParent = pOriginalParent;
-		pNewNode->letter = letter;
-		pNewNode->isWordTerminal = isWordTerminal;
+		unsigned int newNodeId = AllocateNewNode(nodePool, diagnostics);
+		TrieNode& newNode = nodePool[newNodeId];
+		newNode.originalParentId = originalParentId;
+		newNode.letter = letter;
+		newNode.isWordTerminal = isWordTerminal;
 
-		return pNewNode;
+		return newNodeId;
 	}
 
 	// ARE NODES SIMILAR
-	bool Trie::AreNodesSimilar(TrieNode* pNode1, TrieNode* pNode2) const
+	// *** To be called for first children only ***
+	// Compares the two sibling lists node for node. Children are compared by identity
+	// (node id) and not by their contents as they are expected to be unique already
+	// (see RemoveDuplicates).
+	bool Trie::AreNodesSimilar(unsigned int nodeId1, unsigned int nodeId2) const
 	{
-		// are these the same nodes or are both of them NULL?
-		if (pNode1 == pNode2)
-			return true;
-
-		// one of them NULL?
-		if (pNode1 == NULL || pNode2 == NULL)
-			return false;
-
-		// different letters?
-		if (pNode1->letter != pNode2->letter)
-			return false;
-
-		// different word terminal setting?
-		if (pNode1->isWordTerminal != pNode2->isWordTerminal)
-			return false;
-
-		// is the next sibling similar
-		if (!AreNodesSimilar(pNode1->pNextSibling, pNode2->pNextSibling))
-			return false;
+		while (nodeId1 != nodeId2)
+		{
+			// one of them NO_NODE (different number of siblings)?
+			if (nodeId1 == TrieNodePool::NO_NODE || nodeId2 == TrieNodePool::NO_NODE)
+				return false;
+
+			// different letters, word terminal setting or first child?
+			const TrieNode& node1 = this->nodePool[nodeId1];
+			const TrieNode& node2 = this->nodePool[nodeId2];
+			if (node1.letter != node2.letter ||
+				node1.isWordTerminal != node2.isWordTerminal ||
+				node1.firstChildId != node2.firstChildId)
+				return false;
+
+			nodeId1 = node1.nextSiblingId;
+			nodeId2 = node2.nextSiblingId;
+		}
 
-		// is the first child similar
-		return AreNodesSimilar(pNode1->pFirstChild, pNode2->pFirstChild);
+		// same nodes (or both NO_NODE)
+		return true;
 	}
 
 	// ASSIGN NODE NUMBER FOR TREE
 	// *** To be called for first children only ***
-	int Trie::AssignNodeNumberForTree(TrieNode* pNode, int nextNodeNumber)
+	// The numbered sibling lists are kept in numberedFirstChildren, in order.
+	int Trie::AssignNodeNumberForTree(unsigned int nodeId, int nextNodeNumber)
 	{
-		// recursion stop condition
-		if (pNode == NULL)
-			return nextNodeNumber;
-
-		// if this is a duplicate don't touch!
-		if (pNode->isDuplicate)
-			return nextNodeNumber;
-
-		// if the node is numbered return
-		if (pNode->nodeNumber != Trie::DEFAULT_NODE_NUMBER)
-			return nextNodeNumber;
-
-		// first child and siblings need to be contiguous
-		pNode->nodeNumber = nextNodeNumber++;
-		TrieNode* pSibling = pNode->pNextSibling;
-		while (pSibling != NULL)
+		// the sibling whose first child is to be numbered next, one per level
+		TreeWalkStack<unsigned int> siblingIds;
+		unsigned int firstChildId = nodeId;
+		while (true)
 		{
-			pSibling->nodeNumber = nextNodeNumber++;
-			pSibling = pSibling->pNextSibling;
-		}
+			// duplicates and numbered nodes are not touched
+			if (firstChildId != TrieNodePool::NO_NODE &&
+				!this->nodePool[firstChildId].isDuplicate &&
+				!this->nodePool[firstChildId].isNumbered)
+			{
+				// first child and siblings need to be contiguous
+				for (unsigned int siblingId = firstChildId; siblingId != TrieNodePool::NO_NODE; siblingId = this->nodePool[siblingId].nextSiblingId)
+				{
+					TrieNode& sibling = this->nodePool[siblingId];
+					sibling.nodeNumber = nextNodeNumber++;
+					sibling.isNumbered = true;
+				}
+				this->numberedFirstChildren.push_back(firstChildId);
+
+				// need to have the first child of each numbered too
+				siblingIds.Push(firstChildId);
+			}
 
-		// need to have the first child of the tree numbered too
-		nextNodeNumber = AssignNodeNumberForTree(pNode->pFirstChild, nextNodeNumber);
-		pSibling = pNode->pNextSibling;
-		while (pSibling != NULL)
-		{
-			nextNodeNumber = AssignNodeNumberForTree(pSibling->pFirstChild, nextNodeNumber);
-			pSibling = pSibling->pNextSibling;
+			if (siblingIds.IsEmpty())
+				break;
+
+			unsigned int siblingId = siblingIds.Pop();
+			const TrieNode& sibling = this->nodePool[siblingId];
+			if (sibling.nextSiblingId != TrieNodePool::NO_NODE)
+				siblingIds.Push(sibling.nextSiblingId);
+			firstChildId = sibling.firstChildId;
 		}
 
 		return nextNodeNumber;
 	}
 
 	// COMPRESS
-	bool Trie::Compress(void) throw(...)
+	bool Trie::Compress(void)
 	{
 		// validate state for addition
 		if (this->state == TrieState::COMPRESSED)
-			throw(std::exception("Trie is already COMPRESSED!"));
+			throw(std::runtime_error("Trie is already COMPRESSED!"));
 
 		// adding words state
 		if (this->state == TrieState::ADDING_WORDS)
-		{
-			this->state = TrieState::COMPRESSING;
-
-			// need to identify and collect first children
-			IdentifyFirstChildren(this->pRootNode);
-			this->firstChildrenCompressNodeIdx = 0;
-			this->diagnostics.numFirstChildrenBeforeCompression = this->firstChildren.size();
-		}
+			StartCompression();
 
 		// compression in progress
 		if (this->state == TrieState::COMPRESSING)
 		{
 			// are we done?
-			if (this->firstChildrenCompressNodeIdx >= this->firstChildren.size() - 1)
+			if (this->firstChildrenCompressNodeIdx >= this->firstChildren.size())
 			{
-				// compression finished
-				this->state = TrieState::COMPRESSED;
-
-				// get nodes numbered
-				SetDefaultNodeNumberForTree(this->pRootNode);
-				int startNodeNumber = 0;
-				unsigned int numNodes = AssignNodeNumberForTree(this->pRootNode, startNodeNumber);
-
-				// diagnostics
-				UpdateAfterCompressionDiagnostics();
-				assert(numNodes == this->diagnostics.numNodesAfterCompression);		// different methods of computing num nodes
-
+				FinishCompression();
 				return true;	// done compressing
 			}
 			else
 			{
-				// need to remove duplicates for the current node
-				RemoveDuplicates(this->firstChildrenCompressNodeIdx);
+				// need to remove duplicates for the current node (bottom-up)
+				if (RemoveDuplicates(this->firstChildren.size() - 1 - this->firstChildrenCompressNodeIdx, this->siblingListRegister))
+					this->numDuplicatesRemoved++;
 				this->firstChildrenCompressNodeIdx++;
 
 				return false;	// more work is left
@@ -375,55 +534,249 @@ namespace LxpStd
 		return true;	// nothing to do, state must be COMPRESSED
 	}
 
+	// COMPRESS
+	// with a time budget
+	bool Trie::Compress(unsigned int budgetMilliseconds, TrieCompressProgress& progress)
+	{
+		// validate state for compression
+		if (this->state == TrieState::COMPRESSED)
+			throw(std::runtime_error("Trie is already COMPRESSED!"));
+
+		chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+		chrono::steady_clock::time_point endTime = startTime + chrono::milliseconds(budgetMilliseconds);
+
+		// adding words state
+		if (this->state == TrieState::ADDING_WORDS)
+		{
+			StartCompression();
+			this->compressStartSeconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+		}
+
+		// remove duplicates (bottom-up) until done or out of time
+		unsigned int numFirstChildren = this->firstChildren.size();
+		while (this->firstChildrenCompressNodeIdx < numFirstChildren)
+		{
+			unsigned int endIdx = min(numFirstChildren, this->firstChildrenCompressNodeIdx + Trie::COMPRESS_CLOCK_INTERVAL);
+			for (; this->firstChildrenCompressNodeIdx < endIdx; this->firstChildrenCompressNodeIdx++)
+			{
+				if (RemoveDuplicates(numFirstChildren - 1 - this->firstChildrenCompressNodeIdx, this->siblingListRegister))
+					this->numDuplicatesRemoved++;
+			}
+
+			if (budgetMilliseconds != 0 && chrono::steady_clock::now() >= endTime)
+				break;
+		}
+
+		bool isDone = (this->firstChildrenCompressNodeIdx >= numFirstChildren);
+		if (isDone)
+			FinishCompression();
+
+		this->compressSeconds += chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+		GetCompressProgress(progress);
+		return isDone;
+	}
+
+	// COMPRESS PARALLEL
+	// (see the notes in Trie.h)
+	void Trie::CompressParallel(unsigned int numThreads)
+	{
+		// validate state for compression
+		if (this->state != TrieState::ADDING_WORDS)
+			throw(std::runtime_error("Trie must be in ADDING_WORDS state!"));
+
+		if (numThreads == 0)
+			numThreads = max(1U, thread::hardware_concurrency());
+
+		this->state = TrieState::COMPRESSING;
+
+		// first children (in the same order as StartCompression) and the heights of their sibling lists
+		vector<unsigned int> heights;
+		IdentifyFirstChildren(this->nodePool[this->rootNodeId].firstChildId, heights);
+		this->diagnostics.numFirstChildrenBeforeCompression = this->firstChildren.size();
+
+		// first children sorted on height, bottom-up within a height
+		unsigned int maxHeight = *max_element(heights.begin(), heights.end());
+		vector<unsigned int> heightStarts(maxHeight + 2, 0);
+		for (unsigned int idx = 0; idx < heights.size(); idx++)
+			heightStarts[heights[idx] + 1]++;
+		for (unsigned int height = 1; height < heightStarts.size(); height++)
+			heightStarts[height] += heightStarts[height - 1];
+
+		vector<unsigned int> sortedIdxs(this->firstChildren.size());
+		vector<unsigned int> nextSortedIdx(heightStarts.begin(), heightStarts.end() - 1);
+		for (unsigned int idx = this->firstChildren.size(); idx-- > 0;)
+			sortedIdxs[nextSortedIdx[heights[idx]]++] = idx;
+
+		// one height at a time, the threads share the sibling lists on their hash
+		vector<unsigned int> threadIdxs(this->firstChildren.size());
+		vector<SiblingListRegister> siblingListRegisters(numThreads, SiblingListRegister(0, SiblingListHash{ this }, SiblingListEqual{ this }));
+		for (unsigned int height = 0; height <= maxHeight; height++)
+		{
+			unsigned int startIdx = heightStarts[height];
+			unsigned int numLists = heightStarts[height + 1] - startIdx;
+
+			RunOnThreads(numThreads, [&](unsigned int threadIdx)
+			{
+				unsigned int endIdx = startIdx + (unsigned int)((unsigned long long)numLists * (threadIdx + 1) / numThreads);
+				for (unsigned int idx = startIdx + (unsigned int)((unsigned long long)numLists * threadIdx / numThreads); idx < endIdx; idx++)
+					threadIdxs[idx] = GetSiblingListHash(this->firstChildren[sortedIdxs[idx]]) % numThreads;
+			});
+
+			RunOnThreads(numThreads, [&](unsigned int threadIdx)
+			{
+				SiblingListRegister& siblingListRegister = siblingListRegisters[threadIdx];
+				for (unsigned int idx = startIdx; idx < startIdx + numLists; idx++)
+				{
+					if (threadIdxs[idx] == threadIdx)
+						RemoveDuplicates(sortedIdxs[idx], siblingListRegister);
+				}
+
+				siblingListRegister.clear();	// no duplicates across heights
+			});
+		}
+
+		FinishCompression();
+	}
+
+	// FINISH COMPRESSION
+	// (see the notes in Trie.h)
+	void Trie::FinishCompression()
+	{
+		// compression finished
+		this->state = TrieState::COMPRESSED;
+		SiblingListRegister(0, SiblingListHash{ this }, SiblingListEqual{ this }).swap(this->siblingListRegister);	// release the memory
+		this->firstChildrenCompressNodeIdx = this->firstChildren.size();
+		vector<unsigned int>().swap(this->firstChildren);
+
+		// get nodes numbered (every sibling list that is not a duplicate is reached from the root,
+		// which is a list of its own)
+		chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+		int startNodeNumber = 0;
+		this->numberedFirstChildren.reserve(this->diagnostics.numFirstChildrenBeforeCompression + 1);
+		unsigned int numNodes = AssignNodeNumberForTree(this->rootNodeId, startNodeNumber);
+
+		// diagnostics
+		this->diagnostics.numFirstChildrenAfterCompression = this->numberedFirstChildren.size() - 1;
+		this->diagnostics.numNodesAfterCompression = numNodes;
+		this->diagnostics.numFinishPasses = 1;
+		this->diagnostics.numberingSeconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+		this->numDuplicatesRemoved = this->diagnostics.numFirstChildrenBeforeCompression - this->diagnostics.numFirstChildrenAfterCompression;
+	}
+
+	// GET COMPRESS PROGRESS
+	void Trie::GetCompressProgress(TrieCompressProgress& progress) const
+	{
+		progress.numFirstChildren = this->diagnostics.numFirstChildrenBeforeCompression;
+		progress.numFirstChildrenProcessed = this->firstChildrenCompressNodeIdx;
+		progress.numDuplicatesRemoved = this->numDuplicatesRemoved;
+		progress.elapsedSeconds = this->compressSeconds;
+
+		if (this->state == TrieState::COMPRESSED)
+		{
+			progress.fractionDone = 1.0;
+			progress.remainingSeconds = 0.0;
+		}
+		else if (progress.numFirstChildrenProcessed == 0)
+		{
+			progress.fractionDone = 0.0;
+			progress.remainingSeconds = 0.0;	// no rate yet
+		}
+		else
+		{
+			progress.fractionDone = (double)progress.numFirstChildrenProcessed / progress.numFirstChildren;
+			double secondsPerList = (this->compressSeconds - this->compressStartSeconds) / progress.numFirstChildrenProcessed;
+			progress.remainingSeconds = secondsPerList * (progress.numFirstChildren - progress.numFirstChildrenProcessed);
+		}
+	}
+
 	// GET DIAGNOSTICS
 	void Trie::GetDiagnostics(TrieDiagnostics& diagnostics) const
 	{
 		diagnostics = this->diagnostics;
+		diagnostics.numFinishPasses += this->numSaves;
+		diagnostics.savingSeconds = this->saveSeconds;
 	}
 
-	// GET NODE COUNT FOR TREE
-	unsigned int Trie::GetNodeCountForTree(TrieNode* pNode) 
+	// GET SIBLING LIST HASH
+	// *** To be called for first children only ***
+	// Hash is computed from the same attributes compared by AreNodesSimilar
+	size_t Trie::GetSiblingListHash(unsigned int nodeId) const
 	{
-		unsigned int count = 0;
-
-		// recursion stop condition
-		if (pNode == NULL)
-			return count;
-		
-		// count the node (if not counted), sibling and first child
-		if (!pNode->isCounted)
+		size_t hash = 0;
+		while (nodeId != TrieNodePool::NO_NODE)
 		{
-			count = 1;
-			pNode->isCounted = true;
+			const TrieNode& node = this->nodePool[nodeId];
+			hash = hash * 31 + (unsigned char)node.letter;
+			hash = hash * 31 + (node.isWordTerminal ? 1 : 0);
+			hash = hash * 31 + node.firstChildId;
+			nodeId = node.nextSiblingId;
 		}
-		
-		count += GetNodeCountForTree(pNode->pNextSibling);
-		count += GetNodeCountForTree(pNode->pFirstChild);
 
-		return count;
+		return hash;
 	}
 
 	// IDENTIFY FIRST CHILDREN
-	void Trie::IdentifyFirstChildren(TrieNode* pParentNode)
+	void Trie::IdentifyFirstChildren(unsigned int parentNodeId)
 	{
-		// nice recursive call to traverse the first child
-		// and next sibling
-
-		// is the parent null?
-		if (pParentNode == NULL)
-			return;
+		// the first child of each node, before the ones in its tree
+		ForEachNodeInTree(parentNodeId, [this](TrieNode& node)
+		{
+			if (node.firstChildId != TrieNodePool::NO_NODE)
+				this->firstChildren.push_back(node.firstChildId);
+			return true;
+		});
+	}
 
-		// add the first child if there is one
-		// and then its child and siblings
-		if (pParentNode->pFirstChild != NULL)
+	// IDENTIFY FIRST CHILDREN
+	// Same order as above (the first child, then the first children below each sibling).
+	// The height of a sibling list is known once the lists below all its siblings are done.
+	unsigned int Trie::IdentifyFirstChildren(unsigned int firstChildId, vector<unsigned int>& heights)
+	{
+		// sibling list being walked at each level
+		struct ListStruct
 		{
-			this->firstChildren.push_back(pParentNode->pFirstChild);
-			IdentifyFirstChildren(pParentNode->pFirstChild);
+			unsigned int	firstChildIdx;		// in firstChildren
+			unsigned int	siblingId;			// to go down from next
+			unsigned int	height;				// so far
+		};
+		TreeWalkStack<ListStruct> lists;
+
+		ListStruct list = { (unsigned int)this->firstChildren.size(), firstChildId, 0 };
+		this->firstChildren.push_back(firstChildId);
+		heights.push_back(0);
+		lists.Push(list);
+
+		unsigned int height = 0;
+		while (!lists.IsEmpty())
+		{
+			// the next sibling with a first child
+			ListStruct& topList = lists.Top();
+			while (topList.siblingId != TrieNodePool::NO_NODE && this->nodePool[topList.siblingId].firstChildId == TrieNodePool::NO_NODE)
+				topList.siblingId = this->nodePool[topList.siblingId].nextSiblingId;
+
+			// list done, its height goes up to the list above
+			if (topList.siblingId == TrieNodePool::NO_NODE)
+			{
+				height = topList.height;
+				heights[topList.firstChildIdx] = height;
+				lists.Pop();
+				if (!lists.IsEmpty())
+					lists.Top().height = max(lists.Top().height, 1 + height);
+				continue;
+			}
+
+			const TrieNode& sibling = this->nodePool[topList.siblingId];
+			topList.siblingId = sibling.nextSiblingId;
+
+			list.firstChildIdx = (unsigned int)this->firstChildren.size();
+			list.siblingId = sibling.firstChildId;
+			list.height = 0;
+			this->firstChildren.push_back(sibling.firstChildId);
+			heights.push_back(0);
+			lists.Push(list);
 		}
-			
-		// need to do identify the next sibling's first child
-		if (pParentNode->pNextSibling != NULL)
-			IdentifyFirstChildren(pParentNode->pNextSibling);
+
+		return height;
 	}
 
 	// IS VALID LETTER
@@ -444,107 +797,86 @@ namespace LxpStd
 		return false;
 	}
 
-	// LENGTH
-	unsigned int Trie::Length()
+	// REMOVE DUPLICATES
+	// Descendents of the first child must have been processed already (bottom-up order).
+	// If an identical sibling list is already in the register, the first child is marked
+	// as a duplicate and the parent is relinked to the registered sibling list.
+	bool Trie::RemoveDuplicates(unsigned int firstChildrenNodeIdx, SiblingListRegister& siblingListRegister)
 	{
-		// clear the counted state
-		SetIsCountedStateForTree(this->pRootNode, false);
-		return GetNodeCountForTree(this->pRootNode);
+		unsigned int nodeId = this->firstChildren[firstChildrenNodeIdx];
+
+		std::pair<SiblingListRegister::iterator, bool> result = siblingListRegister.insert(nodeId);
+		if (result.second)
+			return false;
+
+		// mark node as duplicate and relink the parent's first child
+		TrieNode& node = this->nodePool[nodeId];
+		node.isDuplicate = true;
+		this->nodePool[node.originalParentId].firstChildId = *result.first;
+		return true;
 	}
 
-	// REMOVE DUPLICATES
-	void Trie::RemoveDuplicates(unsigned int node1Index)
+	// SAVE AS DAWG
+	// the sibling lists in the order of their node numbers
+	void Trie::SaveAsDawg(string fileName, string lexiconName, DawgFileFormat fileFormat, DawgNodeLayout nodeLayout,
+						  const vector<string>& sampleWords, bool isChildMasks) const
 	{
-		// removing duplicates for only one node (node1Index)
-		int numFirstChildren = this->firstChildren.size();
-		
-		TrieNode* pNode1 = this->firstChildren[node1Index];
+		if (this->state != TrieState::COMPRESSED)
+			throw(std::runtime_error("Trie must be COMPRESSED before saving!"));
+
+		chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+		DawgCreator dawgCreator(lexiconName, this->diagnostics.numNodesAfterCompression, this->diagnostics.numWords, fileFormat);
+		if (nodeLayout == DawgNodeLayout::DEPTH_FIRST && !isChildMasks)
+			dawgCreator.StreamDawg(fileName);	// (the nodes aren't kept a second time)
 
-		for (int node2Index = node1Index + 1; node2Index < numFirstChildren; node2Index++)
+		DawgNode dawgNode;
+		for (size_t idx = 0; idx < this->numberedFirstChildren.size(); idx++)
 		{
-			TrieNode* pNode2 = this->firstChildren[node2Index];
-			if (!pNode2->isDuplicate && AreNodesSimilar(pNode1, pNode2))
+			for (unsigned int saveNodeId = this->numberedFirstChildren[idx]; saveNodeId != TrieNodePool::NO_NODE; saveNodeId = this->nodePool[saveNodeId].nextSiblingId)
 			{
-				// mark node2 as duplicate and relink the parent's first child
-				pNode2->isDuplicate = true;
-				pNode2->pOriginalParent->pFirstChild = pNode1;
+				TrieNodeToDawgNode(this->nodePool[saveNodeId], dawgNode);
+				dawgCreator.AddNode(dawgNode);
 			}
 		}
-	}
+		this->numSaves++;
+		this->saveSeconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
 
-	// SAVE AS DAWG
-	void Trie::SaveAsDawg(string fileName, string lexiconName) const
-	{
-		DawgCreator dawgCreator(lexiconName, this->diagnostics.numNodesAfterCompression, this->diagnostics.numWords);
-		AddTreeToDawg(this->pRootNode, dawgCreator, -1);
-		dawgCreator.SaveDawg(fileName);
+		dawgCreator.SaveDawg(fileName, nodeLayout, sampleWords, isChildMasks);
 	}
 
-	// SET DEFAULT NODE NUMBER FOR TREE
-	void Trie::SetDefaultNodeNumberForTree(TrieNode* pNode)
+	// START COMPRESSION
+	void Trie::StartCompression()
 	{
-		// recursion stop condition
-		if (pNode == NULL)
-			return;
-
-		pNode->nodeNumber = Trie::DEFAULT_NODE_NUMBER;
-		SetDefaultNodeNumberForTree(pNode->pNextSibling);
-		SetDefaultNodeNumberForTree(pNode->pFirstChild);
-	}
+		this->state = TrieState::COMPRESSING;
 
-	// SET IS COUNTED STATE FOR TREE
-	void Trie::SetIsCountedStateForTree(TrieNode* pNode, bool isCounted)
-	{
-		// recursion stop condition
-		if (pNode == NULL)
-			return;
-
-		pNode->isCounted = isCounted;
-		SetIsCountedStateForTree(pNode->pNextSibling, isCounted);
-		SetIsCountedStateForTree(pNode->pFirstChild, isCounted);
+		// need to identify and collect first children
+		IdentifyFirstChildren(this->rootNodeId);
+		this->firstChildrenCompressNodeIdx = 0;
+		this->diagnostics.numFirstChildrenBeforeCompression = this->firstChildren.size();
+		this->siblingListRegister.reserve(this->firstChildren.size());
 	}
 
 	// TRIE NODE TO DAWG NODE
-	void Trie::TrieNodeToDawgNode(const TrieNode* pTrieNode, DawgNode& dawgNode) throw(...)
+	void Trie::TrieNodeToDawgNode(const TrieNode& trieNode, DawgNode& dawgNode) const
 	{
-		// validation
-		if (pTrieNode == NULL)
-			throw(std::exception("pTrieNode is NULL!"));;
-
 		// one field at a time!
-		dawgNode.letter = pTrieNode->letter;
+		dawgNode.letter = trieNode.letter;
 
-		if (pTrieNode->pFirstChild != NULL)
-			dawgNode.childNodeId = pTrieNode->pFirstChild->nodeNumber;
+		if (trieNode.firstChildId != TrieNodePool::NO_NODE)
+			dawgNode.childNodeId = this->nodePool[trieNode.firstChildId].nodeNumber;
 		else
 			dawgNode.childNodeId = 0;
 
-		// needed as the two types are different (bool vs unsigned int with 1 bit length)
-		if (pTrieNode->isWordTerminal)
+		// needed as the two types are different (bool vs unsigned char)
+		if (trieNode.isWordTerminal)
 			dawgNode.isTerminal = TRUE;
 		else
 			dawgNode.isTerminal = FALSE;
 
-		if (pTrieNode->pNextSibling == NULL)
+		if (trieNode.nextSiblingId == TrieNodePool::NO_NODE)
 			dawgNode.isLastChild = TRUE;
 		else
 			dawgNode.isLastChild = FALSE;
 	}
-
-	// UPDATE COMPRESSION DIAGNOSTICS
-	void Trie::UpdateAfterCompressionDiagnostics()
-	{
-		// first children nodes
-		int numDuplicates = 0;
-		for (int idx = 0; idx < this->firstChildren.size(); idx++)
-		{
-			if (this->firstChildren[idx]->isDuplicate)
-				numDuplicates++;
-		}
-		this->diagnostics.numFirstChildrenAfterCompression = this->firstChildren.size() - numDuplicates;
-
-		// number of nodes
-		this->diagnostics.numNodesAfterCompression = Length();
-	}
 }
 
@@ -3,36 +3,18 @@
 #ifndef TRIE_H
 #define TRIE_H
 
-#include "BlockMemory.h"
 #include "Dawg.h"
+#include "TreeWalkStack.h"
+#include "TrieNodePool.h"
 
+#include <functional>
+#include <unordered_set>
 #include <vector>
 
 namespace LxpStd
 {
-	typedef	struct TrieNodeStruct			TrieNode;
-	typedef struct TrieDiagnosticsStruct	TrieDiagnostics;
-
-	// this structure is used in constructing a Trie
-	struct TrieNodeStruct
-	{
-		// these are essential for processing and building the Trie
-		TrieNode*	pFirstChild;
-		TrieNode*	pNextSibling;
-		union
-		{
-			TrieNode*	pOriginalParent;	// useful for compression
-			int			nodeNumber;			// used in DAWG generation phase
-		};
-		char		letter;
-		bool		isWordTerminal;
-		
-		// since the above takes 14 bytes, the following two bytes
-		// are used for special purposes (makes the struct 16 bytes)
-		bool			isCounted;		// has a pass been made for counting descendents?
-		bool			isDuplicate;	// this node is a duplicate and needs to be discarded with descedents
-										// (applicable to first child only)
-	};
+	typedef struct TrieDiagnosticsStruct		TrieDiagnostics;
+	typedef struct TrieCompressProgressStruct	TrieCompressProgress;
 
 	// this structure is for diagnostics collection for Trie
 	struct TrieDiagnosticsStruct
@@ -46,6 +28,21 @@ namespace LxpStd
 		unsigned int	numFirstChildrenBeforeCompression;	// available after compression starts
 		unsigned int	numFirstChildrenAfterCompression;	// available after compression ends
 		unsigned int	numNodesAfterCompression;			// available after compression ends
+
+		unsigned int	numFinishPasses;		// over the nodes after compression: numbering, then one per save
+		double			numberingSeconds;		// the numbering pass (available after compression ends)
+		double			savingSeconds;			// the nodes pass of the last save (which writes the nodes when streamed)
+	};
+
+	// this structure is for reporting the progress of compression
+	struct TrieCompressProgressStruct
+	{
+		unsigned int	numFirstChildren;			// sibling lists to be processed
+		unsigned int	numFirstChildrenProcessed;
+		unsigned int	numDuplicatesRemoved;		// sibling lists merged into an identical one so far
+		double			fractionDone;				// numFirstChildrenProcessed / numFirstChildren
+		double			elapsedSeconds;				// time spent in the calls with a budget
+		double			remainingSeconds;			// estimated from the rate so far
 	};
 
 	// ** Trie can be in three states only ***
@@ -54,7 +51,39 @@ namespace LxpStd
 	// if compression is finished. The caller should keep calling until "true" is returned.
 	// At that stage, the state of the Trie becomes COMPRESSED. No more words can be added.
 	// Compression is a long running process. Hence, control is returned to the caller for
-	// processing other (UI) requests.
+	// processing other (UI) requests. Compress() processes a single sibling list per call;
+	// Compress(budgetMilliseconds, progress) keeps going until the time budget is used up
+	// (checking the clock every COMPRESS_CLOCK_INTERVAL lists) and reports the progress.
+	//
+	// Compression is done by hash-consing. First children (each representing a sibling list)
+	// are processed bottom-up (reverse of the order in which they were identified) so that
+	// by the time a sibling list is processed, all of its descendents already point to their
+	// unique (canonical) sibling lists. Two sibling lists are then duplicates if their letters,
+	// word terminal settings and first child pointers match node for node; this shallow
+	// comparison is what the register (hash table) of unique sibling lists is keyed on.
+	//
+	// CompressParallel does the whole compression at once on several threads. Duplicate
+	// sibling lists have the same height (longest path down to a word end), and lists of
+	// the same height don't depend on each other. Heights are compressed one at a time
+	// from the bottom; the lists of a height are split between the threads on their hash,
+	// each thread keeping the register of its share. As each thread processes its lists
+	// in the same (bottom-up) order as Compress, the same list of a set of duplicates is
+	// kept and the saved DAWG is identical.
+	//
+	// Once the sibling lists are unique, FinishCompression numbers the nodes in a single walk
+	// of the unique lists from the root, counting the nodes and the lists as it goes and
+	// keeping the lists in the order of their numbers. SaveAsDawg then goes through that
+	// order and doesn't walk the tree again: two passes over the nodes in all (see the
+	// diagnostics for the time of each).
+	//
+	// AddWords adds a list of words to an empty Trie on several threads. The words are split
+	// into shards by their first letter (the forward subtree under '*') and the reversed part
+	// words by their first letter, which is a letter of the word (the reverse subtree under '<'),
+	// in a single pass over the letters. Each shard is built on a node pool of its own (heap
+	// blocks for the small ones), largest first, then the node pools are appended to the one
+	// of the Trie and the shard roots are linked in under '*' and '<'.
+	// The shapes of the trees don't depend on the order the words were added in, so the
+	// diagnostics and the saved DAWG are the same as adding the words one at a time.
 
 	class Trie
 	{
@@ -64,39 +93,85 @@ namespace LxpStd
 		~Trie();
 
 		// Methods
-		void	AddWord(const char* pWord) throw(...);	// words can be added in any order (see note below)
+		void	AddWord(const char* pWord);	// words can be added in any order (see note below)
+		void	AddWords(const std::vector<std::string>& words, unsigned int numThreads);
+													// AddWord for each, in shards (0 threads for one per core)
 		bool	Compress(void);							// SHOULD be called after all the words are added
-		void	SaveAsDawg(std::string fileName, std::string lexiconName) const;
+		bool	Compress(unsigned int budgetMilliseconds, TrieCompressProgress& progress);
+													// as above for up to the budget (0 to finish in one call)
+		void	CompressParallel(unsigned int numThreads);	// instead of Compress (0 threads for one per core)
+		void	SaveAsDawg(std::string fileName, std::string lexiconName, DawgFileFormat fileFormat = DawgFileFormat::V2,
+						   DawgNodeLayout nodeLayout = DawgNodeLayout::DEPTH_FIRST,
+						   const std::vector<std::string>& sampleWords = std::vector<std::string>(),
+						   bool isChildMasks = false) const;
+													// (see DawgNodeLayout and DawgCreator::SaveDawg)
 
 		// Diagnostics
+		void	GetCompressProgress(TrieCompressProgress& progress) const;
 		void	GetDiagnostics(TrieDiagnostics& diagnostics) const;
 	
 	private:
 		enum class TrieState {ADDING_WORDS, COMPRESSING, COMPRESSED};
-		static const int DEFAULT_NODE_NUMBER = -1;
+		static const unsigned int COMPRESS_CLOCK_INTERVAL = 1024;	// sibling lists processed between checks of the budget
+
+		// Register of unique sibling lists (keyed on first child)
+		struct SiblingListHash
+		{
+			const Trie*	pTrie;
+			size_t operator()(unsigned int nodeId) const { return pTrie->GetSiblingListHash(nodeId); }
+		};
+		struct SiblingListEqual
+		{
+			const Trie*	pTrie;
+			bool operator()(unsigned int nodeId1, unsigned int nodeId2) const { return pTrie->AreNodesSimilar(nodeId1, nodeId2); }
+		};
+		typedef std::unordered_set<unsigned int, SiblingListHash, SiblingListEqual>	SiblingListRegister;
+
+		// The tree of one letter of AddWords, on a node pool of its own
+		struct Shard
+		{
+			TrieNodePool	nodePool;
+			TrieDiagnostics	diagnostics;
+			unsigned int	rootNodeId;		// NO_NODE until the first letter is added
+
+			Shard(BlockMemory::BlockSource blockSource) : nodePool(blockSource), diagnostics(), rootNodeId(TrieNodePool::NO_NODE) {}
+		};
+		struct PartWord
+		{
+			unsigned int	wordIdx;
+			unsigned int	partLength;		// the first partLength letters of the word, reversed
+		};
 
 		// Implementation
-		TrieNode*		AddChildNode(TrieNode* pParentNode, char childLetter, bool isWordTerminal);
+		unsigned int	AddForwardWord(const char* pWord);	// returns the word length
+		void			AddReversedPartWord(const char* pWord, unsigned int partLength);
 		void			AddReversedPartWords(const char* pWord, unsigned int wordLength);
-		int				AddTreeToDawg(TrieNode* pNode, DawgCreator& dawgCreator, int lastSavedNodeNumber) const;
-																						// returns last saved node number
-		TrieNode*		AllocateNewNode(void);
-		TrieNode*		AllocateNewNode(TrieNode* pOriginalParent, char letter, bool isWordTerminal);
-
-		bool			AreNodesSimilar(TrieNode* pNode1, TrieNode* pNode2) const;
-		int				AssignNodeNumberForTree(TrieNode* pNode, int nextNodeNumber);	// returns next node number to be used
-		unsigned int	GetNodeCountForTree(TrieNode* pNode);
-		void			IdentifyFirstChildren(TrieNode* pParentNode);
-		unsigned int	Length();	// returns number of nodes in the Trie
-
-		void			RemoveDuplicates(unsigned int firstChildrenNodeIdx);
-		void			SetDefaultNodeNumberForTree(TrieNode* pNode);
-		void			SetIsCountedStateForTree(TrieNode* pNode, bool isCounted);
-		void			UpdateAfterCompressionDiagnostics();
+		void			AddShard(Shard& shard, unsigned int idOffset, bool isReversePartWords, unsigned int& lastChildId);
+		bool			AreNodesSimilar(unsigned int nodeId1, unsigned int nodeId2) const;	// sibling lists only (shallow)
+		void			FinishCompression();
+		template <typename Function>
+		void			ForEachNodeInTree(unsigned int nodeId, Function function);	// function(node) returns false to skip
+																					// the tree of its first child
+		void			StartCompression();
+
+		int				AssignNodeNumberForTree(unsigned int nodeId, int nextNodeNumber);	// returns next node number to be used
+		size_t			GetSiblingListHash(unsigned int nodeId) const;
+		void			IdentifyFirstChildren(unsigned int parentNodeId);
+		unsigned int	IdentifyFirstChildren(unsigned int firstChildId, std::vector<unsigned int>& heights);
+																						// returns height of the sibling list
+
+		bool			RemoveDuplicates(unsigned int firstChildrenNodeIdx, SiblingListRegister& siblingListRegister);
+																						// returns true if it was a duplicate
+		void			TrieNodeToDawgNode(const TrieNode& trieNode, DawgNode& dawgNode) const;
 
 		// static methods
-		static bool		IsValidLetter(char letter);
-		static void		TrieNodeToDawgNode(const TrieNode* pTrieNode, DawgNode& dawgNode) throw(...);
+		static unsigned int	AddChildNode(TrieNodePool& nodePool, TrieDiagnostics& diagnostics, unsigned int parentNodeId,
+										 char childLetter, bool isWordTerminal);
+		static void			AddToShard(Shard& shard, const char* pLetters, unsigned int length, bool isReversed);
+		static unsigned int	AllocateNewNode(TrieNodePool& nodePool, TrieDiagnostics& diagnostics);
+		static unsigned int	AllocateNewNode(TrieNodePool& nodePool, TrieDiagnostics& diagnostics, unsigned int originalParentId,
+											char letter, bool isWordTerminal);
+		static bool			IsValidLetter(char letter);
 
 		// Not Implemented
 		Trie(const Trie& trie);
@@ -104,15 +179,48 @@ namespace LxpStd
 
 		// Data
 		TrieState		state;
-		TrieNode*		pRootNode;
-		TrieNode*		pForwardWordNode;
-		TrieNode*		pReversePartWordNode;	// reverse partials and reverse words
-		BlockMemory		blockMemory;			// for the Nodes
+		unsigned int	rootNodeId;
+		unsigned int	forwardWordNodeId;
+		unsigned int	reversePartWordNodeId;	// reverse partials and reverse words
+		TrieNodePool	nodePool;
 		TrieDiagnostics	diagnostics;
 
-		std::vector<TrieNode*>	firstChildren;					// vector of all the first children
-		unsigned int			firstChildrenCompressNodeIdx;	// where compression needs to start
+		std::vector<unsigned int>	firstChildren;					// node ids of all the first children
+		unsigned int				firstChildrenCompressNodeIdx;	// number of first children processed so far
+		SiblingListRegister			siblingListRegister;			// unique sibling lists found so far
+		unsigned int				numDuplicatesRemoved;
+		double						compressStartSeconds;			// identifying the first children (in a call with a budget)
+		double						compressSeconds;				// all the calls with a budget
+
+		std::vector<unsigned int>	numberedFirstChildren;			// unique sibling lists, in the order of their node numbers
+		mutable unsigned int		numSaves;						// (SaveAsDawg is const)
+		mutable double				saveSeconds;					// nodes pass of the last one
 	};
+
+	// FOR EACH NODE IN TREE
+	// The node, the tree of its first child and then the tree of its next sibling (the order
+	// of the recursive walks this replaces). A node reached along several paths of a compressed
+	// Trie is visited along each.
+	template <typename Function>
+	void Trie::ForEachNodeInTree(unsigned int nodeId, Function function)
+	{
+		TreeWalkStack<unsigned int> nextSiblingIds;	// to go on with, one per level
+		nextSiblingIds.Push(nodeId);
+		while (!nextSiblingIds.IsEmpty())
+		{
+			nodeId = nextSiblingIds.Pop();
+			while (nodeId != TrieNodePool::NO_NODE)
+			{
+				TrieNode& node = this->nodePool[nodeId];
+				if (node.nextSiblingId != TrieNodePool::NO_NODE)
+					nextSiblingIds.Push(node.nextSiblingId);
+				if (!function(node))
+					break;
+
+				nodeId = node.firstChildId;
+			}
+		}
+	}
 }
 
 #endif // !TRIE_H
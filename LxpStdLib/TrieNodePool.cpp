@@ -0,0 +1,90 @@
+#include "pch.h"
+#include "TrieNodePool.h"
+
+#include <stdexcept>
+
+using namespace std;
+
+namespace LxpStd
+{
+	// CONSTRUCTOR
+	TrieNodePool::TrieNodePool(BlockMemory::BlockSource blockSource)
+	{
+		this->blockSource = blockSource;
+		this->blockMemories.push_back(unique_ptr<BlockMemory>(NewBlockMemory()));
+		this->numNodes = 0;
+	}
+
+	// DESTRUCTOR
+	TrieNodePool::~TrieNodePool()
+	{
+		DeallocateAll();
+	}
+
+	// ALLOCATE
+	unsigned int TrieNodePool::Allocate(void)
+	{
+		// NO_NODE can't be an id
+		if (this->numNodes == TrieNodePool::NO_NODE)
+			throw(std::runtime_error("Too many Trie nodes!"));
+
+		// new chunk needed?
+		if ((this->numNodes & TrieNodePool::CHUNK_MASK) == 0)
+			this->chunks.push_back(this->blockMemories[0]->Allocate<TrieNode>(TrieNodePool::CHUNK_SIZE));
+
+		return this->numNodes++;
+	}
+
+	// APPEND
+	// The chunks of the pool follow the chunks of this one, so the id of each of its nodes
+	// goes up by NumIds (see OffsetIds). New nodes start a chunk of their own.
+	void TrieNodePool::Append(TrieNodePool& trieNodePool)
+	{
+		if (this->chunks.size() + trieNodePool.chunks.size() > TrieNodePool::MAX_CHUNKS)
+			throw(std::runtime_error("Too many Trie nodes!"));
+
+		this->chunks.insert(this->chunks.end(), trieNodePool.chunks.begin(), trieNodePool.chunks.end());
+		for (size_t idx = 0; idx < trieNodePool.blockMemories.size(); idx++)
+			this->blockMemories.push_back(move(trieNodePool.blockMemories[idx]));
+		this->numNodes = NumIds();
+
+		trieNodePool.chunks.clear();
+		trieNodePool.blockMemories.clear();
+		trieNodePool.blockMemories.push_back(unique_ptr<BlockMemory>(NewBlockMemory()));
+		trieNodePool.numNodes = 0;
+	}
+
+	// DEALLOCATE ALL
+	void TrieNodePool::DeallocateAll(void)
+	{
+		this->blockMemories.resize(1);
+		this->blockMemories[0]->DeallocateAll();
+		this->chunks.clear();
+		this->numNodes = 0;
+	}
+
+	// NEW BLOCK MEMORY
+	BlockMemory* TrieNodePool::NewBlockMemory(void) const
+	{
+		if (this->blockSource == BlockMemory::BlockSource::HUGE_PAGES)
+			return new BlockMemory(BlockMemory::HUGE_PAGE_SIZE, BlockMemory::BlockSource::HUGE_PAGES);
+
+		return new BlockMemory(TrieNodePool::HEAP_BLOCK_CHUNKS * TrieNodePool::CHUNK_SIZE * sizeof(TrieNode), this->blockSource);
+	}
+
+	// OFFSET IDS
+	// of a pool with no others appended, in a Trie that is adding words (originalParentId is a link)
+	void TrieNodePool::OffsetIds(unsigned int idOffset)
+	{
+		for (unsigned int nodeId = 0; nodeId < this->numNodes; nodeId++)
+		{
+			TrieNode& node = (*this)[nodeId];
+			if (node.firstChildId != TrieNodePool::NO_NODE)
+				node.firstChildId += idOffset;
+			if (node.nextSiblingId != TrieNodePool::NO_NODE)
+				node.nextSiblingId += idOffset;
+			if (node.originalParentId != TrieNodePool::NO_NODE)
+				node.originalParentId += idOffset;
+		}
+	}
+}
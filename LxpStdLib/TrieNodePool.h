@@ -0,0 +1,98 @@
+// TrieNodePool.h
+
+#ifndef TRIE_NODE_POOL_H
+#define TRIE_NODE_POOL_H
+
+#include "BlockMemory.h"
+
+#include <memory>
+#include <vector>
+
+namespace LxpStd
+{
+	typedef	struct TrieNodeStruct	TrieNode;
+
+	// this structure is used in constructing a Trie
+	// Nodes refer to each other by their id in the TrieNodePool (TrieNodePool::NO_NODE
+	// for none) instead of pointers. This keeps the node at 16 bytes on 64 bit builds
+	// too (it was 32 bytes with pointers). The fields used together by every traversal
+	// (links, letter and flags) are kept together, one cache line access per node.
+	struct TrieNodeStruct
+	{
+		// these are essential for processing and building the Trie
+		unsigned int	firstChildId;
+		unsigned int	nextSiblingId;
+		union
+		{
+			unsigned int	originalParentId;	// useful for compression
+			int				nodeNumber;			// used in DAWG generation phase
+		};
+		char		letter;
+		bool		isWordTerminal;
+
+		// the following two bytes are used for special purposes (makes the struct 16 bytes)
+		bool		isNumbered;		// has the node been given its node number?
+		bool		isDuplicate;	// this node is a duplicate and needs to be discarded with descedents
+									// (applicable to first child only)
+	};
+
+	// Nodes of a Trie, addressed by 32 bit ids. Nodes are allocated in chunks of CHUNK_SIZE
+	// nodes, so they never move and growing the pool never copies them. The id of a node is
+	// its chunk number followed by its index in the chunk. Like BlockMemory, nodes are not
+	// freed individually. The chunks come from huge page blocks as the nodes of a large
+	// Trie are visited in no particular order, or from small heap blocks for pools that stay
+	// small (a huge page is faulted in whole when its first node is written).
+	//
+	// Pools filled on different threads can be joined without copying their nodes: Append
+	// takes the chunks (and the memory) of another pool, whose ids then start at NumIds of
+	// this pool. The links in its nodes must have been moved there first with OffsetIds.
+	// The unused end of the last chunk of each pool is skipped, so after Append NumNodes
+	// counts the ids taken rather than the nodes.
+
+	class TrieNodePool
+	{
+	public:
+		// constants
+		static const unsigned int	NO_NODE = 0xFFFFFFFF;
+
+		// Existence
+		TrieNodePool(BlockMemory::BlockSource blockSource = BlockMemory::BlockSource::HUGE_PAGES);	// HUGE_PAGES or HEAP
+		~TrieNodePool();
+
+		// Methods
+		unsigned int	Allocate(void);		// returns the id of a new node (fields not initialized)
+		void			Append(TrieNodePool& trieNodePool);	// moves the nodes of the pool (left empty) after these
+		void			DeallocateAll(void);
+		void			OffsetIds(unsigned int idOffset);	// adds the offset to the links of the nodes
+
+		// Access
+		TrieNode&		operator[](unsigned int nodeId)			{ return this->chunks[nodeId >> CHUNK_BITS][nodeId & CHUNK_MASK]; }
+		const TrieNode&	operator[](unsigned int nodeId) const	{ return this->chunks[nodeId >> CHUNK_BITS][nodeId & CHUNK_MASK]; }
+		unsigned int	NumIds() const							{ return (unsigned int)this->chunks.size() << CHUNK_BITS; }
+														// ids taken by the chunks (the offset of an appended pool)
+		unsigned int	NumNodes() const						{ return this->numNodes; }
+
+	private:
+		static const unsigned int	CHUNK_BITS = 12;
+		static const unsigned int	CHUNK_SIZE = 1 << CHUNK_BITS;	// nodes in a chunk (64K bytes)
+		static const unsigned int	CHUNK_MASK = CHUNK_SIZE - 1;
+		static const unsigned int	MAX_CHUNKS = TrieNodePool::NO_NODE >> CHUNK_BITS;	// (NO_NODE is not an id)
+		static const unsigned int	HEAP_BLOCK_CHUNKS = 4;		// chunks in a heap block
+
+		// Implementation
+		BlockMemory*	NewBlockMemory(void) const;
+
+		// Not Implemented
+		TrieNodePool(const TrieNodePool& trieNodePool);
+		TrieNodePool& operator=(const TrieNodePool& trieNodePool);
+
+		// Data
+		std::vector<std::unique_ptr<BlockMemory>>	blockMemories;	// for the chunks (huge page blocks), new ones
+																	// from the first, the rest from appended pools
+		std::vector<TrieNode*>	chunks;
+		unsigned int			numNodes;
+		BlockMemory::BlockSource	blockSource;	// of new blocks
+	};
+}
+
+#endif // !TRIE_NODE_POOL_H
@@ -0,0 +1,329 @@
+#include "pch.h"
+#include "WordList.h"
+#include "Dawg.h"
+#include "LxpStdLib.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+#include <unordered_set>
+
+using namespace std;
+
+namespace LxpStd
+{
+	namespace
+	{
+		// character classes other than letters (see ParseChunk)
+		const char	NOT_A_LETTER = 0;
+		const char	WHITESPACE = 1;
+	}
+
+	// CONSTRUCTOR
+	WordList::WordList()
+	{
+		Clear();
+	}
+
+	// DESTRUCTOR
+	WordList::~WordList()
+	{
+	}
+
+	// CLEAR
+	void WordList::Clear()
+	{
+		vector<string>().swap(this->words);
+		this->report.numLines = 0;
+		this->report.numSkippedLines = 0;
+		this->report.numRejectedLines = 0;
+		this->report.numDuplicates = 0;
+		this->report.numWords = 0;
+		this->report.rejects.clear();
+	}
+
+	// GET REPORT
+	void WordList::GetReport(WordListReport& report) const
+	{
+		report = this->report;
+	}
+
+	// MERGE CHUNKS
+	// the (sorted and unique) words of the chunks are merged in pairs, in parallel, until
+	// one run is left
+	void WordList::MergeChunks(vector<Chunk>& chunks)
+	{
+		while (chunks.size() > 1)
+		{
+			unsigned int numPairs = (unsigned int)chunks.size() / 2;
+			RunOnThreads(numPairs, [&chunks](unsigned int pairIdx)
+			{
+				vector<string>& firstWords = chunks[pairIdx * 2].words;
+				vector<string>& secondWords = chunks[pairIdx * 2 + 1].words;
+
+				vector<string> mergedWords;
+				mergedWords.reserve(firstWords.size() + secondWords.size());
+				merge(make_move_iterator(firstWords.begin()), make_move_iterator(firstWords.end()),
+					  make_move_iterator(secondWords.begin()), make_move_iterator(secondWords.end()), back_inserter(mergedWords));
+				mergedWords.erase(unique(mergedWords.begin(), mergedWords.end()), mergedWords.end());
+
+				firstWords.swap(mergedWords);
+				vector<string>().swap(secondWords);
+			});
+
+			// the merged runs (and the odd one out) to the front
+			unsigned int numRuns = numPairs;
+			for (unsigned int idx = 1; idx < numPairs; idx++)
+				chunks[idx].words.swap(chunks[idx * 2].words);
+			if (chunks.size() % 2 == 1)
+				chunks[numRuns++].words.swap(chunks.back().words);
+
+			chunks.resize(numRuns);
+		}
+
+		this->words.swap(chunks[0].words);
+	}
+
+	// PARSE
+	void WordList::Parse(const char* pData, size_t length, bool isSorted, unsigned int numThreads)
+	{
+		Clear();
+
+		if (numThreads == 0)
+			numThreads = max(1U, thread::hardware_concurrency());
+
+		// a chunk per thread (unless the chunks would be small), each ending after a line end
+		size_t numChunks = min((size_t)numThreads, max((size_t)1, length / WordList::MIN_CHUNK_SIZE));
+		vector<Chunk> chunks(numChunks);
+		const char* pDataEnd = pData + length;
+		const char* pStart = pData;
+		for (size_t idx = 0; idx < numChunks; idx++)
+		{
+			const char* pEnd = pDataEnd;
+			if (idx + 1 < numChunks)
+			{
+				pEnd = max(pStart, pData + (size_t)((unsigned long long)length * (idx + 1) / numChunks));
+				const char* pLineEnd = (const char*)memchr(pEnd, '\n', pDataEnd - pEnd);
+				pEnd = pLineEnd != NULL ? pLineEnd + 1 : pDataEnd;
+			}
+
+			Chunk& chunk = chunks[idx];
+			chunk.pStart = pStart;
+			chunk.pEnd = pEnd;
+			chunk.numLines = 0;
+			chunk.numSkippedLines = 0;
+			chunk.numRejectedLines = 0;
+			pStart = pEnd;
+		}
+
+		RunOnThreads((unsigned int)numChunks, [&chunks, isSorted](unsigned int chunkIdx)
+		{
+			WordList::ParseChunk(chunks[chunkIdx], isSorted);
+		});
+
+		// the report (with line numbers from the start of the list)
+		unsigned int firstLineNumber = 0;
+		for (size_t idx = 0; idx < numChunks; idx++)
+		{
+			const Chunk& chunk = chunks[idx];
+			this->report.numLines += chunk.numLines;
+			this->report.numSkippedLines += chunk.numSkippedLines;
+			this->report.numRejectedLines += chunk.numRejectedLines;
+			for (size_t rejectIdx = 0; rejectIdx < chunk.rejects.size() && this->report.rejects.size() < WordList::MAX_REPORTED_REJECTS; rejectIdx++)
+			{
+				this->report.rejects.push_back(chunk.rejects[rejectIdx]);
+				this->report.rejects.back().lineNumber += firstLineNumber;
+			}
+
+			firstLineNumber += chunk.numLines;
+		}
+
+		if (isSorted)
+			MergeChunks(chunks);
+		else
+			UniqueInFileOrder(chunks);
+
+		this->report.numWords = (unsigned int)this->words.size();
+		this->report.numDuplicates = this->report.numLines - this->report.numSkippedLines - this->report.numRejectedLines -
+									 this->report.numWords;
+	}
+
+	// PARSE CHUNK
+	// the first token of each line, checked and upper cased with a table (sorted and unique
+	// if isSorted)
+	void WordList::ParseChunk(Chunk& chunk, bool isSorted)
+	{
+		// upper case letter of each character (WHITESPACE or NOT_A_LETTER otherwise)
+		struct CharacterTableStruct
+		{
+			char	letters[256];
+
+			CharacterTableStruct()
+			{
+				memset(this->letters, NOT_A_LETTER, sizeof(this->letters));
+				for (char letter = Dawg::START_LETTER; letter <= Dawg::END_LETTER; letter++)
+				{
+					this->letters[(unsigned char)letter] = letter;
+					this->letters[(unsigned char)tolower((unsigned char)letter)] = letter;
+				}
+
+				const char* pWhitespace = " \t\r\v\f";
+				for (; *pWhitespace != '\0'; pWhitespace++)
+					this->letters[(unsigned char)*pWhitespace] = WHITESPACE;
+			}
+		};
+		static const CharacterTableStruct table;
+
+		const char* pLine = chunk.pStart;
+		while (pLine < chunk.pEnd)
+		{
+			const char* pLineEnd = (const char*)memchr(pLine, '\n', chunk.pEnd - pLine);
+			if (pLineEnd == NULL)
+				pLineEnd = chunk.pEnd;
+			chunk.numLines++;
+
+			// skip the leading whitespace, blank lines and comments
+			const char* pLetter = pLine;
+			while (pLetter < pLineEnd && table.letters[(unsigned char)*pLetter] == WHITESPACE)
+				pLetter++;
+
+			if (pLetter == pLineEnd || *pLetter == '#')
+				chunk.numSkippedLines++;
+			else
+			{
+				char word[Dawg::MAX_WORD_LENGTH];
+				unsigned int length = 0;
+				bool isValid = true;
+				for (; pLetter < pLineEnd; pLetter++)
+				{
+					char letter = table.letters[(unsigned char)*pLetter];
+					if (letter == WHITESPACE)
+						break;
+
+					if (letter == NOT_A_LETTER)
+						isValid = false;
+					else if (length < (unsigned int)Dawg::MAX_WORD_LENGTH)
+						word[length] = letter;
+					length++;
+				}
+
+				if (isValid && length <= (unsigned int)Dawg::MAX_WORD_LENGTH)
+					chunk.words.push_back(string(word, length));
+				else
+				{
+					chunk.numRejectedLines++;
+					if (chunk.rejects.size() < WordList::MAX_REPORTED_REJECTS)
+					{
+						const char* pLineTextEnd = pLineEnd > pLine && pLineEnd[-1] == '\r' ? pLineEnd - 1 : pLineEnd;
+
+						WordListReject reject;
+						reject.lineNumber = chunk.numLines;
+						reject.reason = isValid ? WordListRejectReason::TOO_LONG : WordListRejectReason::INVALID_LETTER;
+						reject.line.assign(pLine, pLineTextEnd);
+						chunk.rejects.push_back(reject);
+					}
+				}
+			}
+
+			pLine = pLineEnd + 1;
+		}
+
+		if (isSorted)
+			SortWords(chunk.words);
+	}
+
+	// READ
+	void WordList::Read(const string& fileName, bool isSorted, unsigned int numThreads)
+	{
+		// (an empty file can't be mapped)
+		ifstream fileStream(fileName, ifstream::in | ifstream::binary | ifstream::ate);
+		if (!fileStream.is_open())
+			throw(std::runtime_error("Unable to open the word list!"));
+
+		if (fileStream.tellg() == 0)
+		{
+			Parse("", 0, isSorted, numThreads);
+			return;
+		}
+		fileStream.close();
+
+		MappedFile mappedFile;
+		mappedFile.Open(fileName);
+		Parse(mappedFile.Data(), mappedFile.Length(), isSorted, numThreads);
+	}
+
+	// SORT WORDS
+	// Sorted and unique. Comparing and moving strings is slow, so the words are sorted by keys
+	// holding their first PREFIX_KEY_LETTERS letters (5 bits each) and their index, and only
+	// words with the same prefix are compared as strings.
+	void WordList::SortWords(vector<string>& words)
+	{
+		vector<PrefixKey> keys(words.size());
+		for (size_t idx = 0; idx < words.size(); idx++)
+		{
+			const string& word = words[idx];
+			unsigned long long prefix = 0;
+			for (unsigned int letterIdx = 0; letterIdx < WordList::PREFIX_KEY_LETTERS; letterIdx++)
+			{
+				// (1 to 26 for the letters, 0 after the end, so shorter words come first)
+				unsigned int letterCode = letterIdx < word.length() ? (unsigned int)(word[letterIdx] - Dawg::START_LETTER + 1) : 0;
+				prefix = (prefix << 5) | letterCode;
+			}
+
+			keys[idx].prefix = prefix;
+			keys[idx].wordIdx = (unsigned int)idx;
+		}
+
+		sort(keys.begin(), keys.end(), [&words](const PrefixKey& key1, const PrefixKey& key2)
+		{
+			if (key1.prefix != key2.prefix)
+				return key1.prefix < key2.prefix;
+
+			// (the same prefix and shorter than it is the same word)
+			if (words[key1.wordIdx].length() < WordList::PREFIX_KEY_LETTERS)
+				return false;
+
+			return words[key1.wordIdx].compare(WordList::PREFIX_KEY_LETTERS, string::npos,
+											   words[key2.wordIdx], WordList::PREFIX_KEY_LETTERS, string::npos) < 0;
+		});
+
+		vector<string> sortedWords;
+		sortedWords.reserve(words.size());
+		for (size_t idx = 0; idx < keys.size(); idx++)
+		{
+			string& word = words[keys[idx].wordIdx];
+			if (sortedWords.empty() || sortedWords.back() != word)
+				sortedWords.push_back(move(word));
+		}
+
+		words.swap(sortedWords);
+	}
+
+	// UNIQUE IN FILE ORDER
+	// the first occurrence of each word
+	void WordList::UniqueInFileOrder(vector<Chunk>& chunks)
+	{
+		size_t numWords = 0;
+		for (size_t idx = 0; idx < chunks.size(); idx++)
+			numWords += chunks[idx].words.size();
+
+		unordered_set<string> seenWords;
+		seenWords.reserve(numWords);
+		this->words.reserve(numWords);
+		for (size_t idx = 0; idx < chunks.size(); idx++)
+		{
+			vector<string>& chunkWords = chunks[idx].words;
+			for (size_t wordIdx = 0; wordIdx < chunkWords.size(); wordIdx++)
+			{
+				if (seenWords.insert(chunkWords[wordIdx]).second)
+					this->words.push_back(move(chunkWords[wordIdx]));
+			}
+			vector<string>().swap(chunkWords);
+		}
+	}
+}
@@ -0,0 +1,113 @@
+// WordList.h
+
+#ifndef WORD_LIST_H
+#define WORD_LIST_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace LxpStd
+{
+	typedef struct WordListRejectStruct		WordListReject;
+	typedef struct WordListReportStruct		WordListReport;
+
+	enum class WordListRejectReason {INVALID_LETTER, TOO_LONG};
+
+	// line of a word list that is not a word
+	struct WordListRejectStruct
+	{
+		unsigned int			lineNumber;		// from 1
+		WordListRejectReason	reason;
+		std::string				line;			// without the line end
+	};
+
+	// what reading a word list found
+	struct WordListReportStruct
+	{
+		unsigned int				numLines;
+		unsigned int				numSkippedLines;	// blank and comment lines
+		unsigned int				numRejectedLines;
+		unsigned int				numDuplicates;
+		unsigned int				numWords;			// unique words kept
+		std::vector<WordListReject>	rejects;			// the first MAX_REPORTED_REJECTS (in line order)
+	};
+
+	// Words of a word list (lexicon source) ready for Trie or DawgBuilder. The list has one
+	// word per line: the first token of the line, anything after it is an annotation. Lines
+	// starting with # are comments. Words are upper cased and must have letters from
+	// Dawg::START_LETTER to Dawg::END_LETTER only and up to Dawg::MAX_WORD_LENGTH letters,
+	// other lines are rejected (and reported). Duplicates are removed.
+	//
+	// The file is memory mapped and split into a chunk per thread at line ends. Each thread
+	// finds the line ends with memchr (vectorized by the C library) and checks the letters
+	// with a table, then sorts its words, and the sorted chunks are merged in pairs, also
+	// in parallel. Unsorted, the words are kept in the order of the file (first occurrence).
+
+	class WordList
+	{
+	public:
+		// constants
+		static const unsigned int	MAX_REPORTED_REJECTS = 100;
+
+		// Existence
+		WordList();
+		~WordList();
+
+		// Methods
+		void	Clear();
+		void	Parse(const char* pData, size_t length, bool isSorted = true, unsigned int numThreads = 1);
+												// the text of a word list (0 threads for one per core)
+		void	Read(const std::string& fileName, bool isSorted = true, unsigned int numThreads = 1);
+												// as Parse, throws if the file can't be read
+
+		// Access
+		const std::vector<std::string>&	GetWords() const	{ return this->words; }
+
+		// Diagnostics
+		void	GetReport(WordListReport& report) const;
+
+	private:
+		// constants
+		static const size_t			MIN_CHUNK_SIZE = 64 * 1024;	// bytes per thread at least
+		static const unsigned int	PREFIX_KEY_LETTERS = 12;	// in a sort key (see SortWords)
+
+		// Part of the text parsed by one thread
+		struct ChunkStruct
+		{
+			const char*						pStart;
+			const char*						pEnd;		// after the last line end
+			std::vector<std::string>		words;
+			unsigned int					numLines;
+			unsigned int					numSkippedLines;
+			unsigned int					numRejectedLines;
+			std::vector<WordListReject>		rejects;	// line numbers in the chunk
+		};
+		typedef struct ChunkStruct	Chunk;
+
+		// Word being sorted
+		struct PrefixKeyStruct
+		{
+			unsigned long long	prefix;		// first letters of the word
+			unsigned int		wordIdx;
+		};
+		typedef struct PrefixKeyStruct	PrefixKey;
+
+		// Implementation
+		void	MergeChunks(std::vector<Chunk>& chunks);	// sorted chunks into the words
+		void	UniqueInFileOrder(std::vector<Chunk>& chunks);	// chunks into the words
+
+		// static methods
+		static void		ParseChunk(Chunk& chunk, bool isSorted);
+		static void		SortWords(std::vector<std::string>& words);
+
+		// Not Implemented
+		WordList(const WordList& wordList);
+		WordList& operator=(const WordList& wordList);
+
+		// Data
+		std::vector<std::string>	words;
+		WordListReport				report;
+	};
+}
+#endif // !WORD_LIST_H
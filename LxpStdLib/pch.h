@@ -1,5 +1,6 @@
 ﻿#pragma once
 
+#ifdef _WIN32
 #include "targetver.h"
 
 #ifndef WIN32_LEAN_AND_MEAN
@@ -7,3 +8,12 @@
 #endif
 
 #include <windows.h>
+#else
+// TRUE and FALSE come from windows.h elsewhere
+#ifndef TRUE
+#define TRUE	1
+#endif
+#ifndef FALSE
+#define FALSE	0
+#endif
+#endif
@@ -0,0 +1,54 @@
+#include "BenchmarkWords.h"
+
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <string>
+
+using namespace std;
+
+namespace LxpStdLibBenchmark
+{
+	void RegisterDawgBenchmarks();
+	void RegisterTrieBenchmarks();
+}
+
+using namespace LxpStdLibBenchmark;
+
+// Usage: LxpStdLibBenchmark [--word_list=<file>] [Google Benchmark options]
+// --word_list adds the benchmarks of a real word list (one word per line), argument 0
+int main(int argc, char** argv)
+{
+	const char* pWordListOption = "--word_list=";
+	int numArgs = 0;
+	for (int idx = 0; idx < argc; idx++)
+	{
+		if (strncmp(argv[idx], pWordListOption, strlen(pWordListOption)) != 0)
+		{
+			argv[numArgs++] = argv[idx];
+			continue;
+		}
+
+		try
+		{
+			BenchmarkWords::LoadRealWords(argv[idx] + strlen(pWordListOption));
+		}
+		catch (std::exception& e)
+		{
+			fprintf(stderr, "%s\n", e.what());
+			return 1;
+		}
+	}
+	argc = numArgs;
+
+	benchmark::Initialize(&argc, argv);
+	if (benchmark::ReportUnrecognizedArguments(argc, argv))
+		return 1;
+
+	RegisterTrieBenchmarks();
+	RegisterDawgBenchmarks();
+	benchmark::RunSpecifiedBenchmarks();
+
+	BenchmarkWords::RemoveDawgFiles();
+	return 0;
+}
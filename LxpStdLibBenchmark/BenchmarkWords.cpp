@@ -0,0 +1,190 @@
+#include "BenchmarkWords.h"
+
+#include "DawgBuilder.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <tuple>
+
+using namespace LxpStd;
+using namespace std;
+
+namespace LxpStdLibBenchmark
+{
+	namespace
+	{
+		const unsigned int	RANDOM_SEED = 20161016;
+		const unsigned int	SYNTHETIC_SIZES[] = { 1 << 10, 1 << 13, 1 << 16, 1 << 18 };	// up to a real lexicon
+
+		// relative frequencies of A to Z in English text
+		const double	LETTER_WEIGHTS[] =
+		{
+			8.2, 1.5, 2.8, 4.3, 12.7, 2.2, 2.0, 6.1, 7.0, 0.15, 0.8, 4.0, 2.4,
+			6.7, 7.5, 1.9, 0.1, 6.0, 6.3, 9.1, 2.8, 1.0, 2.4, 0.15, 2.0, 0.07
+		};
+
+		// relative frequencies of word lengths 2 to 15
+		const unsigned int	MIN_WORD_LENGTH = 2;
+		const double		LENGTH_WEIGHTS[] = { 1, 3, 6, 9, 12, 13, 12, 10, 8, 6, 4, 3, 2, 1 };
+
+		map<unsigned int, vector<string>>	wordLists;	// by number of words (REAL_WORD_LIST for the real words)
+		map<tuple<unsigned int, DawgNodeLayout, bool>, string>	dawgFiles;	// by number of words, layout and child masks
+	}
+
+	// GENERATE SYNTHETIC WORDS
+	vector<string> BenchmarkWords::GenerateSyntheticWords(unsigned int numWords)
+	{
+		mt19937 generator(RANDOM_SEED);
+		discrete_distribution<int> letterDistribution(begin(LETTER_WEIGHTS), end(LETTER_WEIGHTS));
+		discrete_distribution<int> lengthDistribution(begin(LENGTH_WEIGHTS), end(LENGTH_WEIGHTS));
+
+		set<string> uniqueWords;
+		while (uniqueWords.size() < numWords)
+		{
+			unsigned int wordLength = MIN_WORD_LENGTH + lengthDistribution(generator);
+			string word;
+			for (unsigned int idx = 0; idx < wordLength; idx++)
+				word.push_back((char)('A' + letterDistribution(generator)));
+
+			uniqueWords.insert(word);
+		}
+
+		return vector<string>(uniqueWords.begin(), uniqueWords.end());
+	}
+
+	// GET DAWG FILE
+	// (ACCESS_FREQUENCY is laid out for the lookup words)
+	const string& BenchmarkWords::GetDawgFile(unsigned int numWords, DawgNodeLayout nodeLayout, bool isChildMasks)
+	{
+		tuple<unsigned int, DawgNodeLayout, bool> key = make_tuple(numWords, nodeLayout, isChildMasks);
+		map<tuple<unsigned int, DawgNodeLayout, bool>, string>::iterator it = dawgFiles.find(key);
+		if (it != dawgFiles.end())
+			return it->second;
+
+		const vector<string>& words = GetWords(numWords);
+		DawgBuilder dawgBuilder;
+		for (unsigned int idx = 0; idx < words.size(); idx++)
+			dawgBuilder.AddWord(words[idx].c_str());
+		dawgBuilder.Finish();
+
+		string fileName = "LxpStdLibBenchmark_" + to_string(numWords) + "_" + to_string((int)nodeLayout) +
+						  (isChildMasks ? "_masks" : "") + ".lxd";
+		vector<string> sampleWords;
+		if (nodeLayout == DawgNodeLayout::ACCESS_FREQUENCY)
+			sampleWords = GetLookupWords(numWords);
+		dawgBuilder.SaveAsDawg(fileName, "Benchmark", DawgFileFormat::V2, nodeLayout, sampleWords, isChildMasks);
+		return dawgFiles[key] = fileName;
+	}
+
+	// GET LOOKUP REVERSE PART WORDS
+	vector<string> BenchmarkWords::GetLookupReversePartWords(unsigned int numWords)
+	{
+		const vector<string>& words = GetWords(numWords);
+		mt19937 generator(RANDOM_SEED);
+
+		vector<string> lookupWords;
+		lookupWords.reserve(BenchmarkWords::NUM_LOOKUPS);
+		for (unsigned int idx = 0; idx < BenchmarkWords::NUM_LOOKUPS; idx++)
+		{
+			const string& word = words[generator() % words.size()];
+			unsigned int prefixLength = 1 + generator() % word.length();
+			lookupWords.push_back(string(word.rend() - prefixLength, word.rend()));
+		}
+
+		return lookupWords;
+	}
+
+	// GET LOOKUP WORDS
+	vector<string> BenchmarkWords::GetLookupWords(unsigned int numWords)
+	{
+		const vector<string>& words = GetWords(numWords);
+		mt19937 generator(RANDOM_SEED);
+
+		vector<string> lookupWords;
+		lookupWords.reserve(BenchmarkWords::NUM_LOOKUPS);
+		for (unsigned int idx = 0; idx < BenchmarkWords::NUM_LOOKUPS; idx++)
+		{
+			string word = words[generator() % words.size()];
+
+			// every other one has a letter changed (mostly not a word then)
+			if (idx % 2 == 1)
+				word[generator() % word.length()] = (char)('A' + generator() % 26);
+
+			lookupWords.push_back(word);
+		}
+
+		return lookupWords;
+	}
+
+	// GET WORDS
+	const vector<string>& BenchmarkWords::GetWords(unsigned int numWords)
+	{
+		map<unsigned int, vector<string>>::iterator it = wordLists.find(numWords);
+		if (it != wordLists.end())
+			return it->second;
+
+		if (numWords == BenchmarkWords::REAL_WORD_LIST)
+			return wordLists[numWords];	// no real words
+
+		return wordLists[numWords] = GenerateSyntheticWords(numWords);
+	}
+
+	// LOAD REAL WORDS
+	void BenchmarkWords::LoadRealWords(const string& fileName)
+	{
+		ifstream wordStream(fileName);
+		if (!wordStream.is_open())
+			throw(std::runtime_error("Unable to open the word list!"));
+
+		// upper case, sorted and unique as the builders expect
+		set<string> uniqueWords;
+		string line;
+		while (getline(wordStream, line))
+		{
+			string word;
+			for (unsigned int idx = 0; idx < line.length(); idx++)
+			{
+				char letter = (char)toupper((unsigned char)line[idx]);
+				if (letter >= 'A' && letter <= 'Z')
+					word.push_back(letter);
+			}
+
+			if (!word.empty())
+				uniqueWords.insert(word);
+		}
+
+		if (uniqueWords.empty())
+			throw(std::runtime_error("Word list has no words!"));
+
+		unsigned int realWordList = BenchmarkWords::REAL_WORD_LIST;
+		wordLists[realWordList] = vector<string>(uniqueWords.begin(), uniqueWords.end());
+	}
+
+	// REGISTER BENCHMARK
+	benchmark::internal::Benchmark* BenchmarkWords::RegisterBenchmark(const char* pName, BenchmarkFunction pFunction)
+	{
+		benchmark::internal::Benchmark* pBenchmark = benchmark::RegisterBenchmark(pName, pFunction);
+		for (unsigned int idx = 0; idx < sizeof(SYNTHETIC_SIZES) / sizeof(SYNTHETIC_SIZES[0]); idx++)
+			pBenchmark->Arg(SYNTHETIC_SIZES[idx]);
+
+		if (!GetWords(BenchmarkWords::REAL_WORD_LIST).empty())
+			pBenchmark->Arg(BenchmarkWords::REAL_WORD_LIST);
+
+		return pBenchmark;
+	}
+
+	// REMOVE DAWG FILES
+	void BenchmarkWords::RemoveDawgFiles()
+	{
+		for (map<tuple<unsigned int, DawgNodeLayout, bool>, string>::iterator it = dawgFiles.begin(); it != dawgFiles.end(); ++it)
+			remove(it->second.c_str());
+
+		dawgFiles.clear();
+	}
+}
@@ -0,0 +1,51 @@
+// BenchmarkWords.h
+
+#ifndef BENCHMARK_WORDS_H
+#define BENCHMARK_WORDS_H
+
+#include <benchmark/benchmark.h>
+
+#include "Dawg.h"
+
+#include <string>
+#include <vector>
+
+namespace LxpStdLibBenchmark
+{
+	// Word lists for the benchmarks. Synthetic lists are random words (English letter
+	// frequencies, 2 to 15 letters) generated from a fixed seed, so the runs compare.
+	// A real word list (one word per line) can be given on the command line; benchmarks
+	// using it have 0 as their argument.
+	class BenchmarkWords
+	{
+	public:
+		// common constants
+		static const unsigned int	REAL_WORD_LIST = 0;			// benchmark argument for the real word list
+		static const unsigned int	NUM_LOOKUPS = 1 << 16;		// lookups per benchmark iteration
+
+		typedef void (*BenchmarkFunction)(benchmark::State& state);
+
+		// Methods
+		static void		LoadRealWords(const std::string& fileName);	// throws if the file can't be read
+		static benchmark::internal::Benchmark*	RegisterBenchmark(const char* pName, BenchmarkFunction pFunction);
+																	// for each synthetic size (and the real word list)
+		static void		RemoveDawgFiles();
+
+		// Access
+		static const std::vector<std::string>&	GetWords(unsigned int numWords);	// sorted (REAL_WORD_LIST for the real words)
+		static const std::string&				GetDawgFile(unsigned int numWords,
+															LxpStd::DawgNodeLayout nodeLayout = LxpStd::DawgNodeLayout::DEPTH_FIRST,
+															bool isChildMasks = false);
+																	// Dawg of the words, built once
+		static std::vector<std::string>			GetLookupWords(unsigned int numWords);
+																	// NUM_LOOKUPS words, about half are not words
+		static std::vector<std::string>			GetLookupReversePartWords(unsigned int numWords);
+																	// NUM_LOOKUPS reversed word prefixes
+
+	private:
+		// Implementation
+		static std::vector<std::string>	GenerateSyntheticWords(unsigned int numWords);
+	};
+}
+
+#endif // !BENCHMARK_WORDS_H
@@ -0,0 +1,257 @@
+#include "BenchmarkWords.h"
+
+#include "Dawg.h"
+
+#include <string>
+#include <vector>
+
+using namespace LxpStd;
+using namespace std;
+
+namespace LxpStdLibBenchmark
+{
+	namespace
+	{
+		// NUM_LOOKUPS lookups of the words per iteration
+		void BenchmarkLookups(benchmark::State& state, const Dawg& dawg, const vector<string>& lookupWords, bool isReverse)
+		{
+			for (auto _ : state)
+			{
+				unsigned int numFound = 0;
+				for (unsigned int idx = 0; idx < lookupWords.size(); idx++)
+				{
+					const string& word = lookupWords[idx];
+					if (isReverse ? dawg.IsReversePartWord(word.c_str(), word.length()) : dawg.IsWord(word.c_str(), word.length()))
+						numFound++;
+				}
+
+				benchmark::DoNotOptimize(numFound);
+			}
+
+			state.SetItemsProcessed(state.iterations() * lookupWords.size());
+		}
+
+		// NUM_LOOKUPS words validated as one batch per iteration
+		void BenchmarkBatch(benchmark::State& state, const Dawg& dawg, const vector<string>& lookupWords)
+		{
+			string words;
+			vector<unsigned int> offsets(1, 0);
+			for (unsigned int idx = 0; idx < lookupWords.size(); idx++)
+			{
+				words += lookupWords[idx];
+				offsets.push_back(words.length());
+			}
+
+			vector<unsigned int> isWordBits((lookupWords.size() + 31) / 32);
+			for (auto _ : state)
+			{
+				unsigned int numFound = dawg.AreWords(words.c_str(), &offsets[0], lookupWords.size(), &isWordBits[0]);
+				benchmark::DoNotOptimize(numFound);
+			}
+
+			state.SetItemsProcessed(state.iterations() * lookupWords.size());
+		}
+	}
+
+	// DAWG INITIALIZE
+	void BM_DawgInitialize(benchmark::State& state)
+	{
+		const string& fileName = BenchmarkWords::GetDawgFile((unsigned int)state.range(0));
+		for (auto _ : state)
+		{
+			Dawg dawg;
+			dawg.Initialize(fileName);
+		}
+	}
+
+	// DAWG INITIALIZE MAPPED
+	void BM_DawgInitializeMapped(benchmark::State& state)
+	{
+		const string& fileName = BenchmarkWords::GetDawgFile((unsigned int)state.range(0));
+		for (auto _ : state)
+		{
+			Dawg dawg;
+			dawg.Initialize(fileName, Dawg::LoadMode::MEMORY_MAPPED);
+		}
+	}
+
+	// DAWG INITIALIZE PACKED
+	void BM_DawgInitializePacked(benchmark::State& state)
+	{
+		const string& fileName = BenchmarkWords::GetDawgFile((unsigned int)state.range(0));
+		for (auto _ : state)
+		{
+			Dawg dawg;
+			dawg.Initialize(fileName, Dawg::LoadMode::PACKED);
+		}
+	}
+
+	// DAWG INITIALIZE MAPPED CHILD MASKS
+	// the masks are built after mapping the nodes
+	void BM_DawgInitializeMappedChildMasks(benchmark::State& state)
+	{
+		const string& fileName = BenchmarkWords::GetDawgFile((unsigned int)state.range(0));
+		for (auto _ : state)
+		{
+			Dawg dawg;
+			dawg.Initialize(fileName, Dawg::LoadMode::MEMORY_MAPPED, true);
+		}
+	}
+
+	// DAWG INITIALIZE MAPPED SAVED CHILD MASKS
+	// the masks are mapped from the file with the nodes
+	void BM_DawgInitializeMappedSavedChildMasks(benchmark::State& state)
+	{
+		const string& fileName = BenchmarkWords::GetDawgFile((unsigned int)state.range(0), DawgNodeLayout::DEPTH_FIRST, true);
+		for (auto _ : state)
+		{
+			Dawg dawg;
+			dawg.Initialize(fileName, Dawg::LoadMode::MEMORY_MAPPED, true);
+		}
+	}
+
+	// DAWG IS WORD
+	void BM_DawgIsWord(benchmark::State& state)
+	{
+		Dawg dawg;
+		dawg.Initialize(BenchmarkWords::GetDawgFile((unsigned int)state.range(0)));
+		BenchmarkLookups(state, dawg, BenchmarkWords::GetLookupWords((unsigned int)state.range(0)), false);
+	}
+
+	// DAWG IS WORD BREADTH FIRST
+	void BM_DawgIsWordBreadthFirst(benchmark::State& state)
+	{
+		Dawg dawg;
+		dawg.Initialize(BenchmarkWords::GetDawgFile((unsigned int)state.range(0), DawgNodeLayout::BREADTH_FIRST));
+		BenchmarkLookups(state, dawg, BenchmarkWords::GetLookupWords((unsigned int)state.range(0)), false);
+	}
+
+	// DAWG IS WORD ACCESS FREQUENCY
+	void BM_DawgIsWordAccessFrequency(benchmark::State& state)
+	{
+		Dawg dawg;
+		dawg.Initialize(BenchmarkWords::GetDawgFile((unsigned int)state.range(0), DawgNodeLayout::ACCESS_FREQUENCY));
+		BenchmarkLookups(state, dawg, BenchmarkWords::GetLookupWords((unsigned int)state.range(0)), false);
+	}
+
+	// DAWG IS WORD CHILD MASKS
+	void BM_DawgIsWordChildMasks(benchmark::State& state)
+	{
+		Dawg dawg;
+		dawg.Initialize(BenchmarkWords::GetDawgFile((unsigned int)state.range(0)));
+		dawg.BuildChildMasks();
+		BenchmarkLookups(state, dawg, BenchmarkWords::GetLookupWords((unsigned int)state.range(0)), false);
+	}
+
+	// DAWG IS WORD PACKED
+	void BM_DawgIsWordPacked(benchmark::State& state)
+	{
+		Dawg dawg;
+		dawg.Initialize(BenchmarkWords::GetDawgFile((unsigned int)state.range(0)), Dawg::LoadMode::PACKED);
+		BenchmarkLookups(state, dawg, BenchmarkWords::GetLookupWords((unsigned int)state.range(0)), false);
+		state.counters["nodeBytes"] = (double)dawg.GetNodesSize();
+	}
+
+	// DAWG IS REVERSE PART WORD
+	void BM_DawgIsReversePartWord(benchmark::State& state)
+	{
+		Dawg dawg;
+		dawg.Initialize(BenchmarkWords::GetDawgFile((unsigned int)state.range(0)));
+		BenchmarkLookups(state, dawg, BenchmarkWords::GetLookupReversePartWords((unsigned int)state.range(0)), true);
+	}
+
+	// DAWG ARE WORDS
+	void BM_DawgAreWords(benchmark::State& state)
+	{
+		Dawg dawg;
+		dawg.Initialize(BenchmarkWords::GetDawgFile((unsigned int)state.range(0)));
+		BenchmarkBatch(state, dawg, BenchmarkWords::GetLookupWords((unsigned int)state.range(0)));
+	}
+
+	// DAWG ARE WORDS CHILD MASKS
+	void BM_DawgAreWordsChildMasks(benchmark::State& state)
+	{
+		Dawg dawg;
+		dawg.Initialize(BenchmarkWords::GetDawgFile((unsigned int)state.range(0)));
+		dawg.BuildChildMasks();
+		BenchmarkBatch(state, dawg, BenchmarkWords::GetLookupWords((unsigned int)state.range(0)));
+	}
+
+	// DAWG ARE WORDS PACKED
+	void BM_DawgAreWordsPacked(benchmark::State& state)
+	{
+		Dawg dawg;
+		dawg.Initialize(BenchmarkWords::GetDawgFile((unsigned int)state.range(0)), Dawg::LoadMode::PACKED);
+		BenchmarkBatch(state, dawg, BenchmarkWords::GetLookupWords((unsigned int)state.range(0)));
+	}
+
+	// DAWG FRONT HOOKS
+	void BM_DawgFrontHooks(benchmark::State& state)
+	{
+		Dawg dawg;
+		dawg.Initialize(BenchmarkWords::GetDawgFile((unsigned int)state.range(0)));
+		const vector<string>& lookupWords = BenchmarkWords::GetLookupWords((unsigned int)state.range(0));
+
+		string hooks;
+		for (auto _ : state)
+		{
+			for (unsigned int idx = 0; idx < lookupWords.size(); idx++)
+			{
+				dawg.GetFrontHooks(lookupWords[idx], hooks);
+				benchmark::DoNotOptimize(hooks.data());
+			}
+		}
+
+		state.SetItemsProcessed(state.iterations() * lookupWords.size());
+	}
+
+	// DAWG WORDS CONTAINING
+	// words containing the last NUM_FRAGMENT_LETTERS letters of some of the lookup words
+	void BM_DawgWordsContaining(benchmark::State& state)
+	{
+		const unsigned int NUM_FRAGMENTS = 100;
+		const unsigned int NUM_FRAGMENT_LETTERS = 4;
+
+		Dawg dawg;
+		dawg.Initialize(BenchmarkWords::GetDawgFile((unsigned int)state.range(0)));
+		const vector<string>& lookupWords = BenchmarkWords::GetLookupWords((unsigned int)state.range(0));
+
+		vector<string> fragments;
+		for (unsigned int idx = 0; idx < lookupWords.size() && fragments.size() < NUM_FRAGMENTS; idx++)
+		{
+			if (lookupWords[idx].length() >= NUM_FRAGMENT_LETTERS)
+				fragments.push_back(lookupWords[idx].substr(lookupWords[idx].length() - NUM_FRAGMENT_LETTERS));
+		}
+
+		unsigned int numWords = 0;
+		for (auto _ : state)
+		{
+			for (unsigned int idx = 0; idx < fragments.size(); idx++)
+				numWords += dawg.WordsContaining(fragments[idx], [](const char* pWord) { benchmark::DoNotOptimize(pWord); });
+		}
+
+		state.SetItemsProcessed(numWords);
+	}
+
+	// REGISTER DAWG BENCHMARKS
+	void RegisterDawgBenchmarks()
+	{
+		BenchmarkWords::RegisterBenchmark("Dawg_Initialize", BM_DawgInitialize)->Unit(benchmark::kMicrosecond);
+		BenchmarkWords::RegisterBenchmark("Dawg_InitializeMapped", BM_DawgInitializeMapped)->Unit(benchmark::kMicrosecond);
+		BenchmarkWords::RegisterBenchmark("Dawg_InitializePacked", BM_DawgInitializePacked)->Unit(benchmark::kMicrosecond);
+		BenchmarkWords::RegisterBenchmark("Dawg_InitializeMappedChildMasks", BM_DawgInitializeMappedChildMasks)->Unit(benchmark::kMicrosecond);
+		BenchmarkWords::RegisterBenchmark("Dawg_InitializeMappedSavedChildMasks", BM_DawgInitializeMappedSavedChildMasks)
+			->Unit(benchmark::kMicrosecond);
+		BenchmarkWords::RegisterBenchmark("Dawg_IsWord", BM_DawgIsWord)->Unit(benchmark::kMicrosecond);
+		BenchmarkWords::RegisterBenchmark("Dawg_IsWordPacked", BM_DawgIsWordPacked)->Unit(benchmark::kMicrosecond);
+		BenchmarkWords::RegisterBenchmark("Dawg_IsWordBreadthFirst", BM_DawgIsWordBreadthFirst)->Unit(benchmark::kMicrosecond);
+		BenchmarkWords::RegisterBenchmark("Dawg_IsWordAccessFrequency", BM_DawgIsWordAccessFrequency)->Unit(benchmark::kMicrosecond);
+		BenchmarkWords::RegisterBenchmark("Dawg_IsWordChildMasks", BM_DawgIsWordChildMasks)->Unit(benchmark::kMicrosecond);
+		BenchmarkWords::RegisterBenchmark("Dawg_IsReversePartWord", BM_DawgIsReversePartWord)->Unit(benchmark::kMicrosecond);
+		BenchmarkWords::RegisterBenchmark("Dawg_AreWords", BM_DawgAreWords)->Unit(benchmark::kMicrosecond);
+		BenchmarkWords::RegisterBenchmark("Dawg_AreWordsChildMasks", BM_DawgAreWordsChildMasks)->Unit(benchmark::kMicrosecond);
+		BenchmarkWords::RegisterBenchmark("Dawg_AreWordsPacked", BM_DawgAreWordsPacked)->Unit(benchmark::kMicrosecond);
+		BenchmarkWords::RegisterBenchmark("Dawg_FrontHooks", BM_DawgFrontHooks)->Unit(benchmark::kMicrosecond);
+		BenchmarkWords::RegisterBenchmark("Dawg_WordsContaining", BM_DawgWordsContaining)->Unit(benchmark::kMicrosecond);
+	}
+}
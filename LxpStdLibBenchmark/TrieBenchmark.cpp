@@ -0,0 +1,213 @@
+#include "BenchmarkWords.h"
+
+#include "DawgBuilder.h"
+#include "Trie.h"
+#include "WordList.h"
+
+#include <cctype>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace LxpStd;
+using namespace std;
+
+namespace LxpStdLibBenchmark
+{
+	namespace
+	{
+		const char*	SAVE_FILE_NAME = "LxpStdLibBenchmark_Save.lxd";
+
+		// the trie of the words, compressed if requested
+		Trie* BuildTrie(const vector<string>& words, bool isCompressed)
+		{
+			Trie* pTrie = new Trie();
+			for (unsigned int idx = 0; idx < words.size(); idx++)
+				pTrie->AddWord(words[idx].c_str());
+
+			if (isCompressed)
+			{
+				while (pTrie->Compress() == false)
+				{
+					// do nothing
+				}
+			}
+
+			return pTrie;
+		}
+
+		// the text of a word list of the words (lower case and annotated, in reverse order)
+		string BuildWordListText(const vector<string>& words)
+		{
+			string text;
+			for (size_t idx = words.size(); idx > 0; idx--)
+			{
+				string word = words[idx - 1];
+				for (size_t letterIdx = 0; letterIdx < word.length(); letterIdx++)
+					word[letterIdx] = (char)tolower((unsigned char)word[letterIdx]);
+				text += word + "\tnoun\r\n";
+			}
+
+			return text;
+		}
+
+		// WORD LIST PARSE
+		// reading a word list for the builders (sorted, on numThreads)
+		void BenchmarkWordListParse(benchmark::State& state, unsigned int numThreads)
+		{
+			string text = BuildWordListText(BenchmarkWords::GetWords((unsigned int)state.range(0)));
+			for (auto _ : state)
+			{
+				WordList wordList;
+				wordList.Parse(text.c_str(), text.length(), true, numThreads);
+				benchmark::DoNotOptimize(wordList.GetWords().data());
+			}
+
+			state.SetBytesProcessed(state.iterations() * text.length());
+		}
+	}
+
+	// TRIE ADD WORD
+	// words per second added to an empty trie
+	void BM_TrieAddWord(benchmark::State& state)
+	{
+		const vector<string>& words = BenchmarkWords::GetWords((unsigned int)state.range(0));
+		for (auto _ : state)
+		{
+			Trie* pTrie = BuildTrie(words, false);
+
+			state.PauseTiming();
+			delete pTrie;
+			state.ResumeTiming();
+		}
+
+		state.SetItemsProcessed(state.iterations() * words.size());
+	}
+
+	// TRIE ADD WORDS PARALLEL
+	// words per second added to an empty trie in shards on one thread per core
+	void BM_TrieAddWordsParallel(benchmark::State& state)
+	{
+		const vector<string>& words = BenchmarkWords::GetWords((unsigned int)state.range(0));
+		for (auto _ : state)
+		{
+			Trie* pTrie = new Trie();
+			pTrie->AddWords(words, 0);
+
+			state.PauseTiming();
+			delete pTrie;
+			state.ResumeTiming();
+		}
+
+		state.SetItemsProcessed(state.iterations() * words.size());
+		state.counters["threads"] = (double)thread::hardware_concurrency();
+	}
+
+	// TRIE COMPRESS
+	// wall time of the whole Compress loop
+	void BM_TrieCompress(benchmark::State& state)
+	{
+		const vector<string>& words = BenchmarkWords::GetWords((unsigned int)state.range(0));
+		for (auto _ : state)
+		{
+			state.PauseTiming();
+			Trie* pTrie = BuildTrie(words, false);
+			state.ResumeTiming();
+
+			while (pTrie->Compress() == false)
+			{
+				// do nothing
+			}
+
+			state.PauseTiming();
+			delete pTrie;
+			state.ResumeTiming();
+		}
+
+		state.counters["words"] = (double)words.size();
+	}
+
+	// TRIE COMPRESS PARALLEL
+	// wall time of CompressParallel on one thread per core
+	void BM_TrieCompressParallel(benchmark::State& state)
+	{
+		const vector<string>& words = BenchmarkWords::GetWords((unsigned int)state.range(0));
+		for (auto _ : state)
+		{
+			state.PauseTiming();
+			Trie* pTrie = BuildTrie(words, false);
+			state.ResumeTiming();
+
+			pTrie->CompressParallel(0);
+
+			state.PauseTiming();
+			delete pTrie;
+			state.ResumeTiming();
+		}
+
+		state.counters["words"] = (double)words.size();
+		state.counters["threads"] = (double)thread::hardware_concurrency();
+	}
+
+	// TRIE SAVE AS DAWG
+	// numbering the nodes, filling the DawgCreator and writing the file
+	void BM_TrieSaveAsDawg(benchmark::State& state)
+	{
+		const vector<string>& words = BenchmarkWords::GetWords((unsigned int)state.range(0));
+		Trie* pTrie = BuildTrie(words, true);
+		for (auto _ : state)
+			pTrie->SaveAsDawg(SAVE_FILE_NAME, "Benchmark");
+
+		delete pTrie;
+		remove(SAVE_FILE_NAME);
+		state.counters["words"] = (double)words.size();
+	}
+
+	// DAWG BUILDER BUILD
+	// adding the (sorted) words and finishing, the alternative to AddWord and Compress
+	void BM_DawgBuilderBuild(benchmark::State& state)
+	{
+		const vector<string>& words = BenchmarkWords::GetWords((unsigned int)state.range(0));
+		for (auto _ : state)
+		{
+			DawgBuilder* pDawgBuilder = new DawgBuilder();
+			for (unsigned int idx = 0; idx < words.size(); idx++)
+				pDawgBuilder->AddWord(words[idx].c_str());
+			pDawgBuilder->Finish();
+
+			state.PauseTiming();
+			delete pDawgBuilder;
+			state.ResumeTiming();
+		}
+
+		state.SetItemsProcessed(state.iterations() * words.size());
+	}
+
+	// WORD LIST PARSE
+	void BM_WordListParse(benchmark::State& state)
+	{
+		BenchmarkWordListParse(state, 1);
+	}
+
+	// WORD LIST PARSE PARALLEL
+	// on one thread per core
+	void BM_WordListParseParallel(benchmark::State& state)
+	{
+		BenchmarkWordListParse(state, 0);
+		state.counters["threads"] = (double)thread::hardware_concurrency();
+	}
+
+	// REGISTER TRIE BENCHMARKS
+	void RegisterTrieBenchmarks()
+	{
+		BenchmarkWords::RegisterBenchmark("WordList_Parse", BM_WordListParse)->Unit(benchmark::kMillisecond);
+		BenchmarkWords::RegisterBenchmark("WordList_ParseParallel", BM_WordListParseParallel)->Unit(benchmark::kMillisecond);
+		BenchmarkWords::RegisterBenchmark("Trie_AddWord", BM_TrieAddWord)->Unit(benchmark::kMillisecond);
+		BenchmarkWords::RegisterBenchmark("Trie_AddWordsParallel", BM_TrieAddWordsParallel)->Unit(benchmark::kMillisecond);
+		BenchmarkWords::RegisterBenchmark("Trie_Compress", BM_TrieCompress)->Unit(benchmark::kMillisecond);
+		BenchmarkWords::RegisterBenchmark("Trie_CompressParallel", BM_TrieCompressParallel)->Unit(benchmark::kMillisecond);
+		BenchmarkWords::RegisterBenchmark("Trie_SaveAsDawg", BM_TrieSaveAsDawg)->Unit(benchmark::kMillisecond);
+		BenchmarkWords::RegisterBenchmark("DawgBuilder_Build", BM_DawgBuilderBuild)->Unit(benchmark::kMillisecond);
+	}
+}
@@ -3,6 +3,8 @@
 
 #include "BlockMemory.h"
 
+#include <cstdint>
+
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 using namespace LxpStd;
 
@@ -41,5 +43,105 @@ namespace LxpStdLibUnitTest
 				Assert::IsNotNull(blockMemory.Allocate(DEFAULT_ALLOC_SIZE), L"Multiple allocation for multiple blocks failed");
 			}
 		}
+
+		TEST_METHOD(BlockMemory_AllocateAligned)
+		{
+			BlockMemory blockMemory;
+
+			blockMemory.Allocate(1);
+			void* pMemory = blockMemory.Allocate(DEFAULT_ALLOC_SIZE, 64);
+			Assert::AreEqual(0U, (unsigned int)((uintptr_t)pMemory % 64), L"Allocation is not aligned!");
+
+			double* pDoubles = blockMemory.Allocate<double>(DEFAULT_ALLOC_SIZE);
+			Assert::AreEqual(0U, (unsigned int)((uintptr_t)pDoubles % alignof(double)), L"Typed allocation is not aligned!");
+		}
+
+		TEST_METHOD(BlockMemory_AllocateLarge)
+		{
+			BlockMemory blockMemory;
+			BlockMemoryStats stats;
+
+			char* pMemory = (char*)blockMemory.Allocate(BlockMemory::DEFAULT_BLOCK_SIZE * 3);
+			Assert::IsNotNull(pMemory, L"Large allocation failed");
+			pMemory[BlockMemory::DEFAULT_BLOCK_SIZE * 3 - 1] = 'A';
+
+			blockMemory.GetStats(stats);
+			Assert::AreEqual(1U, stats.numLargeAllocations, L"Large allocation is not counted!");
+			Assert::AreEqual(0U, stats.numBlocks, L"Large allocation used a block!");
+		}
+
+		TEST_METHOD(BlockMemory_Reset)
+		{
+			BlockMemory blockMemory;
+			BlockMemoryStats stats;
+
+			for (int idx = 0; idx < NUM_MULTIPLE_ALLOCS_FOR_MULTIPLE_BLOCKS; idx++)
+				blockMemory.Allocate(DEFAULT_ALLOC_SIZE);
+			blockMemory.GetStats(stats);
+			unsigned int numBlocks = stats.numBlocks;
+			Assert::AreEqual((size_t)NUM_MULTIPLE_ALLOCS_FOR_MULTIPLE_BLOCKS * DEFAULT_ALLOC_SIZE, stats.bytesAllocated, L"Bytes allocated does not match!");
+			Assert::IsTrue(stats.bytesAllocated + stats.bytesWasted <= stats.bytesReserved, L"Stats do not add up!");
+
+			// the same allocations again use the kept blocks
+			blockMemory.Reset();
+			blockMemory.GetStats(stats);
+			Assert::AreEqual((size_t)0, stats.bytesAllocated, L"Bytes allocated is not 0 after Reset!");
+			Assert::AreEqual(numBlocks, stats.numBlocks, L"Reset did not keep the blocks!");
+
+			for (int idx = 0; idx < NUM_MULTIPLE_ALLOCS_FOR_MULTIPLE_BLOCKS; idx++)
+				blockMemory.Allocate(DEFAULT_ALLOC_SIZE);
+			blockMemory.GetStats(stats);
+			Assert::AreEqual(numBlocks, stats.numBlocks, L"Blocks were not reused after Reset!");
+
+			blockMemory.DeallocateAll();
+			blockMemory.GetStats(stats);
+			Assert::AreEqual(0U, stats.numBlocks, L"Blocks are left after DeallocateAll!");
+		}
+
+		TEST_METHOD(BlockMemory_Release)
+		{
+			BlockMemory blockMemory;
+			BlockMemoryStats stats;
+			BlockMemoryMark mark;
+
+			blockMemory.Allocate(DEFAULT_ALLOC_SIZE);
+			blockMemory.GetMark(mark);
+			char* pMemory = (char*)blockMemory.Allocate(DEFAULT_ALLOC_SIZE);
+
+			// allocations after the mark (in more blocks and large) are released
+			for (int idx = 0; idx < NUM_MULTIPLE_ALLOCS_FOR_MULTIPLE_BLOCKS; idx++)
+				blockMemory.Allocate(DEFAULT_ALLOC_SIZE);
+			blockMemory.Allocate(BlockMemory::DEFAULT_BLOCK_SIZE * 2);
+			blockMemory.GetStats(stats);
+			unsigned int numBlocks = stats.numBlocks;
+
+			blockMemory.Release(mark);
+			blockMemory.GetStats(stats);
+			Assert::AreEqual((size_t)DEFAULT_ALLOC_SIZE, stats.bytesAllocated, L"Bytes allocated does not match after Release!");
+			Assert::AreEqual(0U, stats.numLargeAllocations, L"Large allocation is not released!");
+			Assert::AreEqual(numBlocks, stats.numBlocks, L"Release did not keep the blocks!");
+			Assert::IsTrue(pMemory == blockMemory.Allocate(DEFAULT_ALLOC_SIZE), L"Memory after the mark is not reused!");
+		}
+
+		TEST_METHOD(BlockMemory_BlockSources)
+		{
+			BlockMemory virtualMemory(BlockMemory::DEFAULT_BLOCK_SIZE, BlockMemory::BlockSource::VIRTUAL_MEMORY);
+			BlockMemory hugePages(BlockMemory::HUGE_PAGE_SIZE, BlockMemory::BlockSource::HUGE_PAGES);
+
+			for (int idx = 0; idx < NUM_MULTIPLE_ALLOCS_FOR_MULTIPLE_BLOCKS; idx++)
+			{
+				char* pMemory = (char*)virtualMemory.Allocate(DEFAULT_ALLOC_SIZE);
+				Assert::IsNotNull(pMemory, L"Virtual memory allocation failed");
+				pMemory[DEFAULT_ALLOC_SIZE - 1] = 'A';
+
+				pMemory = (char*)hugePages.Allocate(DEFAULT_ALLOC_SIZE);
+				Assert::IsNotNull(pMemory, L"Huge page allocation failed");
+				pMemory[DEFAULT_ALLOC_SIZE - 1] = 'A';
+			}
+
+			char* pLarge = (char*)hugePages.Allocate(BlockMemory::HUGE_PAGE_SIZE + 1);
+			Assert::IsNotNull(pLarge, L"Large huge page allocation failed");
+			pLarge[BlockMemory::HUGE_PAGE_SIZE] = 'A';
+		}
 	};
 }
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "DawgBuilder.h"
+#include "Trie.h"
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace LxpStd;
+using namespace std;
+
+namespace LxpStdLibUnitTest
+{
+	TEST_CLASS(DawgBuilderUnitTest)
+	{
+	private:
+		static const int numWordsInLexicon = 7;
+		const char* lexicon[numWordsInLexicon] = { "BAT", "BATS", "CAR", "CARS", "CAT", "CATS", "FAT" };	// sorted
+
+		void BuildTrie(Trie& trie)
+		{
+			for (int idx = 0; idx < numWordsInLexicon; idx++)
+				trie.AddWord(lexicon[idx]);
+
+			while (trie.Compress() == false)
+			{
+				// do nothing
+			}
+		}
+
+		void BuildDawgBuilder(DawgBuilder& dawgBuilder)
+		{
+			for (int idx = 0; idx < numWordsInLexicon; idx++)
+				dawgBuilder.AddWord(lexicon[idx]);
+
+			dawgBuilder.Finish();
+		}
+
+		// section table and nodes (the header has the date and the lexicon name)
+		vector<char> ReadDawgNodes(const string& fileName)
+		{
+			ifstream dawgStream(fileName, ifstream::in | ifstream::binary);
+			vector<char> contents((istreambuf_iterator<char>(dawgStream)), istreambuf_iterator<char>());
+			return vector<char>(contents.begin() + DawgFile::HEADER_SIZE, contents.end());
+		}
+
+	public:
+		TEST_METHOD(DawgBuilder_Diagnostics)
+		{
+			Trie trie;
+			DawgBuilder dawgBuilder;
+			TrieDiagnostics expected;
+			TrieDiagnostics diagnostics;
+
+			BuildTrie(trie);
+			BuildDawgBuilder(dawgBuilder);
+
+			trie.GetDiagnostics(expected);
+			dawgBuilder.GetDiagnostics(diagnostics);
+			Assert::AreEqual(expected.numWords, diagnostics.numWords, L"diagnostics.numWords does not match!");
+			Assert::AreEqual(expected.numWordLetters, diagnostics.numWordLetters, L"diagnostics.numWordLetters does not match!");
+			Assert::AreEqual(expected.numNodes, diagnostics.numNodes, L"diagnostics.numNodes does not match!");
+			Assert::AreEqual(expected.numReversePartWords, diagnostics.numReversePartWords, L"diagnostics.numReversePartWords does not match!");
+			Assert::AreEqual(expected.numLetters, diagnostics.numLetters, L"diagnostics.numLetters does not match!");
+			Assert::AreEqual(expected.numFirstChildrenBeforeCompression, diagnostics.numFirstChildrenBeforeCompression,
+							 L"diagnostics.numFirstChildrenBeforeCompression does not match!");
+			Assert::AreEqual(expected.numFirstChildrenAfterCompression, diagnostics.numFirstChildrenAfterCompression,
+							 L"diagnostics.numFirstChildrenAfterCompression does not match!");
+			Assert::AreEqual(expected.numNodesAfterCompression, diagnostics.numNodesAfterCompression,
+							 L"diagnostics.numNodesAfterCompression does not match!");
+		}
+
+		TEST_METHOD(DawgBuilder_SameDawgAsTrie)
+		{
+			string lexiconName("Unit test lexicon");
+			string trieFileName("UnitTestTrieDawg.lxd");
+			string builderFileName("UnitTestBuilderDawg.lxd");
+
+			Trie trie;
+			BuildTrie(trie);
+			trie.SaveAsDawg(trieFileName, lexiconName);
+
+			DawgBuilder dawgBuilder;
+			BuildDawgBuilder(dawgBuilder);
+			dawgBuilder.SaveAsDawg(builderFileName, lexiconName);
+
+			Assert::IsTrue(ReadDawgNodes(trieFileName) == ReadDawgNodes(builderFileName), L"Dawg nodes do not match!");
+		}
+
+		TEST_METHOD(DawgBuilder_UnsortedWords)
+		{
+			DawgBuilder dawgBuilder;
+			dawgBuilder.AddWord("CAT");
+
+			bool isExceptionThrown = false;
+			try
+			{
+				dawgBuilder.AddWord("BAT");
+			}
+			catch (std::exception&)
+			{
+				isExceptionThrown = true;
+			}
+			Assert::IsTrue(isExceptionThrown, L"Unsorted word did not throw!");
+		}
+	};
+}
@@ -1,7 +1,16 @@
 #include "pch.h"
 #include "CppUnitTest.h"
 #include "Dawg.h"
+#include "DawgBuilder.h"
+#include "Trie.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
 #include <string>
+#include <thread>
+#include <vector>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 using namespace LxpStd;
@@ -16,14 +25,38 @@ namespace LxpStdLibUnitTest
 		static const int numWords = 2;
 		DawgNode nodes[numNodes] =
 		{
-			{ 1U, ' ', 0U, 1U },
-			{ 2U, '*', 0U, 1U },
-			{ 3U, 'B', 0U, 1U },
-			{ 4U, 'A', 0U, 1U },
-			{ 5U, 'T', 1U, 1U },
-			{ 0U, 'S', 1U, 1U }
+			{ 1U, ' ', 0U, 1U, 0U },
+			{ 2U, '*', 0U, 1U, 0U },
+			{ 3U, 'B', 0U, 1U, 0U },
+			{ 4U, 'A', 0U, 1U, 0U },
+			{ 5U, 'T', 1U, 1U, 0U },
+			{ 0U, 'S', 1U, 1U, 0U }
 		};
 		
+		// whole file (empty if there is none)
+		static string ReadFile(const string& fileName)
+		{
+			ifstream fileStream(fileName, ifstream::in | ifstream::binary);
+			return string(istreambuf_iterator<char>(fileStream), istreambuf_iterator<char>());
+		}
+
+		static bool IsFile(const string& fileName)
+		{
+			ifstream fileStream(fileName, ifstream::in | ifstream::binary);
+			return fileStream.is_open();
+		}
+
+		// any temporary file of the AtomicFileWriters of the file from firstTempNumber on
+		static bool IsTempFile(const string& fileName, unsigned int firstTempNumber)
+		{
+			for (unsigned int tempNumber = firstTempNumber; tempNumber < AtomicFileWriter::NextTempNumber(); tempNumber++)
+			{
+				if (IsFile(AtomicFileWriter::TempFileName(fileName, tempNumber)))
+					return true;
+			}
+			return false;
+		}
+
 	public:
 		TEST_METHOD(DawgCreator_AddNodes)
 		{
@@ -40,5 +73,621 @@ namespace LxpStdLibUnitTest
 			// not sure what can be asserted!
 			// how about no exception thrown?
 		}
+
+		TEST_METHOD(DawgCreator_SaveV1)
+		{
+			string lexiconName("Unit test lexicon");
+			string fileName("UnitTestDawgV1.lxd");
+
+			DawgCreator dawgCreator(lexiconName, numNodes, numWords, DawgFileFormat::V1);
+			for (int idx = 0; idx < numNodes; idx++)
+				dawgCreator.AddNode(nodes[idx]);
+
+			dawgCreator.SaveDawg(fileName);
+
+			// the V1 file (shorter than a V2 header) loads
+			Dawg dawg;
+			dawg.Initialize(fileName);
+			Assert::IsTrue(dawg.GetFileFormat() == DawgFileFormat::V1, L"File format is not V1!");
+			Assert::IsTrue(dawg.IsWord("BAT") && dawg.IsWord("BATS"), L"Words are missing!");
+		}
+
+		TEST_METHOD(DawgCreator_StreamDawg)
+		{
+			string lexiconName("Unit test lexicon");
+			string fileName("UnitTestDawg.lxd");
+			string streamFileName("UnitTestDawgStream.lxd");
+			remove(streamFileName.c_str());	// (left by a failed run)
+			unsigned int firstTempNumber = AtomicFileWriter::NextTempNumber();
+
+			const DawgFileFormat fileFormats[] = { DawgFileFormat::V1, DawgFileFormat::V2 };
+			for (DawgFileFormat fileFormat : fileFormats)
+			{
+				DawgCreator dawgCreator(lexiconName, numNodes, numWords, fileFormat);
+				DawgCreator streamDawgCreator(lexiconName, numNodes, numWords, fileFormat);
+				streamDawgCreator.StreamDawg(streamFileName);
+				for (int idx = 0; idx < numNodes; idx++)
+				{
+					dawgCreator.AddNode(nodes[idx]);
+					streamDawgCreator.AddNode(nodes[idx]);
+				}
+
+				// nothing shows up before the file is saved
+				Assert::IsFalse(IsFile(streamFileName), L"Streamed file shows up before it is saved!");
+
+				dawgCreator.SaveDawg(fileName);
+				streamDawgCreator.SaveDawg(streamFileName);
+				Assert::IsTrue(ReadFile(fileName) == ReadFile(streamFileName), L"Streamed file does not match!");
+				Assert::IsFalse(IsTempFile(streamFileName, firstTempNumber), L"Temporary file is left!");
+
+				Dawg dawg;
+				dawg.Initialize(streamFileName);
+				Assert::IsTrue(dawg.IsWord("BAT") && dawg.IsWord("BATS"), L"Words are missing!");
+				remove(streamFileName.c_str());
+			}
+
+			// a stream that fails keeps the last file (and no temporary file)
+			{
+				DawgCreator dawgCreator(lexiconName, numNodes, numWords);
+				dawgCreator.StreamDawg(streamFileName);
+				for (int idx = 0; idx < numNodes; idx++)
+					dawgCreator.AddNode(nodes[idx]);
+				dawgCreator.SaveDawg(streamFileName);
+			}
+			string savedData = ReadFile(streamFileName);
+
+			bool isExceptionThrown = false;
+			try
+			{
+				DawgCreator dawgCreator(lexiconName, numNodes, numWords);
+				dawgCreator.StreamDawg(streamFileName);
+				for (int idx = 0; idx < numNodes - 1; idx++)
+					dawgCreator.AddNode(nodes[idx]);
+				dawgCreator.SaveDawg(streamFileName);
+			}
+			catch (std::exception&)
+			{
+				isExceptionThrown = true;
+			}
+			Assert::IsTrue(isExceptionThrown, L"Missing nodes did not throw!");
+			Assert::IsTrue(ReadFile(streamFileName) == savedData, L"Failed stream changed the file!");
+			Assert::IsFalse(IsTempFile(streamFileName, firstTempNumber), L"Temporary file is left!");
+
+			// two streams of the same file at once don't write over each other (or over a file
+			// with the old name of the temporary file)
+			string oldTempFileName = streamFileName + AtomicFileWriter::TEMP_SUFFIX;
+			ofstream(oldTempFileName) << "not a Dawg";
+			{
+				DawgCreator dawgCreator1(lexiconName, numNodes, numWords);
+				DawgCreator dawgCreator2(lexiconName, numNodes, numWords);
+				dawgCreator1.StreamDawg(streamFileName);
+				dawgCreator2.StreamDawg(streamFileName);
+				for (int idx = 0; idx < numNodes; idx++)
+				{
+					dawgCreator1.AddNode(nodes[idx]);
+					dawgCreator2.AddNode(nodes[idx]);
+				}
+				dawgCreator1.SaveDawg(streamFileName);
+				dawgCreator2.SaveDawg(streamFileName);
+
+				Dawg dawg;
+				dawg.Initialize(streamFileName);
+				Assert::IsTrue(dawg.IsWord("BAT") && dawg.IsWord("BATS"), L"Words are missing!");
+			}
+			Assert::IsFalse(IsTempFile(streamFileName, firstTempNumber), L"Temporary file is left!");
+			Assert::IsTrue(ReadFile(oldTempFileName) == "not a Dawg", L"Existing file was written over!");
+			remove(oldTempFileName.c_str());
+
+			// only depth first without child masks
+			isExceptionThrown = false;
+			try
+			{
+				DawgCreator dawgCreator(lexiconName, numNodes, numWords);
+				dawgCreator.StreamDawg(streamFileName);
+				for (int idx = 0; idx < numNodes; idx++)
+					dawgCreator.AddNode(nodes[idx]);
+				dawgCreator.SaveDawg(streamFileName, DawgNodeLayout::DEPTH_FIRST, vector<string>(), true);
+			}
+			catch (std::exception&)
+			{
+				isExceptionThrown = true;
+			}
+			Assert::IsTrue(isExceptionThrown, L"Streamed child masks did not throw!");
+			Assert::IsFalse(IsTempFile(streamFileName, firstTempNumber), L"Temporary file is left!");
+			remove(streamFileName.c_str());
+		}
+	};
+
+	TEST_CLASS(DawgUnitTest)
+	{
+	private:
+		static const int numWordsInLexicon = 16;
+		const char* lexicon[numWordsInLexicon] = { "ACT", "AT", "BAT", "BATS", "CAR", "CARS", "CAT", "CATS",
+												   "EAST", "EAT", "EATS", "ETA", "FAT", "SEAT", "TEA", "TEAS" };
+
+		// builds the test lexicon into a Dawg file
+		void SaveDawg(const string& fileName, DawgFileFormat fileFormat)
+		{
+			string lexiconName("Dawg unit test lexicon");
+
+			Trie trie;
+			for (int idx = 0; idx < numWordsInLexicon; idx++)
+				trie.AddWord(lexicon[idx]);
+
+			while (trie.Compress() == false)
+			{
+				// do nothing
+			}
+			trie.SaveAsDawg(fileName, lexiconName, fileFormat);
+		}
+
+		// builds the test lexicon into a Dawg file and initializes the dawg
+		void InitializeDawg(Dawg& dawg)
+		{
+			string fileName("DawgUnitTest.lxd");
+			SaveDawg(fileName, DawgFileFormat::V2);
+			dawg.Initialize(fileName);
+		}
+
+		// false if Initialize throws
+		static bool IsInitialized(Dawg& dawg, const string& fileName, Dawg::LoadMode loadMode)
+		{
+			try
+			{
+				dawg.Initialize(fileName, loadMode);
+			}
+			catch (std::exception&)
+			{
+				return false;
+			}
+
+			return true;
+		}
+
+		// collects the words found by a query
+		static Dawg::WordCallback Collect(vector<string>& words)
+		{
+			return [&words](const char* pWord) { words.push_back(string(pWord)); };
+		}
+
+	public:
+		TEST_METHOD(Dawg_Anagrams)
+		{
+			Dawg dawg;
+			InitializeDawg(dawg);
+			vector<string> words;
+
+			Assert::AreEqual(3U, dawg.Anagrams("TAE", Collect(words)), L"TAE anagrams do not match!");
+			Assert::IsTrue(words[0] == "EAT" && words[1] == "ETA" && words[2] == "TEA", L"TAE words do not match!");
+
+			words.clear();
+			Assert::AreEqual(4U, dawg.SubAnagrams("TAE", Collect(words)), L"TAE sub anagrams do not match!");
+			Assert::IsTrue(words[0] == "AT", L"TAE sub anagram words do not match!");
+
+			// blanks
+			Assert::AreEqual(6U, dawg.Anagrams("S?AT", Collect(words)), L"S?AT anagrams do not match!");
+			Assert::AreEqual(6U, dawg.Anagrams("??AT", Collect(words)), L"??AT anagrams do not match!");
+			Assert::AreEqual(0U, dawg.Anagrams("QAT", Collect(words)), L"QAT anagrams do not match!");
+		}
+
+		TEST_METHOD(Dawg_AreWords)
+		{
+			Dawg dawg;
+			InitializeDawg(dawg);
+
+			// more words than lanes, including an empty word
+			const char* pWords = "CATCATSCADOGTEASEATSETAXYZSEATTEFAT";
+			unsigned int offsets[] = { 0, 3, 7, 9, 9, 12, 16, 20, 23, 26, 30, 32, 35 };
+			unsigned int numWords = 12;
+			unsigned int isWordBits = 0xFFFFFFFF;
+
+			Assert::AreEqual(7U, dawg.AreWords(pWords, offsets, numWords, &isWordBits), L"Number of words does not match!");
+			Assert::AreEqual(0x00000AE3U, isWordBits, L"Word bits do not match!");
+
+			// no words
+			Assert::AreEqual(0U, dawg.AreWords(pWords, offsets, 0, &isWordBits), L"Empty batch does not match!");
+		}
+
+		TEST_METHOD(Dawg_ChildMasks)
+		{
+			Dawg dawg;
+			InitializeDawg(dawg);
+
+			const char* pWords = "CATSEATSXCABTEAZ";
+			for (int pass = 0; pass < 2; pass++)
+			{
+				// same results scanning the sibling lists and jumping with the masks
+				if (pass == 1)
+					dawg.BuildChildMasks();
+
+				Assert::IsTrue(dawg.IsWord(pWords, 3), L"CAT is not a word!");
+				Assert::IsTrue(dawg.IsWord(pWords, 4), L"CATS is not a word!");
+				Assert::IsTrue(dawg.IsWord(pWords + 4, 4), L"EATS is not a word!");
+				Assert::IsFalse(dawg.IsWord(pWords, 2), L"CA is a word!");
+				Assert::IsFalse(dawg.IsWord(pWords, 0), L"Empty string is a word!");
+				Assert::IsFalse(dawg.IsWord(pWords + 8, 3), L"XCA is a word!");
+				Assert::IsFalse(dawg.IsWord(pWords + 12, 4), L"TEAZ is a word!");
+				Assert::IsFalse(dawg.IsWord("cat", 3), L"Lower case cat is a word!");
+				Assert::IsTrue(dawg.IsReversePartWord("TAC", 3), L"TAC is not a reverse part word!");
+				Assert::IsFalse(dawg.IsReversePartWord("CAT", 3), L"CAT is a reverse part word!");
+
+				unsigned int offsets[] = { 0, 3, 4, 8, 11, 16 };
+				unsigned int isWordBits = 0;
+				Assert::AreEqual(2U, dawg.AreWords(pWords, offsets, 5, &isWordBits), L"Number of words does not match!");
+				Assert::AreEqual(0x00000005U, isWordBits, L"Word bits do not match!");
+			}
+		}
+
+		TEST_METHOD(Dawg_ChildMasksSection)
+		{
+			const Dawg::LoadMode loadModes[] = { Dawg::LoadMode::COPY, Dawg::LoadMode::MEMORY_MAPPED, Dawg::LoadMode::PACKED };
+			const char* fragments[] = { "A", "AT", "ATS", "B", "BA", "CAT", "CATS", "E", "ET", "ETA", "TA", "TAC", "TAE",
+										"SAE", "Q", "QA", "AQ", "a", "aT", "Aq", "*", "<", "ZZZ" };
+			string fileName("DawgChildMasksUnitTest.lxd");
+
+			Trie trie;
+			for (int idx = 0; idx < numWordsInLexicon; idx++)
+				trie.AddWord(lexicon[idx]);
+			while (trie.Compress() == false)
+			{
+				// do nothing
+			}
+			trie.SaveAsDawg(fileName, "Dawg unit test lexicon", DawgFileFormat::V2, DawgNodeLayout::DEPTH_FIRST, vector<string>(), true);
+
+			// loaded (in place when mapped) or skipped, with the same results as scanning
+			Dawg scanDawg;
+			scanDawg.Initialize(fileName);
+			for (Dawg::LoadMode loadMode : loadModes)
+			{
+				Dawg dawg;
+				dawg.Initialize(fileName, loadMode, true);
+				for (const char* pFragment : fragments)
+				{
+					unsigned int length = (unsigned int)strlen(pFragment);
+					Assert::AreEqual(scanDawg.IsWord(pFragment, length), dawg.IsWord(pFragment, length), L"IsWord does not match!");
+					Assert::AreEqual(scanDawg.IsReversePartWord(pFragment, length), dawg.IsReversePartWord(pFragment, length),
+									 L"IsReversePartWord does not match!");
+				}
+
+				for (int idx = 0; idx < numWordsInLexicon; idx++)
+					Assert::IsTrue(dawg.IsWord(string(lexicon[idx])), L"Word is missing!");
+
+				const char* pWords = "CATCATSCADOGTEASEATSETAXYZSEATTEFATATA";
+				unsigned int offsets[] = { 0, 3, 7, 9, 9, 12, 16, 20, 23, 26, 30, 32, 35, 37, 38 };
+				unsigned int isWordBits = 0;
+				Assert::AreEqual(8U, dawg.AreWords(pWords, offsets, 14, &isWordBits), L"Number of words does not match!");
+				Assert::AreEqual(0x00001AE3U, isWordBits, L"Word bits do not match!");
+			}
+
+			Assert::IsTrue(scanDawg.IsWord("CATS", 4), L"CATS is not a word without the child masks!");
+
+			// the child masks are part of the checksum
+			{
+				fstream dawgStream(fileName, fstream::in | fstream::out | fstream::binary);
+				dawgStream.seekg(0, dawgStream.end);
+				dawgStream.seekp((streamoff)dawgStream.tellg() - DawgFile::CHILD_MASK_SIZE);
+				dawgStream.put('X');
+			}
+
+			Dawg dawg;
+			Assert::IsFalse(IsInitialized(dawg, fileName, Dawg::LoadMode::COPY), L"Checksum did not fail!");
+
+			// V1 files have no sections
+			bool isExceptionThrown = false;
+			try
+			{
+				trie.SaveAsDawg(fileName, "Dawg unit test lexicon", DawgFileFormat::V1, DawgNodeLayout::DEPTH_FIRST, vector<string>(), true);
+			}
+			catch (std::exception&)
+			{
+				isExceptionThrown = true;
+			}
+			Assert::IsTrue(isExceptionThrown, L"Child masks in a V1 file did not throw!");
+		}
+
+		TEST_METHOD(Dawg_Hooks)
+		{
+			Dawg dawg;
+			InitializeDawg(dawg);
+			string hooks;
+
+			dawg.GetFrontHooks("AT", hooks);
+			Assert::IsTrue(hooks == "BCEF", L"AT front hooks do not match!");
+
+			dawg.GetFrontHooks("EAT", hooks);
+			Assert::IsTrue(hooks == "S", L"EAT front hooks do not match!");
+
+			dawg.GetFrontHooks("TEA", hooks);
+			Assert::IsTrue(hooks.empty(), L"TEA front hooks do not match!");
+
+			dawg.GetBackHooks("CAT", hooks);
+			Assert::IsTrue(hooks == "S", L"CAT back hooks do not match!");
+
+			dawg.GetBackHooks("EA", hooks);
+			Assert::IsTrue(hooks == "T", L"EA back hooks do not match!");
+
+			dawg.GetBackHooks("XYZ", hooks);
+			Assert::IsTrue(hooks.empty(), L"XYZ back hooks do not match!");
+
+			// either case
+			dawg.GetFrontHooks("at", hooks);
+			Assert::IsTrue(hooks == "BCEF", L"at front hooks do not match!");
+
+			dawg.GetBackHooks("Cat", hooks);
+			Assert::IsTrue(hooks == "S", L"Cat back hooks do not match!");
+		}
+
+		TEST_METHOD(Dawg_WordsContaining)
+		{
+			Dawg dawg;
+			InitializeDawg(dawg);
+			vector<string> words;
+
+			Assert::AreEqual(9U, dawg.WordsContaining("AT", Collect(words)), L"AT words containing do not match!");
+			Assert::AreEqual(14U, dawg.WordsContaining("T", Collect(words)), L"T words containing do not match!");
+			Assert::AreEqual(2U, dawg.WordsContaining("CAR", Collect(words)), L"CAR words containing do not match!");
+			Assert::AreEqual(0U, dawg.WordsContaining("TT", Collect(words)), L"TT words containing do not match!");
+
+			words.clear();
+			Assert::AreEqual(2U, dawg.WordsContaining("cAr", Collect(words)), L"cAr words containing do not match!");
+			Assert::IsTrue(words[0] == "CAR" || words[0] == "CARS", L"cAr words do not match!");
+		}
+
+		TEST_METHOD(Dawg_Match)
+		{
+			Dawg dawg;
+			InitializeDawg(dawg);
+			vector<string> words;
+
+			Assert::AreEqual(2U, dawg.Match("C?T*", Collect(words)), L"C?T* matches do not match!");
+			Assert::IsTrue(words[0] == "CAT" && words[1] == "CATS", L"C?T* words do not match!");
+
+			words.clear();
+			Assert::AreEqual(4U, dawg.Match("?AT", Collect(words)), L"?AT matches do not match!");
+			Assert::IsTrue(words[0] == "BAT" && words[3] == "FAT", L"?AT words do not match!");
+
+			words.clear();
+			Assert::AreEqual(3U, dawg.Match("^CAT", Collect(words)), L"^CAT matches do not match!");
+			Assert::IsTrue(words[0] == "BAT" && words[1] == "EAT" && words[2] == "FAT", L"^CAT words do not match!");
+
+			// each word is found once even when the pattern can match it in many ways
+			words.clear();
+			Assert::AreEqual(11U, dawg.Match("*A*T*", Collect(words)), L"*A*T* matches do not match!");
+
+			words.clear();
+			Assert::AreEqual((unsigned int)numWordsInLexicon, dawg.Match("*", Collect(words)), L"* matches do not match!");
+
+			words.clear();
+			Assert::AreEqual(0U, dawg.Match("?", Collect(words)), L"? matches do not match!");
+			Assert::AreEqual(0U, dawg.Match("", Collect(words)), L"empty pattern matches do not match!");
+		}
+
+		TEST_METHOD(Dawg_FileFormats)
+		{
+			const Dawg::LoadMode loadModes[] = { Dawg::LoadMode::COPY, Dawg::LoadMode::MEMORY_MAPPED, Dawg::LoadMode::PACKED };
+			const DawgFileFormat fileFormats[] = { DawgFileFormat::V1, DawgFileFormat::V2 };
+			string fileName("DawgFormatUnitTest.lxd");
+
+			// both versions load either way
+			for (DawgFileFormat fileFormat : fileFormats)
+			{
+				SaveDawg(fileName, fileFormat);
+				for (Dawg::LoadMode loadMode : loadModes)
+				{
+					Dawg dawg;
+					Assert::IsTrue(IsInitialized(dawg, fileName, loadMode), L"Dawg file did not load!");
+					Assert::IsTrue(dawg.GetFileFormat() == fileFormat, L"File format does not match!");
+
+					DawgHeader header;
+					dawg.GetHeader(header);
+					Assert::AreEqual((unsigned int)numWordsInLexicon, header.numWords, L"header.numWords do not match!");
+					Assert::AreEqual("Dawg unit test lexicon", (const char*)header.lexiconName, L"Lexicon name does not match!");
+					for (int idx = 0; idx < numWordsInLexicon; idx++)
+						Assert::IsTrue(dawg.IsWord(string(lexicon[idx])), L"Word is missing!");
+				}
+			}
+
+			// a changed byte fails the checksum (which is not checked when mapped)
+			SaveDawg(fileName, DawgFileFormat::V2);
+			{
+				fstream dawgStream(fileName, fstream::in | fstream::out | fstream::binary);
+				dawgStream.seekp(DawgFile::HEADER_SIZE + DawgFile::SECTION_ENTRY_SIZE);
+				dawgStream.put('X');
+			}
+
+			Dawg dawg;
+			Assert::IsFalse(IsInitialized(dawg, fileName, Dawg::LoadMode::COPY), L"Checksum did not fail!");
+			Assert::IsFalse(IsInitialized(dawg, fileName, Dawg::LoadMode::PACKED), L"Packed checksum did not fail!");
+			Assert::IsTrue(IsInitialized(dawg, fileName, Dawg::LoadMode::MEMORY_MAPPED), L"Mapped file did not load!");
+
+			// a changed byte in the section table fails the header checksum, even when mapped
+			SaveDawg(fileName, DawgFileFormat::V2);
+			{
+				fstream dawgStream(fileName, fstream::in | fstream::out | fstream::binary);
+				dawgStream.seekp(DawgFile::HEADER_SIZE + 8);
+				dawgStream.put('\x01');
+			}
+			Assert::IsFalse(IsInitialized(dawg, fileName, Dawg::LoadMode::MEMORY_MAPPED), L"Mapped header checksum did not fail!");
+			Assert::IsFalse(IsInitialized(dawg, fileName, Dawg::LoadMode::COPY), L"Header checksum did not fail!");
+
+			// V1 can't have more than 4M nodes
+			bool isExceptionThrown = false;
+			try
+			{
+				DawgCreator dawgCreator("Too many nodes", DawgFile::V1_MAX_NODES + 1, 1, DawgFileFormat::V1);
+			}
+			catch (std::exception&)
+			{
+				isExceptionThrown = true;
+			}
+			Assert::IsTrue(isExceptionThrown, L"Too many nodes for V1 did not throw!");
+		}
+
+		TEST_METHOD(Dawg_NodeLayouts)
+		{
+			const DawgNodeLayout nodeLayouts[] = { DawgNodeLayout::DEPTH_FIRST, DawgNodeLayout::BREADTH_FIRST, DawgNodeLayout::ACCESS_FREQUENCY };
+			string fileName("DawgLayoutUnitTest.lxd");
+
+			// enough random words for more than HOT_NODES nodes (only the hot ones are moved)
+			vector<string> words;
+			unsigned int seed = 12345;
+			for (unsigned int idx = 0; idx < 20000; idx++)
+			{
+				string word;
+				for (unsigned int letterIdx = 0; letterIdx < 4 + idx % 6; letterIdx++)
+				{
+					seed = seed * 1103515245 + 12345;
+					word.push_back((char)(Dawg::START_LETTER + (seed >> 16) % 26));
+				}
+				words.push_back(word);
+			}
+			sort(words.begin(), words.end());
+			words.erase(unique(words.begin(), words.end()), words.end());
+
+			DawgBuilder dawgBuilder;
+			for (unsigned int idx = 0; idx < words.size(); idx++)
+				dawgBuilder.AddWord(words[idx].c_str());
+			dawgBuilder.Finish();
+
+			vector<string> sampleWords(words.begin(), words.begin() + 100);
+			sampleWords.push_back("xyz");	// lower case and not a word
+			unsigned int numReversePartWords = 0;
+			for (DawgNodeLayout nodeLayout : nodeLayouts)
+			{
+				// (loading counts the words)
+				dawgBuilder.SaveAsDawg(fileName, "Layout unit test lexicon", DawgFileFormat::V2, nodeLayout, sampleWords);
+				Dawg dawg;
+				Assert::IsTrue(IsInitialized(dawg, fileName, Dawg::LoadMode::COPY), L"Laid out Dawg did not load!");
+
+				DawgHeader header;
+				dawg.GetHeader(header);
+				Assert::IsTrue(header.numNodes > DawgCreator::HOT_NODES, L"Not enough nodes to test the layout!");
+				for (unsigned int idx = 0; idx < words.size(); idx++)
+					Assert::IsTrue(dawg.IsWord(words[idx]), L"Word is missing!");
+
+				if (nodeLayout == DawgNodeLayout::DEPTH_FIRST)
+					numReversePartWords = dawg.NumReversePartWords();
+				Assert::AreEqual(numReversePartWords, dawg.NumReversePartWords(), L"Reverse part words do not match!");
+				dawg.BuildChildMasks();	// sibling lists are still sorted
+			}
+
+			// a mapped Dawg counts them on the first calls, which can come from several threads
+			{
+				Dawg dawg;
+				Assert::IsTrue(IsInitialized(dawg, fileName, Dawg::LoadMode::MEMORY_MAPPED), L"Laid out Dawg did not map!");
+				vector<unsigned int> threadNumReversePartWords(4, 0);
+				vector<thread> threads;
+				for (unsigned int threadIdx = 0; threadIdx < threadNumReversePartWords.size(); threadIdx++)
+					threads.push_back(thread([&, threadIdx]() { threadNumReversePartWords[threadIdx] = dawg.NumReversePartWords(); }));
+				for (thread& queryThread : threads)
+					queryThread.join();
+				for (unsigned int threadCount : threadNumReversePartWords)
+					Assert::AreEqual(numReversePartWords, threadCount, L"Reverse part words do not match!");
+			}
+
+			// the small lexicon is laid out entirely
+			for (DawgNodeLayout nodeLayout : nodeLayouts)
+			{
+				Trie trie;
+				for (int idx = 0; idx < numWordsInLexicon; idx++)
+					trie.AddWord(lexicon[idx]);
+				while (trie.Compress() == false)
+				{
+					// do nothing
+				}
+				trie.SaveAsDawg(fileName, "Layout unit test lexicon", DawgFileFormat::V1, nodeLayout, vector<string>(1, "CATS"));
+
+				Dawg dawg;
+				dawg.Initialize(fileName);
+				vector<string> matches;
+				Assert::AreEqual((unsigned int)numWordsInLexicon, dawg.Match("*", Collect(matches)), L"* matches do not match!");
+				Assert::IsTrue(matches[0] == lexicon[0] && matches[numWordsInLexicon - 1] == lexicon[numWordsInLexicon - 1],
+							   L"* words do not match!");
+			}
+		}
+
+		TEST_METHOD(Dawg_Packed)
+		{
+			string fileName("DawgPackedUnitTest.lxd");
+			SaveDawg(fileName, DawgFileFormat::V2);
+
+			Dawg dawg;
+			Dawg packedDawg;
+			dawg.Initialize(fileName);
+			packedDawg.Initialize(fileName, Dawg::LoadMode::PACKED);
+			Assert::IsTrue(packedDawg.GetNodesSize() * 2 < dawg.GetNodesSize(), L"Packed nodes are not smaller!");
+			Assert::AreEqual(dawg.NumReversePartWords(), packedDawg.NumReversePartWords(), L"Reverse part words do not match!");
+
+			// the queries find the same words on the packed nodes
+			vector<string> words;
+			vector<string> packedWords;
+			Assert::AreEqual(dawg.Match("*", Collect(words)), packedDawg.Match("*", Collect(packedWords)), L"* matches do not match!");
+			Assert::AreEqual(dawg.SubAnagrams("??AT", Collect(words)), packedDawg.SubAnagrams("??AT", Collect(packedWords)),
+							 L"??AT sub anagrams do not match!");
+			Assert::AreEqual(dawg.WordsContaining("A", Collect(words)), packedDawg.WordsContaining("A", Collect(packedWords)),
+							 L"A words containing do not match!");
+			Assert::IsTrue(words == packedWords, L"Packed words do not match!");
+
+			string hooks;
+			string packedHooks;
+			dawg.GetFrontHooks("AT", hooks);
+			packedDawg.GetFrontHooks("AT", packedHooks);
+			Assert::IsTrue(hooks == packedHooks, L"AT front hooks do not match!");
+			dawg.GetBackHooks("CAT", hooks);
+			packedDawg.GetBackHooks("CAT", packedHooks);
+			Assert::IsTrue(hooks == packedHooks, L"CAT back hooks do not match!");
+
+			const char* pWords = "CATCATSCADOGTEASEATSETAXYZSEATTEFAT";
+			unsigned int offsets[] = { 0, 3, 7, 9, 9, 12, 16, 20, 23, 26, 30, 32, 35 };
+			unsigned int isWordBits = 0;
+			Assert::AreEqual(7U, packedDawg.AreWords(pWords, offsets, 12, &isWordBits), L"Number of words does not match!");
+			Assert::AreEqual(0x00000AE3U, isWordBits, L"Word bits do not match!");
+
+			// child masks are built from the packed nodes too
+			packedDawg.BuildChildMasks();
+			Assert::IsTrue(packedDawg.IsWord("CATS", 4), L"CATS is not a word!");
+			Assert::IsFalse(packedDawg.IsWord("CATT", 4), L"CATT is a word!");
+		}
+
+		TEST_METHOD(Dawg_ScratchMemory)
+		{
+			Dawg dawg;
+			InitializeDawg(dawg);
+			BlockMemoryStats stats;
+
+			// a query from the callback of another query
+			unsigned int numNestedWords = 0;
+			unsigned int numWords = dawg.Match("?AT", [&](const char* pWord)
+			{
+				numNestedWords += dawg.WordsContaining(pWord, [](const char*) {});
+			});
+			Assert::AreEqual(4U, numWords, L"?AT matches do not match!");
+			Assert::AreEqual(8U, numNestedWords, L"Nested words containing do not match!");
+
+			// queries leave nothing allocated
+			ScratchMemory::GetThreadStats(stats);
+			Assert::AreEqual((size_t)0, stats.bytesAllocated, L"Scratch memory is not released!");
+
+			// words longer than MAX_WORD_LENGTH
+			string longWord(Dawg::MAX_WORD_LENGTH * 2 + 1, 'A');
+			string fileName("DawgScratchUnitTest.lxd");
+			Trie trie;
+			trie.AddWord(longWord.c_str());
+			while (trie.Compress() == false)
+			{
+				// do nothing
+			}
+			trie.SaveAsDawg(fileName, "Long word lexicon");
+
+			Dawg longDawg;
+			longDawg.Initialize(fileName);
+			vector<string> words;
+			Assert::AreEqual(1U, longDawg.Match("A*", Collect(words)), L"Long word match does not match!");
+			Assert::IsTrue(words[0] == longWord, L"Long word does not match!");
+
+			words.clear();
+			Assert::AreEqual(1U, longDawg.WordsContaining("AA", Collect(words)), L"Long word containing does not match!");
+			Assert::IsTrue(words[0] == longWord, L"Long word containing word does not match!");
+		}
 	};
-}
\ No newline at end of file
+}
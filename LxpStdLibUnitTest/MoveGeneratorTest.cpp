@@ -0,0 +1,158 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "Board.h"
+#include "Dawg.h"
+#include "MoveGenerator.h"
+#include "Trie.h"
+#include <string>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace LxpStd;
+using namespace std;
+
+namespace LxpStdLibUnitTest
+{
+	TEST_CLASS(MoveGeneratorUnitTest)
+	{
+	private:
+		static const int numWordsInLexicon = 6;
+		const char* lexicon[numWordsInLexicon] = { "AS", "AT", "CAT", "CATS", "SCAT", "TA" };
+
+		// builds the test lexicon into a Dawg file and initializes the dawg
+		void InitializeDawg(Dawg& dawg)
+		{
+			string lexiconName("Move generator unit test lexicon");
+			string fileName("MoveGeneratorUnitTest.lxd");
+
+			Trie trie;
+			for (int idx = 0; idx < numWordsInLexicon; idx++)
+				trie.AddWord(lexicon[idx]);
+
+			while (trie.Compress() == false)
+			{
+				// do nothing
+			}
+			trie.SaveAsDawg(fileName, lexiconName);
+
+			dawg.Initialize(fileName);
+		}
+
+		// CAT across through the center square
+		static void PlaceCat(Board& board)
+		{
+			board.SetTile(Board::CENTER, Board::CENTER - 1, 'C');
+			board.SetTile(Board::CENTER, Board::CENTER, 'A');
+			board.SetTile(Board::CENTER, Board::CENTER + 1, 'T');
+		}
+
+		// collects the moves found
+		static MoveGenerator::MoveCallback Collect(vector<Move>& moves)
+		{
+			return [&moves](const Move& move) { moves.push_back(move); };
+		}
+
+		// finds a move by its position and word
+		static const Move* FindMove(const vector<Move>& moves, int row, int col, bool isAcross, const string& word)
+		{
+			for (unsigned int idx = 0; idx < moves.size(); idx++)
+			{
+				const Move& move = moves[idx];
+				if (move.row == row && move.col == col && move.isAcross == isAcross && word == move.word)
+					return &move;
+			}
+
+			return NULL;
+		}
+
+	public:
+		TEST_METHOD(MoveGenerator_FirstMove)
+		{
+			Dawg dawg;
+			InitializeDawg(dawg);
+			MoveGenerator moveGenerator(dawg);
+			Board board;
+			vector<Move> moves;
+
+			// AT and TA, across and down, covering the center square
+			Assert::AreEqual(8U, moveGenerator.GenerateMoves(board, "TA", Collect(moves)), L"First moves do not match!");
+			for (unsigned int idx = 0; idx < moves.size(); idx++)
+				Assert::AreEqual(4, moves[idx].score, L"First move score does not match!");
+
+			const Move* pMove = FindMove(moves, Board::CENTER, Board::CENTER - 1, true, "AT");
+			Assert::IsTrue(pMove != NULL, L"AT across not found!");
+			Assert::AreEqual(2U, pMove->numTilesPlaced, L"AT tiles placed do not match!");
+
+			// nothing can be played
+			Assert::AreEqual(0U, moveGenerator.GenerateMoves(board, "Q", Collect(moves)), L"Q moves do not match!");
+		}
+
+		TEST_METHOD(MoveGenerator_Moves)
+		{
+			Dawg dawg;
+			InitializeDawg(dawg);
+			MoveGenerator moveGenerator(dawg);
+			Board board;
+			PlaceCat(board);
+			vector<Move> moves;
+
+			// SCAT, CATS and AS down (the S can't go next to the C or the T)
+			Assert::AreEqual(3U, moveGenerator.GenerateMoves(board, "S", Collect(moves)), L"S moves do not match!");
+
+			const Move* pMove = FindMove(moves, Board::CENTER, Board::CENTER - 2, true, "SCAT");
+			Assert::IsTrue(pMove != NULL && pMove->score == 6 && pMove->placedMask == 1U, L"SCAT does not match!");
+
+			pMove = FindMove(moves, Board::CENTER, Board::CENTER - 1, true, "CATS");
+			Assert::IsTrue(pMove != NULL && pMove->score == 6 && pMove->placedMask == 8U, L"CATS does not match!");
+
+			pMove = FindMove(moves, Board::CENTER, Board::CENTER, false, "AS");
+			Assert::IsTrue(pMove != NULL && pMove->score == 2, L"AS does not match!");
+
+			// the blank scores nothing and can be any letter
+			moves.clear();
+			Assert::AreEqual(7U, moveGenerator.GenerateMoves(board, "?", Collect(moves)), L"Blank moves do not match!");
+
+			pMove = FindMove(moves, Board::CENTER, Board::CENTER - 2, true, "sCAT");
+			Assert::IsTrue(pMove != NULL && pMove->score == 5, L"sCAT does not match!");
+
+			pMove = FindMove(moves, Board::CENTER - 1, Board::CENTER + 1, false, "aT");
+			Assert::IsTrue(pMove != NULL && pMove->score == 1, L"aT does not match!");
+
+			// play it
+			board.PlaceMove(*pMove);
+			Assert::IsTrue(board.GetTile(Board::CENTER - 1, Board::CENTER + 1) == 'a', L"Placed blank does not match!");
+		}
+
+		TEST_METHOD(MoveGenerator_InvalidRack)
+		{
+			Dawg dawg;
+			InitializeDawg(dawg);
+			MoveGenerator moveGenerator(dawg);
+			Board board;
+			vector<Move> moves;
+
+			bool isExceptionThrown = false;
+			try
+			{
+				moveGenerator.GenerateMoves(board, "CAT5", Collect(moves));
+			}
+			catch (std::exception&)
+			{
+				isExceptionThrown = true;
+			}
+			Assert::IsTrue(isExceptionThrown, L"Invalid tile accepted!");
+
+			isExceptionThrown = false;
+			try
+			{
+				moveGenerator.GenerateMoves(board, "SCATTERS", Collect(moves));
+			}
+			catch (std::exception&)
+			{
+				isExceptionThrown = true;
+			}
+			Assert::IsTrue(isExceptionThrown, L"Rack with too many tiles accepted!");
+		}
+	};
+}
@@ -0,0 +1,100 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "PackedDawgNodes.h"
+
+#include <stdexcept>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace LxpStd;
+
+namespace LxpStdLibUnitTest
+{
+	TEST_CLASS(PackedDawgNodesUnitTest)
+	{
+	private:
+		static const unsigned int NUM_NODES = 1000;
+
+		// a node made from its id (all the letters and flag combinations, child ids up to the last node)
+		static DawgNode MakeNode(unsigned int nodeId)
+		{
+			DawgNode node;
+			node.childNodeId = (nodeId * 7919) % NUM_NODES;
+			node.letter = (char)('A' + nodeId % 26);
+			node.isTerminal = (unsigned char)(nodeId % 3 == 0 ? 1 : 0);
+			node.isLastChild = (unsigned char)(nodeId % 5 == 0 ? 1 : 0);
+			node.reserved = 0;
+			return node;
+		}
+
+		// false if SetNode throws
+		static bool IsNodeSet(PackedDawgNodes& packedNodes, unsigned int nodeId, const DawgNode& node)
+		{
+			try
+			{
+				packedNodes.SetNode(nodeId, node);
+			}
+			catch (std::exception&)
+			{
+				return false;
+			}
+
+			return true;
+		}
+
+	public:
+		TEST_METHOD(PackedDawgNodes_SetNode)
+		{
+			PackedDawgNodes packedNodes;
+			packedNodes.Initialize(NUM_NODES);
+			Assert::AreEqual(PackedDawgNodes::LETTER_CODE_BITS + 2 + 10, packedNodes.GetBitsPerNode(), L"Bits per node do not match!");
+			Assert::IsTrue(packedNodes.GetSize() < NUM_NODES * sizeof(DawgNode) / 3, L"Packed nodes are not smaller!");
+
+			// backwards, so every node is written next to one already set
+			for (unsigned int nodeId = NUM_NODES; nodeId > 0; nodeId--)
+				packedNodes.SetNode(nodeId - 1, MakeNode(nodeId - 1));
+
+			for (unsigned int nodeId = 0; nodeId < NUM_NODES; nodeId++)
+			{
+				DawgNode node = packedNodes.GetNode(nodeId);
+				DawgNode expectedNode = MakeNode(nodeId);
+				Assert::AreEqual(expectedNode.childNodeId, node.childNodeId, L"Child node id does not match!");
+				Assert::AreEqual(expectedNode.letter, node.letter, L"Letter does not match!");
+				Assert::AreEqual(expectedNode.isTerminal, node.isTerminal, L"isTerminal does not match!");
+				Assert::AreEqual(expectedNode.isLastChild, node.isLastChild, L"isLastChild does not match!");
+			}
+
+			// setting a node again leaves its neighbours alone
+			DawgNode node = MakeNode(0);
+			packedNodes.SetNode(NUM_NODES / 2, node);
+			Assert::AreEqual(node.childNodeId, packedNodes.GetNode(NUM_NODES / 2).childNodeId, L"Node was not set again!");
+			Assert::AreEqual(MakeNode(NUM_NODES / 2 - 1).childNodeId, packedNodes.GetNode(NUM_NODES / 2 - 1).childNodeId, L"Previous node changed!");
+			Assert::AreEqual(MakeNode(NUM_NODES / 2 + 1).childNodeId, packedNodes.GetNode(NUM_NODES / 2 + 1).childNodeId, L"Next node changed!");
+
+			packedNodes.Clear();
+			Assert::IsTrue(packedNodes.IsEmpty(), L"Packed nodes are not empty after Clear!");
+		}
+
+		TEST_METHOD(PackedDawgNodes_Limits)
+		{
+			PackedDawgNodes packedNodes;
+			packedNodes.Initialize(NUM_NODES);
+
+			DawgNode node = MakeNode(0);
+			node.childNodeId = NUM_NODES;
+			Assert::IsFalse(IsNodeSet(packedNodes, 0, node), L"Child node id out of range did not throw!");
+			Assert::IsFalse(IsNodeSet(packedNodes, NUM_NODES, MakeNode(0)), L"Node id out of range did not throw!");
+
+			// one letter too many
+			node = MakeNode(0);
+			for (unsigned int idx = 0; idx < PackedDawgNodes::MAX_LETTERS; idx++)
+			{
+				node.letter = (char)('0' + idx);
+				Assert::IsTrue(IsNodeSet(packedNodes, idx, node), L"Letter did not fit!");
+			}
+
+			node.letter = 'z';
+			Assert::IsFalse(IsNodeSet(packedNodes, 0, node), L"Too many letters did not throw!");
+		}
+	};
+}
@@ -0,0 +1,106 @@
+// CppUnitTest.h
+// The part of the Visual Studio C++ unit test framework used by the tests, for the
+// portable (CMake) build. Test methods register themselves; UnitTestMain runs them.
+
+#ifndef PORTABLE_CPP_UNIT_TEST_H
+#define PORTABLE_CPP_UNIT_TEST_H
+
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace LxpStdLibUnitTest
+{
+	namespace Portable
+	{
+		typedef struct TestMethodStruct	TestMethod;
+
+		struct TestMethodStruct
+		{
+			std::string				name;
+			std::function<void()>	run;
+		};
+
+		// all the test methods in the order they were registered
+		inline std::vector<TestMethod>& GetTestMethods()
+		{
+			static std::vector<TestMethod> testMethods;
+			return testMethods;
+		}
+
+		// thrown by a failed assertion
+		class AssertFailure : public std::runtime_error
+		{
+		public:
+			explicit AssertFailure(const std::string& message) : std::runtime_error(message) {}
+		};
+
+		// base of the test classes, gives the test methods their class
+		template <typename T>
+		class TestClass
+		{
+		public:
+			typedef T	SelfType;
+		};
+	}
+}
+
+namespace Microsoft { namespace VisualStudio { namespace CppUnitTestFramework
+{
+	class Assert
+	{
+	public:
+		template <typename T>
+		static void AreEqual(T expected, T actual, const wchar_t* pMessage = NULL)
+		{
+			if (!(expected == actual))
+				Fail("AreEqual", pMessage);
+		}
+		static void AreEqual(const char* pExpected, const char* pActual, const wchar_t* pMessage = NULL)
+		{
+			if (strcmp(pExpected, pActual) != 0)
+				Fail("AreEqual", pMessage);
+		}
+		static void IsTrue(bool condition, const wchar_t* pMessage = NULL)			{ if (!condition) Fail("IsTrue", pMessage); }
+		static void IsFalse(bool condition, const wchar_t* pMessage = NULL)			{ if (condition) Fail("IsFalse", pMessage); }
+		static void IsNull(const void* pPointer, const wchar_t* pMessage = NULL)	{ if (pPointer != NULL) Fail("IsNull", pMessage); }
+		static void IsNotNull(const void* pPointer, const wchar_t* pMessage = NULL)	{ if (pPointer == NULL) Fail("IsNotNull", pMessage); }
+		static void Fail(const wchar_t* pMessage = NULL)							{ Fail("Fail", pMessage); }
+
+	private:
+		static void Fail(const char* pAssertion, const wchar_t* pMessage)
+		{
+			std::string message = std::string("Assert::") + pAssertion + " failed";
+			if (pMessage != NULL)
+			{
+				message += ": ";
+				for (const wchar_t* pChar = pMessage; *pChar != L'\0'; pChar++)
+					message.push_back(*pChar < 0x80 ? (char)*pChar : '?');
+			}
+
+			throw(LxpStdLibUnitTest::Portable::AssertFailure(message));
+		}
+	};
+}}}
+
+#define TEST_CLASS(className)	class className : public ::LxpStdLibUnitTest::Portable::TestClass<className>
+
+// registers the method before main runs (inline static data members need C++17)
+#define TEST_METHOD(methodName)																\
+	struct methodName##Registrar															\
+	{																						\
+		methodName##Registrar()																\
+		{																					\
+			::LxpStdLibUnitTest::Portable::TestMethod testMethod;							\
+			testMethod.name = #methodName;													\
+			testMethod.run = []() { SelfType testClass; testClass.methodName(); };			\
+			::LxpStdLibUnitTest::Portable::GetTestMethods().push_back(testMethod);			\
+		}																					\
+	};																						\
+	static inline methodName##Registrar	methodName##Registration;							\
+public:																						\
+	void methodName()
+
+#endif // !PORTABLE_CPP_UNIT_TEST_H
@@ -0,0 +1,44 @@
+// UnitTestMain.cpp
+// Runs the unit tests in the portable (CMake) build.
+
+#include "CppUnitTest.h"
+
+#include <cstdio>
+#include <exception>
+#include <string>
+#include <vector>
+
+using namespace LxpStdLibUnitTest::Portable;
+using namespace std;
+
+// Usage: LxpStdLibUnitTest [filter]
+// runs the test methods whose name contains the filter (all of them by default)
+int main(int argc, char** argv)
+{
+	string filter = (argc > 1) ? argv[1] : "";
+	const vector<TestMethod>& testMethods = GetTestMethods();
+
+	unsigned int numRun = 0;
+	unsigned int numFailed = 0;
+	for (unsigned int idx = 0; idx < testMethods.size(); idx++)
+	{
+		const TestMethod& testMethod = testMethods[idx];
+		if (testMethod.name.find(filter) == string::npos)
+			continue;
+
+		numRun++;
+		try
+		{
+			testMethod.run();
+			printf("PASSED %s\n", testMethod.name.c_str());
+		}
+		catch (std::exception& e)
+		{
+			numFailed++;
+			printf("FAILED %s: %s\n", testMethod.name.c_str(), e.what());
+		}
+	}
+
+	printf("%u of %u tests passed\n", numRun - numFailed, numRun);
+	return (numFailed == 0 && numRun > 0) ? 0 : 1;
+}
@@ -0,0 +1,69 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "ScratchMemory.h"
+
+#include <thread>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace LxpStd;
+
+namespace LxpStdLibUnitTest
+{
+	TEST_CLASS(ScratchMemoryUnitTest)
+	{
+	private:
+		static const unsigned int ALLOC_SIZE = 100;
+
+	public:
+		TEST_METHOD(ScratchMemory_Nested)
+		{
+			BlockMemoryStats stats;
+			{
+				ScratchMemory scratchMemory;
+				Assert::IsNotNull(scratchMemory.Allocate(ALLOC_SIZE), L"Scratch allocation failed");
+				{
+					ScratchMemory nestedScratchMemory;
+					Assert::IsNotNull(nestedScratchMemory.Allocate<int>(ScratchMemory::BLOCK_SIZE), L"Large scratch allocation failed");
+				}
+
+				// the nested allocations are released
+				ScratchMemory::GetThreadStats(stats);
+				Assert::AreEqual((size_t)ALLOC_SIZE, stats.bytesAllocated, L"Nested scratch memory is not released!");
+
+				scratchMemory.Release();
+				ScratchMemory::GetThreadStats(stats);
+				Assert::AreEqual((size_t)0, stats.bytesAllocated, L"Scratch memory is not released by Release!");
+				Assert::IsNotNull(scratchMemory.Allocate(ALLOC_SIZE), L"Scratch allocation after Release failed");
+			}
+
+			// the blocks are kept for the next query
+			ScratchMemory::GetThreadStats(stats);
+			Assert::AreEqual((size_t)0, stats.bytesAllocated, L"Scratch memory is not released!");
+			Assert::AreEqual(1U, stats.numBlocks, L"Scratch block is not kept!");
+		}
+
+		TEST_METHOD(ScratchMemory_Threads)
+		{
+			ScratchMemory scratchMemory;
+			void* pMemory = scratchMemory.Allocate(ALLOC_SIZE);
+
+			// another thread has its own arena
+			void* pThreadMemory = NULL;
+			size_t threadBytesAllocated = 0;
+			std::thread thread([&]()
+			{
+				ScratchMemory threadScratchMemory;
+				pThreadMemory = threadScratchMemory.Allocate(ALLOC_SIZE);
+
+				BlockMemoryStats threadStats;
+				ScratchMemory::GetThreadStats(threadStats);
+				threadBytesAllocated = threadStats.bytesAllocated;
+			});
+			thread.join();
+
+			Assert::IsTrue(pThreadMemory != NULL && pThreadMemory != pMemory, L"Threads share scratch memory!");
+			Assert::AreEqual((size_t)ALLOC_SIZE, threadBytesAllocated, L"Thread bytes allocated does not match!");
+		}
+	};
+}
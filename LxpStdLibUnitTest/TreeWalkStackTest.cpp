@@ -0,0 +1,44 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "TreeWalkStack.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace LxpStd;
+
+namespace LxpStdLibUnitTest
+{
+	TEST_CLASS(TreeWalkStackUnitTest)
+	{
+	private:
+		static const unsigned int CAPACITY = 8;
+		static const unsigned int NUM_ITEMS = 3 * CAPACITY;	// past the capacity
+
+	public:
+		TEST_METHOD(TreeWalkStack_PushPop)
+		{
+			TreeWalkStack<unsigned int, CAPACITY> stack;
+			Assert::IsTrue(stack.IsEmpty(), L"New stack is not empty!");
+
+			for (unsigned int idx = 0; idx < NUM_ITEMS; idx++)
+			{
+				stack.Push(idx);
+				Assert::AreEqual(idx, stack.Top(), L"Top does not match!");
+			}
+
+			// last in, first out, across the capacity
+			for (unsigned int idx = NUM_ITEMS; idx-- > 0;)
+			{
+				Assert::IsFalse(stack.IsEmpty(), L"Stack is empty too soon!");
+				Assert::AreEqual(idx, stack.Pop(), L"Popped item does not match!");
+			}
+			Assert::IsTrue(stack.IsEmpty(), L"Stack is not empty!");
+
+			// reused after going past the capacity
+			unsigned int item = CAPACITY;	// (Push takes a reference, the constant has no definition)
+			stack.Push(item);
+			stack.Top()++;
+			Assert::AreEqual(CAPACITY + 1, stack.Pop(), L"Top is not a reference!");
+		}
+	};
+}
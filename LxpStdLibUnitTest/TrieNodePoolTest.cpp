@@ -0,0 +1,73 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "TrieNodePool.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace LxpStd;
+
+namespace LxpStdLibUnitTest
+{
+	TEST_CLASS(TrieNodePoolUnitTest)
+	{
+	private:
+		static const unsigned int NUM_NODES = 10000;	// a few chunks
+
+	public:
+		TEST_METHOD(TrieNodePool_Allocate)
+		{
+			TrieNodePool nodePool;
+			Assert::AreEqual(16U, (unsigned int)sizeof(TrieNode), L"TrieNode is not 16 bytes!");
+
+			// ids are sequential and nodes keep their values as the pool grows
+			for (unsigned int idx = 0; idx < NUM_NODES; idx++)
+			{
+				unsigned int nodeId = nodePool.Allocate();
+				Assert::AreEqual(idx, nodeId, L"Node id is not sequential!");
+				nodePool[nodeId].firstChildId = idx;
+			}
+
+			Assert::AreEqual(NUM_NODES, nodePool.NumNodes(), L"NumNodes does not match!");
+			for (unsigned int idx = 0; idx < NUM_NODES; idx++)
+				Assert::AreEqual(idx, nodePool[idx].firstChildId, L"Node value changed!");
+
+			nodePool.DeallocateAll();
+			Assert::AreEqual(0U, nodePool.NumNodes(), L"NumNodes is not 0 after DeallocateAll!");
+			Assert::AreEqual(0U, nodePool.Allocate(), L"First node id is not 0 after DeallocateAll!");
+		}
+
+		TEST_METHOD(TrieNodePool_Append)
+		{
+			TrieNodePool nodePool;
+			TrieNodePool appendedNodePool;
+			nodePool.Allocate();
+			for (unsigned int idx = 0; idx < NUM_NODES; idx++)
+			{
+				unsigned int nodeId = appendedNodePool.Allocate();
+				appendedNodePool[nodeId].firstChildId = idx + 1 < NUM_NODES ? nodeId + 1 : TrieNodePool::NO_NODE;
+				appendedNodePool[nodeId].nextSiblingId = TrieNodePool::NO_NODE;
+				appendedNodePool[nodeId].originalParentId = idx;
+			}
+
+			// the appended nodes start at the next chunk and their links still lead to them
+			unsigned int idOffset = nodePool.NumIds();
+			Assert::IsTrue(idOffset > 0, L"Pool takes no ids!");
+			appendedNodePool.OffsetIds(idOffset);
+			nodePool.Append(appendedNodePool);
+			Assert::AreEqual(0U, appendedNodePool.NumNodes(), L"Appended pool is not empty!");
+
+			for (unsigned int idx = 0; idx + 1 < NUM_NODES; idx++)
+			{
+				const TrieNode& node = nodePool[idOffset + idx];
+				Assert::AreEqual(idOffset + idx + 1, node.firstChildId, L"Link does not match!");
+				Assert::AreEqual(TrieNodePool::NO_NODE, node.nextSiblingId, L"NO_NODE was offset!");
+				Assert::AreEqual(idOffset + idx, node.originalParentId, L"Parent does not match!");
+			}
+
+			// new nodes after them
+			unsigned int numIds = nodePool.NumIds();
+			Assert::IsTrue(numIds >= idOffset + NUM_NODES, L"Ids taken do not match!");
+			Assert::AreEqual(numIds, nodePool.Allocate(), L"New node id does not follow the appended nodes!");
+		}
+	};
+}
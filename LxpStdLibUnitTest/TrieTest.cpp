@@ -1,10 +1,17 @@
 #include "pch.h"
 #include "CppUnitTest.h"
 #include "Trie.h"
+#include <algorithm>
+#include <cstdio>
 #include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 using namespace LxpStd;
+using namespace std;
 
 namespace LxpStdLibUnitTest
 {
@@ -41,6 +48,14 @@ namespace LxpStdLibUnitTest
 			}
 		}
 
+		// section table and nodes (the header has the date and the lexicon name)
+		vector<char> ReadDawgNodes(const string& fileName)
+		{
+			ifstream dawgStream(fileName, ifstream::in | ifstream::binary);
+			vector<char> contents((istreambuf_iterator<char>(dawgStream)), istreambuf_iterator<char>());
+			return vector<char>(contents.begin() + DawgFile::HEADER_SIZE, contents.end());
+		}
+
 		TEST_METHOD(Trie_AddOneWord)
 		{
 			const char* word = "BATH";
@@ -61,6 +76,49 @@ namespace LxpStdLibUnitTest
 			Assert::AreEqual(numExpectedNodes, diagnostics.numNodes, L"diagnostics.numNodes does not match!");
 		}
 
+		TEST_METHOD(Trie_LongWord)
+		{
+			// deeper than the stack of the tree walks holds without the heap, and sibling lists
+			// higher than 255 (with duplicates to find at those heights)
+			string word(300, 'A');
+			for (unsigned int idx = 0; idx < word.length(); idx++)
+				word[idx] = (char)(Dawg::START_LETTER + idx % 26);
+			const string words[] = { word, word.substr(0, 100), "Q" + word.substr(1), "Z" + word.substr(1) };
+
+			string serialFileName("UnitTestTrieLongSerial.lxd");
+			string parallelFileName("UnitTestTrieLongParallel.lxd");
+
+			Trie serialTrie;
+			TrieDiagnostics serialDiagnostics;
+			for (const string& addWord : words)
+				serialTrie.AddWord(addWord.c_str());
+			while (serialTrie.Compress() == false)
+			{
+				// do nothing
+			}
+			serialTrie.SaveAsDawg(serialFileName, "Serial");
+			serialTrie.GetDiagnostics(serialDiagnostics);
+
+			// the prefix is in the long word, forward and reversed
+			Assert::AreEqual(4U, serialDiagnostics.numWords, L"diagnostics.numWords does not match!");
+			Assert::IsTrue(serialDiagnostics.numNodesAfterCompression > 0 && serialDiagnostics.numNodesAfterCompression < serialDiagnostics.numNodes,
+						   L"diagnostics.numNodesAfterCompression does not match!");
+
+			Trie trie;
+			TrieDiagnostics diagnostics;
+			for (const string& addWord : words)
+				trie.AddWord(addWord.c_str());
+			trie.CompressParallel(2);
+			trie.SaveAsDawg(parallelFileName, "Parallel");
+			trie.GetDiagnostics(diagnostics);
+
+			Assert::AreEqual(serialDiagnostics.numFirstChildrenAfterCompression, diagnostics.numFirstChildrenAfterCompression,
+							 L"diagnostics.numFirstChildrenAfterCompression does not match!");
+			Assert::AreEqual(serialDiagnostics.numNodesAfterCompression, diagnostics.numNodesAfterCompression,
+							 L"diagnostics.numNodesAfterCompression does not match!");
+			Assert::IsTrue(ReadDawgNodes(serialFileName) == ReadDawgNodes(parallelFileName), L"Dawg nodes do not match!");
+		}
+
 		TEST_METHOD(Trie_AddWords)
 		{
 			Trie trie;
@@ -82,6 +140,106 @@ namespace LxpStdLibUnitTest
 			Assert::AreEqual(expected.numLetters, diagnostics.numLetters, L"diagnostics.numLetters does not match!");
 		}
 
+		TEST_METHOD(Trie_AddWordsParallel)
+		{
+			string serialFileName("UnitTestTrieSerial.lxd");
+			string parallelFileName("UnitTestTrieParallel.lxd");
+			vector<string> words(lexicon, lexicon + numWordsInLexicon);
+
+			Trie serialTrie;
+			TrieDiagnostics expected;
+			for (int idx = 0; idx < numWordsInLexicon; idx++)
+				serialTrie.AddWord(lexicon[idx]);
+			serialTrie.GetDiagnostics(expected);
+			serialTrie.CompressParallel(1);
+			serialTrie.SaveAsDawg(serialFileName, "Serial");
+
+			// more threads than shards too
+			const unsigned int numThreadsOptions[] = { 1, 2, 3, 4, 64 };
+			for (unsigned int numThreads : numThreadsOptions)
+			{
+				Trie trie;
+				TrieDiagnostics diagnostics;
+				trie.AddWords(words, numThreads);
+
+				trie.GetDiagnostics(diagnostics);
+				Assert::AreEqual(expected.numWords, diagnostics.numWords, L"diagnostics.numWords does not match!");
+				Assert::AreEqual(expected.numWordLetters, diagnostics.numWordLetters, L"diagnostics.numWordLetters does not match!");
+				Assert::AreEqual(expected.numNodes, diagnostics.numNodes, L"diagnostics.numNodes does not match!");
+				Assert::AreEqual(expected.numReversePartWords, diagnostics.numReversePartWords, L"diagnostics.numReversePartWords does not match!");
+				Assert::AreEqual(expected.numLetters, diagnostics.numLetters, L"diagnostics.numLetters does not match!");
+
+				// words added after the shards are added one at a time
+				trie.AddWords(vector<string>(1, "CATTY"), numThreads);
+				trie.AddWord("BATTY");
+				trie.GetDiagnostics(diagnostics);
+				Assert::AreEqual(expected.numWords + 2, diagnostics.numWords, L"Added words are not counted!");
+			}
+
+			// and the saved Dawg is the same
+			Trie trie;
+			trie.AddWords(words, 4);
+			trie.CompressParallel(1);
+			trie.SaveAsDawg(parallelFileName, "Parallel");
+			Assert::IsTrue(ReadDawgNodes(serialFileName) == ReadDawgNodes(parallelFileName), L"Dawg nodes do not match!");
+
+			bool isExceptionThrown = false;
+			try
+			{
+				Trie invalidTrie;
+				invalidTrie.AddWords(vector<string>(1, "CAt"), 4);
+			}
+			catch (std::exception&)
+			{
+				isExceptionThrown = true;
+			}
+			Assert::IsTrue(isExceptionThrown, L"Invalid letter did not throw!");
+		}
+
+		TEST_METHOD(Trie_AddWordsParallelLarge)
+		{
+			// unsorted words with more of the first letters, so that the shards are uneven and
+			// the largest are on huge pages
+			string serialFileName("UnitTestTrieLargeSerial.lxd");
+			string parallelFileName("UnitTestTrieLargeParallel.lxd");
+			vector<string> words(20000);
+			unsigned int random = 12345;
+			for (string& word : words)
+			{
+				random = random * 1103515245 + 12345;
+				word.resize(1 + (random >> 16) % 24);
+				for (char& letter : word)
+				{
+					random = random * 1103515245 + 12345;
+					unsigned int letterNum1 = (random >> 16) % 26;
+					random = random * 1103515245 + 12345;
+					unsigned int letterNum2 = (random >> 16) % 26;
+					letter = (char)(Dawg::START_LETTER + min(letterNum1, letterNum2));
+				}
+			}
+
+			Trie serialTrie;
+			TrieDiagnostics expected;
+			for (const string& word : words)
+				serialTrie.AddWord(word.c_str());
+			serialTrie.CompressParallel(1);
+			serialTrie.SaveAsDawg(serialFileName, "Large");
+			serialTrie.GetDiagnostics(expected);
+
+			Trie trie;
+			TrieDiagnostics diagnostics;
+			trie.AddWords(words, 4);
+			trie.CompressParallel(1);
+			trie.SaveAsDawg(parallelFileName, "Large");
+			trie.GetDiagnostics(diagnostics);
+
+			Assert::AreEqual(expected.numNodes, diagnostics.numNodes, L"diagnostics.numNodes does not match!");
+			Assert::AreEqual(expected.numLetters, diagnostics.numLetters, L"diagnostics.numLetters does not match!");
+			Assert::AreEqual(expected.numNodesAfterCompression, diagnostics.numNodesAfterCompression,
+							 L"diagnostics.numNodesAfterCompression does not match!");
+			Assert::IsTrue(ReadDawgNodes(serialFileName) == ReadDawgNodes(parallelFileName), L"Dawg nodes do not match!");
+		}
+
 		TEST_METHOD(Trie_Compress)
 		{
 			Trie trie;
@@ -105,6 +263,88 @@ namespace LxpStdLibUnitTest
 							 L"diagnostics.numFirstChildrenBeforeCompression does not match!");
 			Assert::AreEqual(expectedNumNodesAfterCompression, diagnostics.numNodesAfterCompression,
 							 L"diagnostics.numNodesAfterCompression does not match!");
+
+			// numbering, and then a pass per save
+			Assert::AreEqual(1U, diagnostics.numFinishPasses, L"diagnostics.numFinishPasses does not match after compression!");
+			trie.SaveAsDawg("UnitTestTrieFinish.lxd", "Finish");
+			trie.GetDiagnostics(diagnostics);
+			Assert::AreEqual(2U, diagnostics.numFinishPasses, L"diagnostics.numFinishPasses does not match after saving!");
+			remove("UnitTestTrieFinish.lxd");
+		}
+
+		TEST_METHOD(Trie_SaveBeforeCompression)
+		{
+			Trie trie;
+			trie.AddWord("CAT");
+
+			bool isExceptionThrown = false;
+			try
+			{
+				trie.SaveAsDawg("UnitTestTrieUncompressed.lxd", "Uncompressed");
+			}
+			catch (std::exception&)
+			{
+				isExceptionThrown = true;
+			}
+			Assert::IsTrue(isExceptionThrown, L"Saving an uncompressed Trie did not throw!");
+		}
+
+		TEST_METHOD(Trie_CompressWithBudget)
+		{
+			Trie trie;
+			TrieDiagnostics diagnostics;
+			TrieCompressProgress progress;
+
+			for (int idx = 0; idx < numWordsInLexicon; idx++)
+				trie.AddWord(lexicon[idx]);
+
+			// no budget finishes in one call
+			Assert::IsTrue(trie.Compress(0, progress), L"Compress did not finish!");
+
+			trie.GetDiagnostics(diagnostics);
+			Assert::AreEqual(expectedNumNodesAfterCompression, diagnostics.numNodesAfterCompression,
+							 L"diagnostics.numNodesAfterCompression does not match!");
+			Assert::AreEqual(expectedNumFirstChildrenBeforeCompression, progress.numFirstChildren,
+							 L"progress.numFirstChildren does not match!");
+			Assert::AreEqual(progress.numFirstChildren, progress.numFirstChildrenProcessed,
+							 L"progress.numFirstChildrenProcessed does not match!");
+			Assert::AreEqual(expectedNumFirstChildrenBeforeCompression - expectedNumFirstChildrenAfterCompression,
+							 progress.numDuplicatesRemoved, L"progress.numDuplicatesRemoved does not match!");
+			Assert::AreEqual(1.0, progress.fractionDone, L"progress.fractionDone does not match!");
+			Assert::AreEqual(0.0, progress.remainingSeconds, L"progress.remainingSeconds does not match!");
+		}
+
+		TEST_METHOD(Trie_CompressParallel)
+		{
+			string serialFileName("UnitTestTrieSerial.lxd");
+			string parallelFileName("UnitTestTrieParallel.lxd");
+
+			Trie serialTrie;
+			for (int idx = 0; idx < numWordsInLexicon; idx++)
+				serialTrie.AddWord(lexicon[idx]);
+			while (serialTrie.Compress() == false)
+			{
+				// do nothing
+			}
+			serialTrie.SaveAsDawg(serialFileName, "Serial");
+
+			// more threads than sibling lists of some heights
+			for (unsigned int numThreads = 1; numThreads <= 4; numThreads++)
+			{
+				Trie trie;
+				TrieDiagnostics diagnostics;
+				for (int idx = 0; idx < numWordsInLexicon; idx++)
+					trie.AddWord(lexicon[idx]);
+				trie.CompressParallel(numThreads);
+				trie.SaveAsDawg(parallelFileName, "Parallel");
+
+				trie.GetDiagnostics(diagnostics);
+				Assert::AreEqual(expectedNumFirstChildrenAfterCompression, diagnostics.numFirstChildrenAfterCompression,
+								 L"diagnostics.numFirstChildrenAfterCompression does not match!");
+				Assert::AreEqual(expectedNumNodesAfterCompression, diagnostics.numNodesAfterCompression,
+								 L"diagnostics.numNodesAfterCompression does not match!");
+				Assert::IsTrue(ReadDawgNodes(serialFileName) == ReadDawgNodes(parallelFileName), L"Dawg nodes do not match!");
+			}
 		}
 	};
 }
\ No newline at end of file
@@ -46,5 +46,44 @@ namespace LxpStdLibUnitTest
 			for (int idx = 0; idx < numWordsInLexicon; idx++)
 				Assert::IsTrue(dawg.IsWord(string(lexicon[idx])));
         }
+
+		TEST_METHOD(Int_TrieSaveDawgReadMemoryMapped)
+		{
+			const int numWordsInLexicon = 7;
+			const unsigned int numUniqueReversePartWordsInLexicon = 13;
+			const char* lexicon[numWordsInLexicon] = { "BAT", "BATS", "CAR", "CARS", "CAT", "CATS", "FAT" };
+
+			string lexiconName("Integration test lexicon");
+			string fileName("IntTestMappedDawg.lxd");
+
+			Trie trie;
+
+			// build the Trie, compress and save
+			for (int idx = 0; idx < numWordsInLexicon; idx++)
+				trie.AddWord(lexicon[idx]);
+
+			while (trie.Compress() == false)
+			{
+				// do nothing
+			}
+			trie.SaveAsDawg(fileName, lexiconName);
+
+			// map the file in Dawg
+			Dawg dawg;
+			dawg.Initialize(fileName, Dawg::LoadMode::MEMORY_MAPPED);
+
+			DawgHeader header;
+			dawg.GetHeader(header);
+			Assert::AreEqual((unsigned int)numWordsInLexicon, header.numWords, L"header.numWords do not match!");
+			Assert::AreEqual(dawg.NumReversePartWords(), numUniqueReversePartWordsInLexicon, L"dawg.NumReversePartWords do not match!");
+
+			// verify each word is there and a few that are not
+			for (int idx = 0; idx < numWordsInLexicon; idx++)
+				Assert::IsTrue(dawg.IsWord(string(lexicon[idx])));
+
+			Assert::IsFalse(dawg.IsWord(string("CA")));
+			Assert::IsFalse(dawg.IsWord(string("FATS")));
+			Assert::IsTrue(dawg.IsReversePartWord(string("TAC")));
+		}
     };
 }
\ No newline at end of file
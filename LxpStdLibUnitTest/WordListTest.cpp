@@ -0,0 +1,151 @@
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "Dawg.h"
+#include "WordList.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace LxpStd;
+using namespace std;
+
+namespace LxpStdLibUnitTest
+{
+	TEST_CLASS(WordListUnitTest)
+	{
+	private:
+		// comments, annotations, lower case, duplicates, line ends of both kinds and no last line end
+		const char* pText =
+			"# test word list\n"
+			"CAT\n"
+			"  bat   noun, a flying mammal\r\n"
+			"\n"
+			"CATS\n"
+			"c4t\n"
+			"ABCDEFGHIJKLMNOPQRSTUVWXYZABCDEFGHIJ\n"
+			"Cat\n"
+			"\t#indented comment\n"
+			"ant";
+
+		// false if Read throws
+		static bool IsRead(WordList& wordList, const string& fileName)
+		{
+			try
+			{
+				wordList.Read(fileName);
+			}
+			catch (std::exception&)
+			{
+				return false;
+			}
+
+			return true;
+		}
+
+	public:
+		TEST_METHOD(WordList_Parse)
+		{
+			WordList wordList;
+			wordList.Parse(pText, strlen(pText));
+
+			const vector<string>& words = wordList.GetWords();
+			Assert::AreEqual((size_t)4, words.size(), L"Number of words does not match!");
+			Assert::IsTrue(words[0] == "ANT" && words[1] == "BAT" && words[2] == "CAT" && words[3] == "CATS", L"Words do not match!");
+
+			WordListReport report;
+			wordList.GetReport(report);
+			Assert::AreEqual(10U, report.numLines, L"Number of lines does not match!");
+			Assert::AreEqual(3U, report.numSkippedLines, L"Number of skipped lines does not match!");
+			Assert::AreEqual(2U, report.numRejectedLines, L"Number of rejected lines does not match!");
+			Assert::AreEqual(1U, report.numDuplicates, L"Number of duplicates does not match!");
+			Assert::AreEqual(4U, report.numWords, L"Number of words in the report does not match!");
+
+			Assert::AreEqual((size_t)2, report.rejects.size(), L"Rejects do not match!");
+			Assert::AreEqual(6U, report.rejects[0].lineNumber, L"Rejected line number does not match!");
+			Assert::IsTrue(report.rejects[0].reason == WordListRejectReason::INVALID_LETTER, L"Reject reason does not match!");
+			Assert::IsTrue(report.rejects[0].line == "c4t", L"Rejected line does not match!");
+			Assert::AreEqual(7U, report.rejects[1].lineNumber, L"Rejected line number does not match!");
+			Assert::IsTrue(report.rejects[1].reason == WordListRejectReason::TOO_LONG, L"Reject reason does not match!");
+
+			// unsorted, in the order of the first occurrence
+			wordList.Parse(pText, strlen(pText), false);
+			Assert::IsTrue(wordList.GetWords()[0] == "CAT" && wordList.GetWords()[1] == "BAT" && wordList.GetWords()[3] == "ANT",
+						   L"Unsorted words do not match!");
+
+			wordList.Parse("", 0);
+			Assert::IsTrue(wordList.GetWords().empty(), L"Empty word list has words!");
+		}
+
+		TEST_METHOD(WordList_Threads)
+		{
+			// enough lines for several chunks, every 1000th rejected and every word twice
+			string text;
+			for (unsigned int idx = 0; idx < 100000; idx++)
+			{
+				unsigned int wordIdx = idx % 50000;
+				string word;
+				for (unsigned int letterIdx = 0; letterIdx < 4; letterIdx++, wordIdx /= 26)
+					word.push_back((char)(Dawg::START_LETTER + wordIdx % 26));
+				text += idx % 1000 == 999 ? word + "!" : word;
+				text += " annotation\n";
+			}
+
+			WordList wordList;
+			wordList.Parse(text.c_str(), text.length(), true, 1);
+			WordListReport report;
+			wordList.GetReport(report);
+
+			const bool isSortedOptions[] = { true, false };
+			for (bool isSorted : isSortedOptions)
+			{
+				WordList threadsWordList;
+				threadsWordList.Parse(text.c_str(), text.length(), isSorted, 7);
+				WordListReport threadsReport;
+				threadsWordList.GetReport(threadsReport);
+				Assert::AreEqual(report.numLines, threadsReport.numLines, L"Number of lines does not match!");
+				Assert::AreEqual(report.numRejectedLines, threadsReport.numRejectedLines, L"Number of rejected lines does not match!");
+				Assert::AreEqual(report.numDuplicates, threadsReport.numDuplicates, L"Number of duplicates does not match!");
+				Assert::AreEqual(report.rejects.back().lineNumber, threadsReport.rejects.back().lineNumber, L"Line numbers do not match!");
+
+				if (isSorted)
+					Assert::IsTrue(wordList.GetWords() == threadsWordList.GetWords(), L"Words do not match!");
+				else
+					Assert::AreEqual(wordList.GetWords().size(), threadsWordList.GetWords().size(), L"Number of words does not match!");
+			}
+
+			Assert::AreEqual(100000U, report.numLines, L"Number of lines does not match!");
+			Assert::AreEqual(100U, report.numRejectedLines, L"Number of rejected lines does not match!");
+			Assert::AreEqual((size_t)WordList::MAX_REPORTED_REJECTS, report.rejects.size(), L"Rejects do not match!");
+			Assert::AreEqual(100000U, report.rejects.back().lineNumber, L"Last rejected line does not match!");
+		}
+
+		TEST_METHOD(WordList_Read)
+		{
+			string fileName("WordListUnitTest.txt");
+			{
+				ofstream fileStream(fileName, ofstream::out | ofstream::binary);
+				fileStream << pText;
+			}
+
+			WordList wordList;
+			Assert::IsTrue(IsRead(wordList, fileName), L"Word list was not read!");
+			Assert::AreEqual((size_t)4, wordList.GetWords().size(), L"Number of words does not match!");
+
+			// an empty file has no words
+			{
+				ofstream fileStream(fileName, ofstream::out | ofstream::binary);
+			}
+			Assert::IsTrue(IsRead(wordList, fileName), L"Empty word list was not read!");
+			Assert::IsTrue(wordList.GetWords().empty(), L"Empty word list has words!");
+
+			remove(fileName.c_str());
+			Assert::IsFalse(IsRead(wordList, fileName), L"Missing word list did not throw!");
+		}
+	};
+}
@@ -5,7 +5,10 @@
 
 #pragma once
 
+// the portable (CMake) build has no test app (see Portable/CppUnitTest.h)
+#ifdef _WIN32
 #include <collection.h>
 #include <ppltasks.h>
 
 #include "UnitTestApp.xaml.h"
+#endif
@@ -6,14 +6,18 @@
 #include "pch.h"
 #include "MainPage.xaml.h"
 #include "Trie.h"
+#include "WordList.h"
 
 #include <cvt/wstring>
 #include <codecvt>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <ppltasks.h>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 using namespace MakeDawg;
 
@@ -39,6 +43,51 @@ using namespace std;
 MainPage::MainPage()
 {
 	InitializeComponent();
+
+	this->compressTimer = ref new DispatcherTimer();
+	this->compressTimer->Tick += ref new EventHandler<Object^>(this, &MainPage::CompressTimerTick);
+}
+
+MainPage::~MainPage()
+{
+	this->compressTimer->Stop();
+}
+
+void MakeDawg::MainPage::CompressTimerTick(Platform::Object^ sender, Platform::Object^ e)
+{
+	// (an exception must not leave the tick)
+	try
+	{
+		// compress for a slice
+		TrieCompressProgress progress;
+		if (this->pTrie->Compress(MainPage::COMPRESS_SLICE_MILLISECONDS, progress) == false)
+		{
+			ostringstream statusStream;
+			statusStream << "Compressing... " << (int)(100.0 * progress.fractionDone) << "% done, "
+				<< progress.numDuplicatesRemoved << " duplicates removed, about "
+				<< (int)(progress.remainingSeconds + 0.5) << " seconds left";
+			statusOutput->Text = ConvertStringToPlatformString(statusStream.str());
+			return;
+		}
+
+		this->compressTimer->Stop();
+
+		// save file
+		statusOutput->Text = "Saving DAWG file...";
+		this->pTrie->SaveAsDawg(this->dawgFileName, this->lexiconName);
+
+		// show summary
+		string summary = ConstructSummary(*this->pTrie);
+		statusOutput->Text = ConvertStringToPlatformString(summary);
+	}
+	catch (std::exception& exception)
+	{
+		StopOnError(exception);
+		return;
+	}
+
+	this->pTrie.reset();
+	makeDawgButton->IsEnabled = true;
 }
 
 void MakeDawg::MainPage::IOFolderButtonClick(Platform::Object^ sender, Windows::UI::Xaml::RoutedEventArgs^ e)
@@ -85,54 +134,36 @@ void MakeDawg::MainPage::LexiconFileButtonClick(Platform::Object^ sender, Window
 void MakeDawg::MainPage::MakeDawgButtonClick(Platform::Object^ sender, Windows::UI::Xaml::RoutedEventArgs^ e)
 {
 	// add words to Trie
-	Trie trie;
-	statusOutput->Text = "Reading input file...";
-	string fileName = ConvertPlatformStringToString(lexiconFileInput->Text);
-	AddWordsToTrie(trie, fileName);
-
-	// compress
-	statusOutput->Text = "Compressing...";
-	while (trie.Compress() == false)
+	try
 	{
-			// do nothing
+		this->pTrie = make_unique<Trie>();
+		statusOutput->Text = "Reading input file...";
+		string fileName = ConvertPlatformStringToString(lexiconFileInput->Text);
+		AddWordsToTrie(*this->pTrie, fileName);
+	}
+	catch (std::exception& exception)
+	{
+		StopOnError(exception);
+		return;
 	}
 
-	// save file
-	statusOutput->Text = "Saving DAWG file...";
-	string lexiconName = ConvertPlatformStringToString(lexiconNameInput->Text);
-	fileName = ConvertPlatformStringToString(dawgFileInput->Text);
-	trie.SaveAsDawg(fileName, lexiconName);
-
-	// show summary
-	string summary = ConstructSummary(trie);
-	statusOutput->Text = ConvertStringToPlatformString(summary);
+	// compress (on timer ticks) and then save
+	this->lexiconName = ConvertPlatformStringToString(lexiconNameInput->Text);
+	this->dawgFileName = ConvertPlatformStringToString(dawgFileInput->Text);
+	makeDawgButton->IsEnabled = false;
+	statusOutput->Text = "Compressing...";
+	this->compressTimer->Start();
 }
 
 void MakeDawg::MainPage::AddWordsToTrie(Trie& trie, const string& filePath)
 {
-	// open the file
-	ifstream fileStream(filePath, ifstream::in);
-	string line;
-
-	// read until end of file is reached
-	while (fileStream.good())
-	{
-		// read a line
-		getline(fileStream, line);
+	// first word of each line (comments, invalid words and duplicates are left out), read on all cores
+	WordList wordList;
+	wordList.Read(filePath, true, 0);
 
-		// add word to trie if it is not a comment
-		if (line.length() > 0 && line[0] != '#')
-		{
-			// need to extract the first word (skipping whitespace)
-			string word;
-			stringstream(line);
-			line >> word;
-			if (word.length() > 0)
-				trie.AddWord(word.c_str());
-		}
-	}
-
-	fileStream.close();
+	const vector<string>& words = wordList.GetWords();
+	for (unsigned int idx = 0; idx < words.size(); idx++)
+		trie.AddWord(words[idx].c_str());
 }
 
 string MakeDawg::MainPage::ConstructSummary(Trie& trie)
@@ -153,6 +184,16 @@ string MakeDawg::MainPage::ConstructSummary(Trie& trie)
 	return summaryStream.str();
 }
 
+void MakeDawg::MainPage::StopOnError(const std::exception& exception)
+{
+	this->compressTimer->Stop();
+	this->pTrie.reset();
+	makeDawgButton->IsEnabled = true;
+
+	string error = string("Error: ") + exception.what();
+	statusOutput->Text = ConvertStringToPlatformString(error);
+}
+
 string MakeDawg::MainPage::ConvertPlatformStringToString(Platform::String^ platformString)
 {
 	stdext::cvt::wstring_convert<std::codecvt_utf8<wchar_t>> convert;
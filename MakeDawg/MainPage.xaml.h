@@ -7,6 +7,8 @@
 
 #include "MainPage.g.h"
 #include "Trie.h"
+#include <memory>
+#include <stdexcept>
 #include <string>
 
 namespace MakeDawg
@@ -18,9 +20,13 @@ namespace MakeDawg
 	{
 	public:
 		MainPage();
+		~MainPage();
 
 	private:
+		static const unsigned int COMPRESS_SLICE_MILLISECONDS = 50;	// compression time per timer tick
+
 		// UI related methods
+		void CompressTimerTick(Platform::Object^ sender, Platform::Object^ e);
 		void IOFolderButtonClick(Platform::Object^ sender, Windows::UI::Xaml::RoutedEventArgs^ e);
 		void LexiconFileButtonClick(Platform::Object^ sender, Windows::UI::Xaml::RoutedEventArgs^ e);
 		void MakeDawgButtonClick(Platform::Object^ sender, Windows::UI::Xaml::RoutedEventArgs^ e);
@@ -28,9 +34,16 @@ namespace MakeDawg
 		// Trie related
 		void AddWordsToTrie(LxpStd::Trie& trie, const std::string& filePath);
 		std::string ConstructSummary(LxpStd::Trie& trie);
+		void StopOnError(const std::exception& exception);	// drops the Trie and shows the error
 
 		// convenience functions
 		static std::string ConvertPlatformStringToString(Platform::String^ platformString);
 		static Platform::String^ ConvertStringToPlatformString(const std::string& inputString);
+
+		// compression in progress (a slice per timer tick keeps the UI responsive)
+		std::unique_ptr<LxpStd::Trie>		pTrie;
+		std::string							dawgFileName;
+		std::string							lexiconName;
+		Windows::UI::Xaml::DispatcherTimer^	compressTimer;
 	};
 }
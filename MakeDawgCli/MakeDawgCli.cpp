@@ -0,0 +1,413 @@
+// MakeDawgCli.cpp
+// Headless builder of Dawg files (the MakeDawg app without the UI) for build pipelines.
+
+#include "Dawg.h"
+#include "DawgBuilder.h"
+#include "Trie.h"
+#include "WordList.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace LxpStd;
+using namespace std;
+
+namespace MakeDawgCli
+{
+	namespace
+	{
+		const unsigned int	PROGRESS_INTERVAL_MILLISECONDS = 1000;
+
+		const char*	USAGE =
+			"Usage: makedawg [options] <word list> <dawg file>\n"
+			"Builds a Dawg file from a word list (one word per line, lines starting with # are comments).\n"
+			"\n"
+			"Options:\n"
+			"  --name=<name>      lexicon name stored in the header (default: word list file name)\n"
+			"  --builder=trie     add the words to a Trie and compress it (default)\n"
+			"  --builder=sorted   build with DawgBuilder (less memory)\n"
+			"  --threads=<n>      read the word list and build the Trie on n threads (0 for one per core, default 1)\n"
+			"  --format=<1|2>     Dawg file format (default 2, 1 for older readers)\n"
+			"  --layout=<layout>  node layout: depth (default), breadth or frequency (see --sample)\n"
+			"  --sample=<file>    words looked up (one per line, e.g. a query log) for --layout=frequency\n"
+			"  --child-masks      save the child masks with the nodes (format 2 only)\n"
+			"  --progress         report the progress of compressing the Trie every second\n"
+			"  --verify           load the saved file and look up every word\n"
+			"  --help             show this message\n";
+
+		enum class BuilderType {TRIE, SORTED};
+
+		struct OptionsStruct
+		{
+			string			wordListFileName;
+			string			dawgFileName;
+			string			lexiconName;
+			BuilderType		builderType;
+			DawgFileFormat	fileFormat;
+			DawgNodeLayout	nodeLayout;
+			string			sampleFileName;	// ACCESS_FREQUENCY only
+			bool			isChildMasks;	// V2 only
+			unsigned int	numThreads;		// word list and Trie only
+			bool			isProgress;		// Trie only
+			bool			isVerify;
+		};
+		typedef struct OptionsStruct	Options;
+
+		// time of each phase
+		class PhaseTimer
+		{
+		public:
+			PhaseTimer() { Restart(); }
+
+			void	Restart() { this->startTime = chrono::steady_clock::now(); }
+			double	Seconds() const { return chrono::duration<double>(chrono::steady_clock::now() - this->startTime).count(); }
+
+		private:
+			chrono::steady_clock::time_point	startTime;
+		};
+
+		// GET LEXICON NAME
+		// file name without the folders and the extension, cut to fit the header
+		string GetLexiconName(const string& wordListFileName)
+		{
+			string name = wordListFileName;
+			size_t slashPos = name.find_last_of("/\\");
+			if (slashPos != string::npos)
+				name = name.substr(slashPos + 1);
+
+			size_t dotPos = name.find_last_of('.');
+			if (dotPos != string::npos && dotPos > 0)
+				name = name.substr(0, dotPos);
+
+			if (name.length() > (size_t)Dawg::HEADER_LEXICON_NAME_LENGTH)
+				name.resize(Dawg::HEADER_LEXICON_NAME_LENGTH);
+
+			return name;
+		}
+
+		// GET PEAK MEMORY
+		// peak resident memory of the process so far (in MB)
+		double GetPeakMemory()
+		{
+#ifdef _WIN32
+			PROCESS_MEMORY_COUNTERS counters;
+			if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) == FALSE)
+				return 0.0;
+
+			return counters.PeakWorkingSetSize / (1024.0 * 1024.0);
+#else
+			struct rusage usage;
+			if (getrusage(RUSAGE_SELF, &usage) != 0)
+				return 0.0;
+
+#ifdef __APPLE__
+			return usage.ru_maxrss / (1024.0 * 1024.0);	// bytes
+#else
+			return usage.ru_maxrss / 1024.0;			// kilobytes
+#endif
+#endif
+		}
+
+		// PARSE OPTIONS
+		// false if the usage should be shown
+		bool ParseOptions(int argc, char** argv, Options& options)
+		{
+			const char* pNameOption = "--name=";
+			const char* pBuilderOption = "--builder=";
+			const char* pThreadsOption = "--threads=";
+			const char* pFormatOption = "--format=";
+			const char* pLayoutOption = "--layout=";
+			const char* pSampleOption = "--sample=";
+
+			options.builderType = BuilderType::TRIE;
+			options.fileFormat = DawgFileFormat::V2;
+			options.nodeLayout = DawgNodeLayout::DEPTH_FIRST;
+			options.isChildMasks = false;
+			options.numThreads = 1;
+			options.isProgress = false;
+			options.isVerify = false;
+
+			vector<string> fileNames;
+			bool isNameSet = false;
+			for (int idx = 1; idx < argc; idx++)
+			{
+				const char* pArg = argv[idx];
+				if (strncmp(pArg, pNameOption, strlen(pNameOption)) == 0)
+				{
+					options.lexiconName = pArg + strlen(pNameOption);
+					isNameSet = true;
+				}
+				else if (strncmp(pArg, pBuilderOption, strlen(pBuilderOption)) == 0)
+				{
+					string builder = pArg + strlen(pBuilderOption);
+					if (builder == "trie")
+						options.builderType = BuilderType::TRIE;
+					else if (builder == "sorted")
+						options.builderType = BuilderType::SORTED;
+					else
+						return false;
+				}
+				else if (strncmp(pArg, pThreadsOption, strlen(pThreadsOption)) == 0)
+				{
+					char* pEnd = NULL;
+					options.numThreads = (unsigned int)strtoul(pArg + strlen(pThreadsOption), &pEnd, 10);
+					if (pEnd == pArg + strlen(pThreadsOption) || *pEnd != '\0')
+						return false;
+				}
+				else if (strncmp(pArg, pFormatOption, strlen(pFormatOption)) == 0)
+				{
+					string format = pArg + strlen(pFormatOption);
+					if (format == "1")
+						options.fileFormat = DawgFileFormat::V1;
+					else if (format == "2")
+						options.fileFormat = DawgFileFormat::V2;
+					else
+						return false;
+				}
+				else if (strncmp(pArg, pLayoutOption, strlen(pLayoutOption)) == 0)
+				{
+					string layout = pArg + strlen(pLayoutOption);
+					if (layout == "depth")
+						options.nodeLayout = DawgNodeLayout::DEPTH_FIRST;
+					else if (layout == "breadth")
+						options.nodeLayout = DawgNodeLayout::BREADTH_FIRST;
+					else if (layout == "frequency")
+						options.nodeLayout = DawgNodeLayout::ACCESS_FREQUENCY;
+					else
+						return false;
+				}
+				else if (strncmp(pArg, pSampleOption, strlen(pSampleOption)) == 0)
+					options.sampleFileName = pArg + strlen(pSampleOption);
+				else if (strcmp(pArg, "--child-masks") == 0)
+					options.isChildMasks = true;
+				else if (strcmp(pArg, "--progress") == 0)
+					options.isProgress = true;
+				else if (strcmp(pArg, "--verify") == 0)
+					options.isVerify = true;
+				else if (pArg[0] == '-')
+					return false;	// --help and unknown options
+				else
+					fileNames.push_back(pArg);
+			}
+
+			if (fileNames.size() != 2)
+				return false;
+
+			// the sample is what the frequency layout is made from
+			if ((options.nodeLayout == DawgNodeLayout::ACCESS_FREQUENCY) != !options.sampleFileName.empty())
+				return false;
+
+			if (options.isChildMasks && options.fileFormat == DawgFileFormat::V1)
+				return false;
+
+			options.wordListFileName = fileNames[0];
+			options.dawgFileName = fileNames[1];
+			if (!isNameSet)
+				options.lexiconName = GetLexiconName(options.wordListFileName);
+
+			if (options.lexiconName.length() > (size_t)Dawg::HEADER_LEXICON_NAME_LENGTH)
+				throw(std::runtime_error("Lexicon name is longer than 32 characters!"));
+
+			return true;
+		}
+
+		// READ SAMPLE WORDS
+		// first word of each line, upper case (duplicates are kept as they count)
+		void ReadSampleWords(const string& fileName, vector<string>& sampleWords)
+		{
+			ifstream fileStream(fileName);
+			if (!fileStream.is_open())
+				throw(std::runtime_error("Unable to open the sample words!"));
+
+			string line;
+			while (getline(fileStream, line))
+			{
+				string word;
+				istringstream(line) >> word;
+				if (word.empty() || word[0] == '#')
+					continue;
+
+				transform(word.begin(), word.end(), word.begin(), [](char letter) { return (char)toupper((unsigned char)letter); });
+				sampleWords.push_back(word);
+			}
+		}
+
+		// REPORT PHASE
+		void ReportPhase(const char* pPhase, const PhaseTimer& timer)
+		{
+			printf("%-12s %9.3f s   peak memory %9.1f MB\n", pPhase, timer.Seconds(), GetPeakMemory());
+		}
+
+		// REPORT WORD LIST
+		// what was read and the lines rejected
+		void ReportWordList(const WordList& wordList)
+		{
+			WordListReport report;
+			wordList.GetReport(report);
+			printf("lines %u, words %u, duplicates %u, comments and blank lines %u\n",
+				report.numLines, report.numWords, report.numDuplicates, report.numSkippedLines);
+			if (report.numRejectedLines == 0)
+				return;
+
+			fprintf(stderr, "rejected %u lines with letters outside %c to %c or longer than %d letters\n",
+				report.numRejectedLines, Dawg::START_LETTER, Dawg::END_LETTER, Dawg::MAX_WORD_LENGTH);
+			for (unsigned int idx = 0; idx < report.rejects.size(); idx++)
+			{
+				const WordListReject& reject = report.rejects[idx];
+				fprintf(stderr, "  line %u (%s): %s\n", reject.lineNumber,
+					reject.reason == WordListRejectReason::TOO_LONG ? "too long" : "invalid letter", reject.line.c_str());
+			}
+
+			if (report.numRejectedLines > report.rejects.size())
+				fprintf(stderr, "  and %u more\n", report.numRejectedLines - (unsigned int)report.rejects.size());
+		}
+
+		// REPORT SUMMARY
+		void ReportSummary(const TrieDiagnostics& diagnostics)
+		{
+			printf("\nnodes before compression %u, after compression %u\n",
+				diagnostics.numNodes, diagnostics.numNodesAfterCompression);
+			printf("first children before compression %u, after compression %u\n",
+				diagnostics.numFirstChildrenBeforeCompression, diagnostics.numFirstChildrenAfterCompression);
+			printf("words %u\n", diagnostics.numWords);
+			printf("passes over the nodes after compression %u (numbering %.3f s, saving %.3f s)\n",
+				diagnostics.numFinishPasses, diagnostics.numberingSeconds, diagnostics.savingSeconds);
+		}
+
+		// BUILD SORTED
+		void BuildSorted(const Options& options, const vector<string>& words, const vector<string>& sampleWords)
+		{
+			DawgBuilder dawgBuilder;
+			PhaseTimer timer;
+			for (unsigned int idx = 0; idx < words.size(); idx++)
+				dawgBuilder.AddWord(words[idx].c_str());
+			ReportPhase("add words", timer);
+
+			timer.Restart();
+			dawgBuilder.Finish();
+			ReportPhase("finish", timer);
+
+			timer.Restart();
+			dawgBuilder.SaveAsDawg(options.dawgFileName, options.lexiconName, options.fileFormat, options.nodeLayout, sampleWords,
+								   options.isChildMasks);
+			ReportPhase("save", timer);
+
+			TrieDiagnostics diagnostics;
+			dawgBuilder.GetDiagnostics(diagnostics);
+			ReportSummary(diagnostics);
+		}
+
+		// BUILD TRIE
+		void BuildTrie(const Options& options, const vector<string>& words, const vector<string>& sampleWords)
+		{
+			Trie trie;
+			PhaseTimer timer;
+			trie.AddWords(words, options.numThreads);
+			ReportPhase("add words", timer);
+
+			timer.Restart();
+			if (options.numThreads == 1)
+			{
+				TrieCompressProgress progress;
+				while (trie.Compress(PROGRESS_INTERVAL_MILLISECONDS, progress) == false)
+				{
+					if (options.isProgress)
+						fprintf(stderr, "compressing %5.1f%%, %u duplicates removed, about %.0f s left\n",
+							100.0 * progress.fractionDone, progress.numDuplicatesRemoved, progress.remainingSeconds);
+				}
+			}
+			else
+				trie.CompressParallel(options.numThreads);
+			ReportPhase("compress", timer);
+
+			timer.Restart();
+			trie.SaveAsDawg(options.dawgFileName, options.lexiconName, options.fileFormat, options.nodeLayout, sampleWords,
+							options.isChildMasks);
+			ReportPhase("save", timer);
+
+			TrieDiagnostics diagnostics;
+			trie.GetDiagnostics(diagnostics);
+			ReportSummary(diagnostics);
+		}
+
+		// VERIFY DAWG
+		// every word is found and the number of words matches
+		void VerifyDawg(const Options& options, const vector<string>& words)
+		{
+			PhaseTimer timer;
+			Dawg dawg;
+			dawg.Initialize(options.dawgFileName, Dawg::LoadMode::COPY, options.isChildMasks);
+
+			DawgHeader header;
+			dawg.GetHeader(header);
+			if (header.numWords != words.size())
+				throw(std::runtime_error("Dawg file has a different number of words!"));
+
+			for (unsigned int idx = 0; idx < words.size(); idx++)
+			{
+				if (!dawg.IsWord(words[idx]))
+					throw(std::runtime_error("Dawg file is missing the word " + words[idx] + "!"));
+			}
+			ReportPhase("verify", timer);
+		}
+	}
+}
+
+using namespace MakeDawgCli;
+
+int main(int argc, char** argv)
+{
+	try
+	{
+		Options options;
+		if (!ParseOptions(argc, argv, options))
+		{
+			fputs(USAGE, stderr);
+			return 2;
+		}
+
+		PhaseTimer timer;
+		WordList wordList;
+		wordList.Read(options.wordListFileName, true, options.numThreads);
+		const vector<string>& words = wordList.GetWords();
+		ReportPhase("read", timer);
+		ReportWordList(wordList);
+		if (words.empty())
+			throw(std::runtime_error("Word list has no words!"));
+
+		vector<string> sampleWords;
+		if (!options.sampleFileName.empty())
+			ReadSampleWords(options.sampleFileName, sampleWords);
+
+		if (options.builderType == BuilderType::SORTED)
+			BuildSorted(options, words, sampleWords);
+		else
+			BuildTrie(options, words, sampleWords);
+
+		if (options.isVerify)
+			VerifyDawg(options, words);
+	}
+	catch (std::exception& e)
+	{
+		fprintf(stderr, "makedawg: %s\n", e.what());
+		return 1;
+	}
+
+	return 0;
+}